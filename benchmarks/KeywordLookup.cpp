@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-19.
+//
+
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "../src/Tokeniser/Keywords.h"
+#include "../src/Tokeniser/Tokeniser.h"
+
+using namespace alx;
+using SysClock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// The table Tokeniser used to build for every instance, kept here as the baseline to compare against
+static std::map<std::string_view, TokenType> make_keyword_map()
+{
+	return { { "int", TokenType::T_INT },		  { "long", TokenType::T_LONG },
+			 { "short", TokenType::T_SHORT },	  { "float", TokenType::T_FLOAT },
+			 { "double", TokenType::T_DOUBLE },	  { "void", TokenType::T_VOID },
+			 { "string", TokenType::T_STRING },	  { "char", TokenType::T_CHAR },
+			 { "bool", TokenType::T_BOOL },		  { "class", TokenType::T_CLASS },
+			 { "struct", TokenType::T_STRUCT },	  { "enum", TokenType::T_ENUM },
+			 { "return", TokenType::T_RET },	  { "extern", TokenType::T_EXTERN },
+			 { "true", TokenType::T_TRUE },		  { "false", TokenType::T_FALSE },
+			 { "if", TokenType::T_IF },			  { "else", TokenType::T_ELSE },
+			 { "while", TokenType::T_WHILE },	  { "for", TokenType::T_FOR },
+			 { "const", TokenType::T_CONST },	  { "mut", TokenType::T_MUT },
+			 { "deprecated", TokenType::T_DEPRECATED } };
+}
+
+// Splits the source into identifier-shaped lexemes, the same words the tokeniser classifies
+static std::vector<std::string_view> words(std::string_view source)
+{
+	std::vector<std::string_view> result;
+	size_t i = 0;
+	while (i < source.length()) {
+		if (!std::isalpha(source[i]) && source[i] != '_') {
+			++i;
+			continue;
+		}
+		const auto start = i;
+		while (i < source.length() && (std::isalnum(source[i]) || source[i] == '_')) ++i;
+		result.push_back(source.substr(start, i - start));
+	}
+	return result;
+}
+
+template<typename Func>
+static double time_ms(size_t iterations, Func func)
+{
+	const auto start = SysClock::now();
+	for (size_t i = 0; i < iterations; ++i) func();
+	return Milliseconds(SysClock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string path = argc > 1 ? argv[1] : ALX_BENCHMARK_DIR "/lots_of_variables.alx";
+	const size_t iterations = argc > 2 ? std::stoul(argv[2]) : 20;
+	std::ifstream file(path);
+	if (!file) {
+		println(Colour::LightRed, "Could not open {}", path);
+		return 1;
+	}
+	std::stringstream ss;
+	ss << file.rdbuf();
+	const std::string source = ss.str();
+	const auto lexemes = words(source);
+
+	size_t mapKeywords = 0;
+	const auto mapTime = time_ms(iterations, [&] {
+		const auto keywords = make_keyword_map();
+		for (const auto& word : lexemes)
+			if (keywords.contains(word))
+				mapKeywords += static_cast<size_t>(keywords.find(word)->second);
+	});
+	size_t switchKeywords = 0;
+	const auto switchTime = time_ms(iterations, [&] {
+		for (const auto& word : lexemes)
+			if (const auto keyword = keyword_type(word))
+				switchKeywords += static_cast<size_t>(keyword.value());
+	});
+	if (mapKeywords != switchKeywords) {
+		println(Colour::LightRed, "Keyword lookups disagree: {} != {}", mapKeywords, switchKeywords);
+		return 1;
+	}
+
+	auto errorHandler = std::make_shared<ErrorHandler>(source, path, false);
+	const auto tokeniseTime = time_ms(iterations, [&] {
+		Tokeniser tokeniser(source, errorHandler, std::make_shared<Interner>());
+		MUST(!tokeniser.Tokenise().Empty());
+	});
+
+	println("{} identifier-shaped lexemes, {} iteration(s)", lexemes.size(), iterations);
+	println("std::map lookup:       {}ms/iteration", mapTime / static_cast<double>(iterations));
+	println("keyword_type lookup:   {}ms/iteration", switchTime / static_cast<double>(iterations));
+	println("Tokeniser::Tokenise(): {}ms/iteration", tokeniseTime / static_cast<double>(iterations));
+	return 0;
+}
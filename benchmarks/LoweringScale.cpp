@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-01.
+//
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include "../src/IR/Ir.h"
+#include "../src/Parser/Parser.h"
+#include "../src/Tokeniser/Tokeniser.h"
+
+using namespace alx;
+using SysClock = std::chrono::steady_clock;
+using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+// Generates a function of `branches` if statements, each testing and updating a variable declared just before it.
+// Every if opens new blocks, so each variable is declared in a later block than the one before it, and looking it up
+// is as far from the function's entry block as it gets.
+static std::string generate(size_t branches)
+{
+	std::string source = "int main() {\n\tint v0 = 0;\n";
+	for (size_t i = 0; i < branches; ++i) {
+		formatTo(source, "\tif (v{} < {}) {\n\t\tv{} += 1;\n\t}\n", i, i, i);
+		formatTo(source, "\tint v{} = v{};\n", i + 1, i);
+	}
+	formatTo(source, "\treturn v{};\n}\n", branches);
+	return source;
+}
+
+// Lowers generated functions of growing size and reports the cost per branch, which should stay flat if finding a
+// variable or a block doesn't depend on how many blocks the function already has. Pass a path to also write out the
+// largest program.
+int main(int argc, char* argv[])
+{
+	std::string largest;
+	for (size_t branches : { 500, 2000, 8000, 32000 }) {
+		const auto source = generate(branches);
+
+		auto errorHandler = std::make_shared<ErrorHandler>(source, "LoweringScale", false);
+		auto interner = std::make_shared<Interner>();
+		Tokeniser tokeniser(source, errorHandler, interner);
+		Parser parser(tokeniser.Tokenise(), errorHandler, interner);
+		const auto ast = parser.Parse();
+		if (errorHandler->ErrorCount()) {
+			errorHandler->EmitErrorCount();
+			return 1;
+		}
+
+		// Lowering logs its progress; keep that out of the measurement
+		std::ostringstream discarded;
+		auto* const stdoutBuffer = std::cout.rdbuf(discarded.rdbuf());
+		const auto start = SysClock::now();
+		ir::IR ir(ast->GetChildren(), interner);
+		ir.Generate();
+		const Nanoseconds elapsed = SysClock::now() - start;
+		std::cout.rdbuf(stdoutBuffer);
+
+		println("{} branches: {}ms, {}ns/branch",
+				branches,
+				elapsed.count() / 1e6,
+				elapsed.count() / static_cast<double>(branches));
+		largest = source;
+	}
+
+	if (argc > 1) {
+		std::ofstream out(argv[1]);
+		out << largest;
+	}
+	return 0;
+}
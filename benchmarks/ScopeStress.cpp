@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-25.
+//
+
+#include <chrono>
+#include <fstream>
+#include "../src/Parser/Parser.h"
+#include "../src/Tokeniser/Tokeniser.h"
+
+using namespace alx;
+using SysClock = std::chrono::steady_clock;
+using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+// Generates `functions` functions, each a chain of `depth` nested blocks declaring `perBlock` variables. Every
+// variable is initialised from one declared in the enclosing block, so each declaration costs a redefinition check
+// and a lookup. The same names are reused in every function and at every depth's siblings, which exercises scope
+// exit as much as entry.
+static std::string generate(size_t functions, size_t depth, size_t perBlock)
+{
+	std::string source;
+	for (size_t f = 0; f < functions; ++f) {
+		formatTo(source, "int f{}() {\n", f);
+		for (size_t d = 0; d < depth; ++d) {
+			for (size_t v = 0; v < perBlock; ++v) {
+				if (d == 0 && v == 0)
+					formatTo(source, "{>}int d0_0 = 1;\n", d + 1);
+				else if (v == 0)
+					formatTo(source, "{>}int d{}_0 = d{}_{};\n", d + 1, d, d - 1, perBlock - 1);
+				else
+					formatTo(source, "{>}int d{}_{} = d{}_{};\n", d + 1, d, v, d, v - 1);
+			}
+			if (d + 1 < depth)
+				formatTo(source, "{>}if (d{}_0 < 1) {\n", d + 1, d);
+		}
+		for (size_t d = depth - 1; d > 0; --d)
+			formatTo(source, "{>}}\n", d);
+		source += "\treturn 0;\n}\n";
+	}
+	return source;
+}
+
+// Parses generated programs of growing size and reports the parse cost per declaration, which should stay flat if
+// lookups and scope changes don't depend on how many variables have been declared. Pass a path to also write out
+// the largest program.
+int main(int argc, char* argv[])
+{
+	constexpr size_t Depth = 16;
+	constexpr size_t PerBlock = 8;
+	constexpr size_t DeclarationsPerFunction = Depth * PerBlock;
+
+	std::string largest;
+	for (size_t functions : { 8, 80, 800, 2000 }) {
+		const auto source = generate(functions, Depth, PerBlock);
+		const auto declarations = functions * DeclarationsPerFunction;
+
+		auto errorHandler = std::make_shared<ErrorHandler>(source, "ScopeStress", false);
+		auto interner = std::make_shared<Interner>();
+		Tokeniser tokeniser(source, errorHandler, interner);
+		Parser parser(tokeniser.Tokenise(), errorHandler, interner);
+
+		const auto start = SysClock::now();
+		const auto ast = parser.Parse();
+		const Nanoseconds elapsed = SysClock::now() - start;
+		if (errorHandler->ErrorCount()) {
+			errorHandler->EmitErrorCount();
+			return 1;
+		}
+
+		println("{} functions, {} declarations: {}ms, {}ns/declaration",
+				functions,
+				declarations,
+				elapsed.count() / 1e6,
+				elapsed.count() / static_cast<double>(declarations));
+		largest = source;
+	}
+
+	if (argc > 1) {
+		std::ofstream out(argv[1]);
+		out << largest;
+	}
+	return 0;
+}
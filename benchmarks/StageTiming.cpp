@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-23.
+//
+
+#include <chrono>
+#include <sstream>
+#include "../src/Codegen/x86_64_linux/ProgramGenerator.h"
+#include "../src/IR/Ir.h"
+#include "../src/IR/PassManager.h"
+#include "../src/IR/Transforms/Mem2Reg.h"
+#include "../src/IR/Transforms/PhiElimination.h"
+#include "../src/Parser/Parser.h"
+#include "../src/Tokeniser/Tokeniser.h"
+#include "../src/Utils/SourceBuffer.h"
+
+using namespace alx;
+using SysClock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// Times the stages that walk the AST: lowering to IR and generating assembly, and the IR passes in between. The source
+// is tokenised and parsed once and the same tree is walked on every iteration.
+int main(int argc, char* argv[])
+{
+	const std::string path = argc > 1 ? argv[1] : ALX_BENCHMARK_DIR "/lots_of_variables.alx";
+	const size_t iterations = argc > 2 ? std::stoul(argv[2]) : 20;
+	const auto source = SourceBuffer::Open(path);
+	if (!source) {
+		println(Colour::LightRed, "Could not open {}", path);
+		return 1;
+	}
+
+	auto errorHandler = std::make_shared<ErrorHandler>(source->View(), path, false);
+	auto interner = std::make_shared<Interner>();
+	Tokeniser tokeniser(source->View(), errorHandler, interner);
+	Parser parser(tokeniser.Tokenise(), errorHandler, interner);
+	const auto ast = parser.Parse();
+
+	// The stages log their progress; keep that out of the measurements
+	std::ostringstream discarded;
+	auto* const stdoutBuffer = std::cout.rdbuf(discarded.rdbuf());
+	double irTime = 0;
+	double passesTime = 0;
+	double asmTime = 0;
+	for (size_t i = 0; i < iterations; ++i) {
+		auto start = SysClock::now();
+		ir::IR ir(ast->GetChildren(), interner);
+		ir.Generate();
+		irTime += Milliseconds(SysClock::now() - start).count();
+
+		ir::PassManager passes;
+		passes.AddFunctionPass("mem2reg", "allocas promoted", ir::promoteAllocas);
+		passes.AddFunctionPass("phi-elimination", "phis eliminated", [](ir::Function& function, ir::FunctionAnalyses&) {
+			return ir::eliminatePhis(function);
+		});
+		passes.Run(ir);
+		for (const auto& pass : passes.Statistics()) passesTime += pass.Milliseconds;
+
+		start = SysClock::now();
+		ProgramGenerator generator(ast->GetChildren(), {});
+		generator.Generate();
+		asmTime += Milliseconds(SysClock::now() - start).count();
+		discarded.str({});
+	}
+	std::cout.rdbuf(stdoutBuffer);
+
+	println("{}, {} iteration(s)", path, iterations);
+	println("AST to IR:  {}ms/iteration", irTime / static_cast<double>(iterations));
+	println("IR passes:  {}ms/iteration", passesTime / static_cast<double>(iterations));
+	println("AST to asm: {}ms/iteration", asmTime / static_cast<double>(iterations));
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-24.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace alx {
+
+// Bump allocator for the AST. Nodes and child arrays are laid out contiguously in parse order, which keeps the later
+// tree walks cache friendly. Nothing allocated here is ever destroyed individually: everything goes away at once
+// when the arena does, so only trivially destructible types may live in it.
+class AstArena
+{
+	static constexpr size_t ChunkSize = 64 * 1024;
+
+	std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+	std::byte* m_cursor{};
+	std::byte* m_end{};
+
+	void* allocate(size_t size, size_t alignment)
+	{
+		void* ptr = m_cursor;
+		auto space = static_cast<size_t>(m_end - m_cursor);
+		if (m_cursor && std::align(alignment, size, ptr, space)) {
+			m_cursor = static_cast<std::byte*>(ptr) + size;
+			return ptr;
+		}
+		// Oversized requests get a chunk of their own so the current one keeps its free space
+		if (size + alignment > ChunkSize) {
+			space = size + alignment;
+			m_chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(space));
+			ptr = m_chunks.back().get();
+			return std::align(alignment, size, ptr, space);
+		}
+		m_chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(ChunkSize));
+		m_cursor = m_chunks.back().get();
+		m_end = m_cursor + ChunkSize;
+		return allocate(size, alignment);
+	}
+
+public:
+	AstArena() = default;
+	AstArena(const AstArena&) = delete;
+	AstArena& operator=(const AstArena&) = delete;
+
+	template<typename T, typename... Args>
+	T* Make(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "AST arena objects are never destroyed");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	// Copies a list built up during parsing into the arena
+	template<typename T>
+	std::span<T> Copy(std::span<const T> items)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (items.empty())
+			return {};
+		auto* data = static_cast<T*>(allocate(items.size_bytes(), alignof(T)));
+		std::memcpy(data, items.data(), items.size_bytes());
+		return { data, items.size() };
+	}
+
+	// Room for `count` items that are filled in afterwards, for lists whose length is known before their items are
+	template<typename T>
+	std::span<T> Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (count == 0)
+			return {};
+		return { static_cast<T*>(allocate(count * sizeof(T), alignof(T))), count };
+	}
+
+	std::string_view CopyString(std::string_view text)
+	{
+		auto* data = static_cast<char*>(allocate(text.size(), 1));
+		std::memcpy(data, text.data(), text.size());
+		return { data, text.size() };
+	}
+
+	// Takes over everything allocated in `other`, which is left empty. Used to merge arenas filled on other threads.
+	void Absorb(AstArena& other)
+	{
+		m_chunks.insert(m_chunks.end(),
+						std::make_move_iterator(other.m_chunks.begin()),
+						std::make_move_iterator(other.m_chunks.end()));
+		other.m_chunks.clear();
+		other.m_cursor = other.m_end = nullptr;
+	}
+
+	[[nodiscard]] size_t ChunkCount() const { return m_chunks.size(); }
+};
+
+} // namespace alx
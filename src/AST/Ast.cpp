@@ -6,130 +6,99 @@
 // Created by aelliixx on 2023-09-06.
 //
 
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <type_traits>
 #include "Ast.h"
 #include "../libs/Println.h"
 #include "../Utils/Utils.h"
 
 namespace alx {
 
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "misc-no-recursion"
-#endif
-std::unique_ptr<NumberLiteral> BinaryExpression::Evaluate() const
+NumberLiteral::NumberLiteral(const ConstantValue& constant, AstArena& arena)
+  : Expression(NodeKind::NumberLiteral),
+	m_type(constant.LiteralType()),
+	m_number(constant.Value())
 {
-	MUST(m_constexpr && "Cannot evaluate non constant binary expressions");
-	auto add = [this](const std::string& lhsVal, const std::string& rhsVal) {
-		// FIXME: Add evaluation for doubles and floats
-		std::string res;
-		switch (m_binary_op) {
-		case TokenType::T_PLUS:
-			res = std::to_string(std::stol(lhsVal) + std::stol(rhsVal));
-			break;
-		case TokenType::T_MINUS:
-			res = std::to_string(std::stol(lhsVal) - std::stol(rhsVal));
-			break;
-		case TokenType::T_STAR:
-			res = std::to_string(std::stol(lhsVal) * std::stol(rhsVal));
-			break;
-		case TokenType::T_FWD_SLASH:
-			res = std::to_string(std::stol(lhsVal) / std::stol(rhsVal));
-			break;
-		case TokenType::T_POW:
-			res = std::to_string((long)(std::pow(std::stol(lhsVal), std::stol(rhsVal))));
-			break;
-		case TokenType::T_LT:
-			res = std::to_string(std::stol(lhsVal) < std::stol(rhsVal));
-			break;
-		case TokenType::T_GT:
-			res = std::to_string(std::stol(lhsVal) > std::stol(rhsVal));
-			break;
-		case TokenType::T_LTE:
-			res = std::to_string(std::stol(lhsVal) <= std::stol(rhsVal));
-			break;
-		case TokenType::T_GTE:
-			res = std::to_string(std::stol(lhsVal) >= std::stol(rhsVal));
-			break;
-		case TokenType::T_MOD:
-			res = std::to_string(std::stol(lhsVal) % std::stol(rhsVal));
-			break;
-		case TokenType::T_COLON:
-			res = std::to_string(std::stol(lhsVal) / std::stol(rhsVal));
-			break;
-		case TokenType::T_EQEQ:
-			[[fallthrough]];
-		case TokenType::T_SUB:
-			[[fallthrough]];
-		case TokenType::T_ADD:
-			[[fallthrough]];
-		case TokenType::T_ADD_EQ:
-			[[fallthrough]];
-		case TokenType::T_SUB_EQ:
-			[[fallthrough]];
-		case TokenType::T_MULT_EQ:
-			[[fallthrough]];
-		case TokenType::T_DIV_EQ:
-			[[fallthrough]];
-		case TokenType::T_MOD_EQ:
-			[[fallthrough]];
-		case TokenType::T_POW_EQ:
-			ASSERT_NOT_IMPLEMENTED();
-		default:
-			ASSERT_NOT_REACHABLE();
-		}
-		return res;
-	};
-
-	if (m_lhs->class_name() == "BinaryExpression") {
-		auto lhs = static_cast<BinaryExpression*>(m_lhs.get())->Evaluate();
-		auto rhs = static_cast<NumberLiteral*>(m_rhs.get());
-		auto lhsVal = lhs->Value();
-		auto rhsVal = rhs->Value();
-		return std::make_unique<NumberLiteral>(lhs->Type(), add(lhsVal, rhsVal));
-	}
-
-	MUST(m_rhs->class_name() == "NumberLiteral");
-	MUST(m_lhs->class_name() == "NumberLiteral");
-	auto* lhs = static_cast<NumberLiteral*>(m_lhs.get());
-	auto* rhs = static_cast<NumberLiteral*>(m_rhs.get());
-
-	auto lhs_val = lhs->Value();
-	auto rhs_val = rhs->Value();
-
-	return std::make_unique<NumberLiteral>(lhs->Type(), add(lhs_val, rhs_val));
+	// Fixed notation, as the digits go into assembly as they are. The longest is a subnormal double's, with over 300
+	// zeros after the point.
+	std::array<char, 512> digits;
+	const auto first = digits.data();
+	const auto last = first + digits.size();
+	auto end = std::visit(
+		[&](auto number) {
+			if constexpr (std::is_floating_point_v<decltype(number)>)
+				return std::to_chars(first, last, number, std::chars_format::fixed).ptr;
+			else
+				return std::to_chars(first, last, number).ptr;
+		},
+		m_number);
+	// A whole double has no decimal point, and would be read back as an integer
+	const auto isWhole = std::all_of(first, end, [](char c) { return std::isdigit(c) || c == '-'; });
+	if (constant.IsFloatingPoint() && isWhole)
+		end = std::copy_n(".0", 2, end);
+	m_value = arena.CopyString(std::string_view(first, end));
 }
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
 
-BinaryExpression::BinaryExpression(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs, TokenType binaryOp)
-  : m_lhs(std::move(lhs)),
-	m_rhs(std::move(rhs)),
+BinaryExpression::BinaryExpression(Expression* lhs, Expression* rhs, TokenType binaryOp)
+  : Expression(NodeKind::BinaryExpression),
+	m_lhs(lhs),
+	m_rhs(rhs),
 	m_binary_op(binaryOp)
 {
 	MUST(isBinaryOp(m_binary_op) && "Invalid binary operator");
 
-	// Check if both sides are numbers or binary expressions and if they are constant
-	if (m_lhs->class_name() == "NumberLiteral" && m_rhs->class_name() == "NumberLiteral")
-		m_constexpr = true;
-	else if (m_lhs->class_name() == "BinaryExpression" && m_rhs->class_name() == "NumberLiteral")
-		m_constexpr = static_cast<BinaryExpression*>(m_lhs.get())->m_constexpr;
+	// Operands are made first, so theirs are already folded and this only looks one level down
+	const auto lhsValue = constantValueOf(*m_lhs);
+	const auto rhsValue = lhsValue ? constantValueOf(*m_rhs) : std::nullopt;
+	if (rhsValue)
+		m_constant = ConstantValue::Fold(m_binary_op, *lhsValue, *rhsValue);
 
-	if (m_lhs->class_name() == "Identifier" && m_rhs->class_name() == "Identifier") {
-		auto lhsId = static_cast<Identifier*>(m_lhs.get());
-		auto rhsId = static_cast<Identifier*>(m_rhs.get());
+	if (m_lhs->Kind() == NodeKind::Identifier && m_rhs->Kind() == NodeKind::Identifier) {
+		auto lhsId = static_cast<Identifier*>(m_lhs);
+		auto rhsId = static_cast<Identifier*>(m_rhs);
 
 		m_operands_match = lhsId->Name() == rhsId->Name();
 	}
 }
 
-StructDeclaration::StructDeclaration(std::string name,
-									 std::vector<std::unique_ptr<ASTNode>> members,
-									 std::vector<std::unique_ptr<ASTNode>> methods)
-  : m_name(std::move(name)),
-	m_members(std::move(members)),
-	m_methods(std::move(methods))
+UnaryExpression::UnaryExpression(Expression* rhs, TokenType op, bool postfix)
+  : Expression(NodeKind::UnaryExpression),
+	m_rhs(rhs),
+	m_unary_op(op),
+	m_postfix(postfix)
+{
+	if (const auto operand = constantValueOf(*m_rhs))
+		m_constant = ConstantValue::Fold(m_unary_op, *operand);
+}
+
+std::optional<ConstantValue> constantValueOf(const Expression& expression)
+{
+	switch (expression.Kind()) {
+	case NodeKind::NumberLiteral: {
+		const auto& literal = static_cast<const NumberLiteral&>(expression);
+		return ConstantValue{ literal.Type(), literal.Number() };
+	}
+	case NodeKind::BinaryExpression: {
+		const auto& binary = static_cast<const BinaryExpression&>(expression);
+		return binary.Constexpr() ? std::optional(binary.Evaluate()) : std::nullopt;
+	}
+	case NodeKind::UnaryExpression: {
+		const auto& unary = static_cast<const UnaryExpression&>(expression);
+		return unary.Constexpr() ? std::optional(unary.Evaluate()) : std::nullopt;
+	}
+	default:
+		return {};
+	}
+}
+
+StructDeclaration::StructDeclaration(std::string_view name, std::span<ASTNode*> members, std::span<ASTNode*> methods)
+  : ASTNode(NodeKind::StructDeclaration),
+	m_name(name),
+	m_members(members),
+	m_methods(methods)
 {
 	for (const auto& member : m_members) {
 		auto& var = static_cast<VariableDeclaration&>(*member);
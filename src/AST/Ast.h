@@ -8,12 +8,17 @@
 
 #pragma once
 
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
-#include <memory>
 #include <vector>
 #include <variant>
+#include "Arena.h"
+#include "ConstantValue.h"
 #include "../Tokeniser/Tokeniser.h"
+#include "../Utils/SourceEdit.h"
 #include "../Utils/Types.h"
 #include "../libs/Println.h"
 
@@ -27,310 +32,418 @@ enum class AccessModeType
 	a_private = 4
 };
 
+// One per concrete node class, so passes can dispatch with a switch instead of comparing class names
+enum class NodeKind : uint8_t
+{
+	Expression,
+	Program,
+	BlockStatement,
+	Identifier,
+	NumberLiteral,
+	StringLiteral,
+	BinaryExpression,
+	UnaryExpression,
+	VariableDeclaration,
+	IfStatement,
+	WhileStatement,
+	FunctionDeclaration,
+	StructDeclaration,
+	ClassDeclaration,
+	MemberExpression,
+	ReturnStatement,
+};
+
+constexpr std::string_view node_kind_name(NodeKind kind)
+{
+	switch (kind) {
+	case NodeKind::Expression:
+		return "Expression";
+	case NodeKind::Program:
+		return "Program";
+	case NodeKind::BlockStatement:
+		return "BlockStatement";
+	case NodeKind::Identifier:
+		return "Identifier";
+	case NodeKind::NumberLiteral:
+		return "NumberLiteral";
+	case NodeKind::StringLiteral:
+		return "StringLiteral";
+	case NodeKind::BinaryExpression:
+		return "BinaryExpression";
+	case NodeKind::UnaryExpression:
+		return "UnaryExpression";
+	case NodeKind::VariableDeclaration:
+		return "VariableDeclaration";
+	case NodeKind::IfStatement:
+		return "IfStatement";
+	case NodeKind::WhileStatement:
+		return "WhileStatement";
+	case NodeKind::FunctionDeclaration:
+		return "FunctionDeclaration";
+	case NodeKind::StructDeclaration:
+		return "StructDeclaration";
+	case NodeKind::ClassDeclaration:
+		return "ClassDeclaration";
+	case NodeKind::MemberExpression:
+		return "MemberExpression";
+	case NodeKind::ReturnStatement:
+		return "ReturnStatement";
+	}
+	return "ASTNode";
+}
+
 class ASTNode
 {
+	NodeKind m_kind;
+
 protected:
+	explicit ASTNode(NodeKind kind) : m_kind(kind) {}
+	// Nodes live in the Program's arena and are never deleted through a base pointer
+	~ASTNode() = default;
+
 public:
-	[[maybe_unused]] [[nodiscard]] virtual std::string class_name() const = 0;
+	[[nodiscard]] NodeKind Kind() const { return m_kind; }
+	[[maybe_unused]] [[nodiscard]] std::string_view class_name() const { return node_kind_name(m_kind); }
 	[[maybe_unused]] virtual void PrintNode(int) const = 0;
-	virtual ~ASTNode() = default;
 	class StructDeclaration;
 };
 
 class Expression : public ASTNode
 {
+protected:
+	explicit Expression(NodeKind kind) : ASTNode(kind) {}
+
 public:
-	[[nodiscard]] std::string class_name() const override { return "Expression"; }
 	[[maybe_unused]] void PrintNode(int indent) const override;
 };
 
 class ScopeNode : public ASTNode
 {
 protected:
-	std::vector<std::unique_ptr<ASTNode>> m_children;
-	[[maybe_unused]] static void dump_nodes(const std::vector<std::unique_ptr<ASTNode>>&, int indent);
-	ScopeNode() = default;
+	std::span<ASTNode*> m_children;
+	[[maybe_unused]] static void dump_nodes(std::span<ASTNode* const>, int indent);
+	explicit ScopeNode(NodeKind kind) : ASTNode(kind) {}
 
 public:
-	template<typename T, typename... Args>
-	T& Append(Args&&... args)
-	{
-		auto child = std::make_unique<T>(std::forward<Args>(args)...);
-		m_children.push_back(std::move(child));
-		return *static_cast<T*>(m_children.back().get());
-	}
-	void Append(std::unique_ptr<ASTNode> node) { m_children.push_back(std::move(node)); }
+	// Children are collected while the scope is parsed and handed over as one arena-backed array
+	void SetChildren(std::span<ASTNode*> children) { m_children = children; }
 
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	[[nodiscard]] const std::vector<std::unique_ptr<ASTNode>>& Children() const { return m_children; }
+	[[nodiscard]] std::span<ASTNode* const> Children() const { return m_children; }
 };
 
 class Program : public ScopeNode
 {
-	[[nodiscard]] std::string class_name() const override { return "Program"; }
+	AstArena m_arena;
+	std::vector<ASTNode*> m_statements;
+	std::vector<SourceSpan> m_spans; // Where each statement is in the source, for reparsing after an edit
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	Program() = default;
-	[[nodiscard]] const std::vector<std::unique_ptr<ASTNode>>& GetChildren() const { return m_children; }
+	Program() : ScopeNode(NodeKind::Program) {}
+
+	// Every other node in the tree is allocated here and freed in one go with the Program
+	[[nodiscard]] AstArena& Arena() { return m_arena; }
+	void Append(ASTNode* node, SourceSpan span)
+	{
+		m_statements.push_back(node);
+		m_spans.push_back(span);
+		m_children = m_statements;
+	}
+	// Keeps the nodes of a Program parsed separately alive for as long as this one
+	void Absorb(Program& part) { m_arena.Absorb(part.m_arena); }
+	[[nodiscard]] std::span<ASTNode* const> GetChildren() const { return m_children; }
+	[[nodiscard]] std::span<const SourceSpan> Spans() const { return m_spans; }
 };
 
 class BlockStatement : public ScopeNode
 {
-	[[nodiscard]] std::string class_name() const override { return "BlockStatement"; }
-
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	BlockStatement() = default;
+	BlockStatement() : ScopeNode(NodeKind::BlockStatement) {}
 };
 
 class Identifier : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "Identifier"; }
-	std::string m_name;
+	SymbolId m_symbol;
+	std::string_view m_name;
 	bool m_assignable{ true };
 	bool m_deprecated{ false };
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	explicit Identifier(std::string name) : m_name(std::move(name)) {}
-	Identifier(std::string name, bool assignable) : m_name(std::move(name)), m_assignable(assignable) {}
+	Identifier(SymbolId symbol, std::string_view name)
+	  : Expression(NodeKind::Identifier),
+		m_symbol(symbol),
+		m_name(name)
+	{}
+	Identifier(SymbolId symbol, std::string_view name, bool assignable)
+	  : Expression(NodeKind::Identifier),
+		m_symbol(symbol),
+		m_name(name),
+		m_assignable(assignable)
+	{}
+	// Identifier tokens always carry their text and interned symbol
+	explicit Identifier(const Token& token) : Identifier(token.Symbol(), token.Value()) {}
 
 	void SetDeprecated(bool deprecated = true) { m_deprecated = deprecated; }
 
-	[[nodiscard]] const std::string& Name() const { return m_name; }
+	[[nodiscard]] SymbolId Symbol() const { return m_symbol; }
+	[[nodiscard]] std::string_view Name() const { return m_name; }
 	[[nodiscard]] bool Assignable() const { return m_assignable; }
 	[[nodiscard]] bool Deprecated() const { return m_deprecated; }
 };
 
 class NumberLiteral : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "NumberLiteral"; }
-
 	TokenType m_type;
-	std::string m_value;
+	// Source text without grouping commas, or a folded constant's digits, as emitted into assembly
+	std::string_view m_value;
+	NumberValue m_number;
 	bool m_is_unsigned{}; // FIXME
 
+	template<typename T>
+	[[nodiscard]] T as() const
+	{
+		return std::visit([](auto number) { return static_cast<T>(number); }, m_number);
+	}
+
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	NumberLiteral(TokenType type, std::string value) : m_type(type), m_value(std::move(value))
-	{
-		std::string::size_type n;
-		while ((n = m_value.find(',')) != std::string::npos) m_value.replace(n, 1, "");
-	}
+	NumberLiteral(TokenType type, std::string_view value, NumberValue number)
+	  : Expression(NodeKind::NumberLiteral),
+		m_type(type),
+		m_value(value),
+		m_number(number)
+	{}
+	// Folded constants have no source text to point at, so their digits are written into `arena`
+	NumberLiteral(const ConstantValue& constant, AstArena& arena);
 
 	[[nodiscard]] TokenType Type() const { return m_type; }
-	[[nodiscard]] const std::string& Value() const { return m_value; }
-	[[nodiscard]] long AsInt() const { return std::stoi(m_value); }
-	[[nodiscard]] float AsFloat() const { return std::stof(m_value); }
-	[[nodiscard]] double AsDouble() const { return std::stod(m_value); }
-	[[nodiscard]] long AsBoolNum() const { return !!std::stoi(m_value); }
+	[[nodiscard]] std::string_view Value() const { return m_value; }
+	[[nodiscard]] const NumberValue& Number() const { return m_number; }
+	[[nodiscard]] long AsInt() const { return as<long>(); }
+	[[nodiscard]] float AsFloat() const { return as<float>(); }
+	[[nodiscard]] double AsDouble() const { return as<double>(); }
+	[[nodiscard]] long AsBoolNum() const { return !!AsInt(); }
 	[[nodiscard]] std::string AsBool() const { return AsInt() ? "true" : "false"; }
 };
 
 class StringLiteral : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "StringLiteral"; }
-
-	std::string m_value;
+	std::string_view m_value;
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	explicit StringLiteral(std::string value) : m_value(std::move(value)) {}
+	explicit StringLiteral(std::string_view value) : Expression(NodeKind::StringLiteral), m_value(value) {}
 
-	[[nodiscard]] std::string Value() const { return m_value; }
+	[[nodiscard]] std::string_view Value() const { return m_value; }
 	[[nodiscard]] uint Length() const { return m_value.length(); }
 };
 
 class BinaryExpression : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "BinaryExpression"; }
-	std::unique_ptr<Expression> m_lhs, m_rhs;
+	Expression *m_lhs, *m_rhs;
 	TokenType m_binary_op;
-	bool m_constexpr{};
-	std::optional<std::variant<NumberLiteral, StringLiteral>> m_value; // Only valid when constexpr
+	std::optional<ConstantValue> m_constant; // Folded when the node is made, if both operands are constants
 	bool m_operands_match{};
 
 public:
-	BinaryExpression(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs, TokenType binaryOp);
+	BinaryExpression(Expression* lhs, Expression* rhs, TokenType binaryOp);
 
 	[[maybe_unused]] void PrintNode(int indent) const override;
 	[[nodiscard]] TokenType Operator() const { return m_binary_op; }
-	[[nodiscard]] Expression* Lhs() const { return m_lhs.get(); }
-	[[nodiscard]] Expression* Rhs() const { return m_rhs.get(); }
-	[[nodiscard]] bool Constexpr() const { return m_constexpr; }
+	[[nodiscard]] Expression* Lhs() const { return m_lhs; }
+	[[nodiscard]] Expression* Rhs() const { return m_rhs; }
+	[[nodiscard]] bool Constexpr() const { return m_constant.has_value(); }
 	[[nodiscard]] bool OperandsMatch() const { return m_operands_match; }
-	[[nodiscard]] std::unique_ptr<NumberLiteral> Evaluate() const;
+	[[nodiscard]] const ConstantValue& Evaluate() const
+	{
+		MUST(m_constant && "Cannot evaluate non constant binary expressions");
+		return *m_constant;
+	}
 };
 
 class UnaryExpression : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "UnaryExpression"; }
-	std::unique_ptr<Expression> m_rhs;
+	Expression* m_rhs;
 	TokenType m_unary_op;
+	bool m_postfix; // a++ rather than ++a: the expression's value is the operand's from before the operator
+	std::optional<ConstantValue> m_constant; // Folded when the node is made, if the operand is a constant
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	UnaryExpression(std::unique_ptr<Expression> rhs, TokenType op) : m_rhs(std::move(rhs)), m_unary_op(op) {}
+	UnaryExpression(Expression* rhs, TokenType op, bool postfix = false);
 
 	[[nodiscard]] TokenType Operator() const { return m_unary_op; }
-	[[nodiscard]] Expression* Rhs() const { return m_rhs.get(); }
+	[[nodiscard]] Expression* Rhs() const { return m_rhs; }
+	[[nodiscard]] bool Postfix() const { return m_postfix; }
+	[[nodiscard]] bool Constexpr() const { return m_constant.has_value(); }
+	[[nodiscard]] const ConstantValue& Evaluate() const
+	{
+		MUST(m_constant && "Cannot evaluate non constant unary expressions");
+		return *m_constant;
+	}
 };
 
+// The value of `expression` if it's a constant: a number literal, or an operator whose operands are all constants
+[[nodiscard]] std::optional<ConstantValue> constantValueOf(const Expression& expression);
+
 class VariableDeclaration : public ASTNode
 {
-	[[nodiscard]] std::string class_name() const override { return "VariableDeclaration"; }
-
-	std::variant<TokenType, std::unique_ptr<Identifier>> m_type;
-	std::unique_ptr<Identifier> m_identifier;
-	std::unique_ptr<Expression> m_value;
-	std::string m_fully_qualified_name;
+	std::variant<TokenType, Identifier*> m_type;
+	Identifier* m_identifier;
+	Expression* m_value{};
+	SymbolId m_scope; // Function or struct the variable is declared in
 
 	AccessModeType m_access_mode = AccessModeType::a_scoped;
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	VariableDeclaration(std::variant<TokenType, std::unique_ptr<Identifier>> type,
-						std::unique_ptr<Identifier> identifier,
-						std::unique_ptr<Expression> value,
-						std::string fullyQualifiedName)
-	  : m_type(std::move(type)),
-		m_identifier(std::move(identifier)),
-		m_value(std::move(value)),
-		m_fully_qualified_name(std::move(fullyQualifiedName))
+	VariableDeclaration(std::variant<TokenType, Identifier*> type,
+						Identifier* identifier,
+						Expression* value,
+						SymbolId scope)
+	  : ASTNode(NodeKind::VariableDeclaration),
+		m_type(type),
+		m_identifier(identifier),
+		m_value(value),
+		m_scope(scope)
 	{}
 
-	VariableDeclaration(std::variant<TokenType, std::unique_ptr<Identifier>> type,
-						std::unique_ptr<Identifier> identifier,
-						std::unique_ptr<Expression> value,
+	VariableDeclaration(std::variant<TokenType, Identifier*> type,
+						Identifier* identifier,
+						Expression* value,
 						AccessModeType accessMode,
-						std::string fullyQualifiedName)
-	  : m_type(std::move(type)),
-		m_identifier(std::move(identifier)),
-		m_value(std::move(value)),
-		m_fully_qualified_name(std::move(fullyQualifiedName)),
+						SymbolId scope)
+	  : ASTNode(NodeKind::VariableDeclaration),
+		m_type(type),
+		m_identifier(identifier),
+		m_value(value),
+		m_scope(scope),
 		m_access_mode(accessMode)
 	{}
 
-	VariableDeclaration(std::variant<TokenType, std::unique_ptr<Identifier>> type,
-						std::unique_ptr<Identifier> identifier,
-						std::string fullyQualifiedName)
-	  : m_type(std::move(type)),
-		m_identifier(std::move(identifier)),
-		m_fully_qualified_name(std::move(fullyQualifiedName))
+	VariableDeclaration(std::variant<TokenType, Identifier*> type, Identifier* identifier, SymbolId scope)
+	  : ASTNode(NodeKind::VariableDeclaration),
+		m_type(type),
+		m_identifier(identifier),
+		m_scope(scope)
 	{}
 
-	VariableDeclaration(std::variant<TokenType, std::unique_ptr<Identifier>> type,
-						std::unique_ptr<Identifier> identifier,
+	VariableDeclaration(std::variant<TokenType, Identifier*> type,
+						Identifier* identifier,
 						AccessModeType accessMode,
-						std::string fullyQualifiedName)
-	  : m_type(std::move(type)),
-		m_identifier(std::move(identifier)),
-		m_fully_qualified_name(std::move(fullyQualifiedName)),
+						SymbolId scope)
+	  : ASTNode(NodeKind::VariableDeclaration),
+		m_type(type),
+		m_identifier(identifier),
+		m_scope(scope),
 		m_access_mode(accessMode)
 	{}
 
-	void AssignValue(std::unique_ptr<Expression> expression) { m_value = std::move(expression); }
+	void AssignValue(Expression* expression) { m_value = expression; }
 
 	[[nodiscard]] AccessModeType AccessMode() const { return m_access_mode; }
 	[[nodiscard]] const Identifier& Ident() const { return *m_identifier; }
-	[[nodiscard]] Expression* Value() const { return m_value.get(); }
-	[[nodiscard]] const std::string& Name() const { return m_identifier->Name(); }
-	[[nodiscard]] const std::string& FullyQualifiedName() const { return m_fully_qualified_name; }
+	[[nodiscard]] Expression* Value() const { return m_value; }
+	[[nodiscard]] SymbolId Symbol() const { return m_identifier->Symbol(); }
+	[[nodiscard]] std::string_view Name() const { return m_identifier->Name(); }
+	[[nodiscard]] SymbolId Scope() const { return m_scope; }
+	[[nodiscard]] QualifiedSymbol QualifiedName() const { return qualify(m_scope, Symbol()); }
 	[[nodiscard]] auto& Type() const { return m_type; }
 	[[nodiscard]] size_t TypeIndex() const { return m_type.index(); }
 	[[nodiscard]] TokenType TypeAsPrimitive() const { return std::get<TokenType>(m_type); }
-	[[nodiscard]] Identifier* TypeAsIdentifier() const { return std::get<std::unique_ptr<Identifier>>(m_type).get(); }
+	[[nodiscard]] Identifier* TypeAsIdentifier() const { return std::get<Identifier*>(m_type); }
 	[[nodiscard]] std::string TypeName() const
 	{
 		if (m_type.index() == 0)
 			return token_to_string(std::get<0>(m_type));
 		if (m_type.index() == 1)
-			return std::get<1>(m_type)->Name();
+			return std::string(std::get<1>(m_type)->Name());
 		ASSERT_NOT_REACHABLE();
 	}
 };
 
 class IfStatement : public ScopeNode
 {
-	[[nodiscard]] std::string class_name() const override { return "IfStatement"; }
-	std::unique_ptr<Expression> m_condition;
-	std::unique_ptr<BlockStatement> m_body;
-	std::optional<std::unique_ptr<ScopeNode>> m_alternate; // This can be a block statement or another if statement
+	Expression* m_condition;
+	BlockStatement* m_body;
+	std::optional<ScopeNode*> m_alternate; // This can be a block statement or another if statement
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	IfStatement(std::unique_ptr<Expression> expression, std::unique_ptr<BlockStatement> body)
-	  : m_condition(std::move(expression)),
-		m_body(std::move(body))
+	IfStatement(Expression* expression, BlockStatement* body)
+	  : ScopeNode(NodeKind::IfStatement),
+		m_condition(expression),
+		m_body(body)
 	{}
 
-	void SetCondition(const Expression& expression) { m_condition = std::make_unique<Expression>(expression); }
-	void SetAlternate(std::unique_ptr<ScopeNode> alternate) { m_alternate = std::move(alternate); }
+	void SetCondition(Expression* expression) { m_condition = expression; }
+	void SetAlternate(ScopeNode* alternate) { m_alternate = alternate; }
 
-	[[nodiscard]] Expression* Condition() const { return m_condition.get(); }
-	[[nodiscard]] const std::optional<std::unique_ptr<ScopeNode>>& Alternate() const { return m_alternate; }
+	[[nodiscard]] Expression* Condition() const { return m_condition; }
+	[[nodiscard]] const std::optional<ScopeNode*>& Alternate() const { return m_alternate; }
 	[[nodiscard]] bool HasAlternate() const { return m_alternate.has_value(); }
-	[[nodiscard]] ScopeNode* GetAlternate() const { return m_alternate.value().get(); }
+	[[nodiscard]] ScopeNode* GetAlternate() const { return m_alternate.value(); }
 	[[nodiscard]] const BlockStatement& Body() const { return *m_body; }
 };
 
 class WhileStatement : public ScopeNode
 {
-	[[nodiscard]] std::string class_name() const override { return "WhileStatement"; }
-	std::unique_ptr<Expression> m_condition;
-	std::unique_ptr<BlockStatement> m_body;
+	Expression* m_condition;
+	BlockStatement* m_body;
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
-	WhileStatement(std::unique_ptr<Expression> expression, std::unique_ptr<BlockStatement> body)
-	  : m_condition(std::move(expression)),
-		m_body(std::move(body))
+	WhileStatement(Expression* expression, BlockStatement* body)
+	  : ScopeNode(NodeKind::WhileStatement),
+		m_condition(expression),
+		m_body(body)
 	{}
 
-	void SetCondition(const Expression& expression) { m_condition = std::make_unique<Expression>(expression); }
+	void SetCondition(Expression* expression) { m_condition = expression; }
 
-	[[nodiscard]] Expression* Condition() const { return m_condition.get(); }
+	[[nodiscard]] Expression* Condition() const { return m_condition; }
 	[[nodiscard]] const BlockStatement& Body() const { return *m_body; }
-	[[nodiscard]] BlockStatement* BodyPtr() const { return m_body.get(); }
+	[[nodiscard]] BlockStatement* BodyPtr() const { return m_body; }
 };
 
 class FunctionDeclaration : public ScopeNode
 {
-
-	[[nodiscard]] std::string class_name() const override { return "FunctionDeclaration"; }
-
 	TokenType m_return_type;
-	std::unique_ptr<Identifier> m_identifier;
-	std::vector<std::unique_ptr<VariableDeclaration>> m_parameters;
-	std::unique_ptr<BlockStatement> m_body;
+	Identifier* m_identifier;
+	std::span<VariableDeclaration*> m_parameters;
+	BlockStatement* m_body;
 	AccessModeType m_access_mode = AccessModeType::a_global;
 
 public:
 	FunctionDeclaration(TokenType returnType,
-						std::unique_ptr<Identifier> name,
-						std::unique_ptr<BlockStatement> body,
-						std::vector<std::unique_ptr<VariableDeclaration>> args)
-	  : m_return_type(returnType),
-		m_identifier(std::move(name)),
-		m_parameters(std::move(args)),
-		m_body(std::move(body))
+						Identifier* name,
+						BlockStatement* body,
+						std::span<VariableDeclaration*> args)
+	  : ScopeNode(NodeKind::FunctionDeclaration),
+		m_return_type(returnType),
+		m_identifier(name),
+		m_parameters(args),
+		m_body(body)
 	{}
 
 	FunctionDeclaration(TokenType returnType,
-						std::unique_ptr<Identifier> name,
-						std::unique_ptr<BlockStatement> body,
-						std::vector<std::unique_ptr<VariableDeclaration>> args,
+						Identifier* name,
+						BlockStatement* body,
+						std::span<VariableDeclaration*> args,
 						AccessModeType accessMode)
-	  : m_return_type(returnType),
-		m_identifier(std::move(name)),
-		m_parameters(std::move(args)),
-		m_body(std::move(body)),
+	  : ScopeNode(NodeKind::FunctionDeclaration),
+		m_return_type(returnType),
+		m_identifier(name),
+		m_parameters(args),
+		m_body(body),
 		m_access_mode(accessMode)
 	{}
 
@@ -338,55 +451,52 @@ public:
 	[[nodiscard]] TokenType ReturnType() const { return m_return_type; }
 	[[nodiscard]] AccessModeType AccessMode() const { return m_access_mode; }
 	[[nodiscard]] const Identifier& Ident() const { return *m_identifier; }
-	[[nodiscard]] const std::string& Name() const { return m_identifier->Name(); }
+	[[nodiscard]] SymbolId Symbol() const { return m_identifier->Symbol(); }
+	[[nodiscard]] std::string_view Name() const { return m_identifier->Name(); }
 	[[nodiscard]] const BlockStatement& Body() const { return *m_body; }
-	[[nodiscard]] const std::vector<std::unique_ptr<VariableDeclaration>>& Arguments() const { return m_parameters; }
+	[[nodiscard]] std::span<VariableDeclaration* const> Arguments() const { return m_parameters; }
 	[[nodiscard]] size_t Argc() const { return m_parameters.size(); }
 };
 
 class StructDeclaration : public ASTNode
 {
-	[[nodiscard]] std::string class_name() const override { return "StructDeclaration"; }
-	std::string m_name;
-	std::vector<std::unique_ptr<ASTNode>> m_members;
-	std::vector<std::unique_ptr<ASTNode>> m_methods;
+	std::string_view m_name;
+	std::span<ASTNode*> m_members;
+	std::span<ASTNode*> m_methods;
 	size_t m_size{};
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	StructDeclaration(std::string name,
-					  std::vector<std::unique_ptr<ASTNode>> members,
-					  std::vector<std::unique_ptr<ASTNode>> methods);
+	StructDeclaration(std::string_view name, std::span<ASTNode*> members, std::span<ASTNode*> methods);
 
-	[[nodiscard]] const std::string& Name() const { return m_name; }
-	[[nodiscard]] const std::vector<std::unique_ptr<ASTNode>>& Members() const { return m_members; }
-	[[nodiscard]] const std::vector<std::unique_ptr<ASTNode>>& Methods() const { return m_methods; }
+	[[nodiscard]] std::string_view Name() const { return m_name; }
+	[[nodiscard]] std::span<ASTNode* const> Members() const { return m_members; }
+	[[nodiscard]] std::span<ASTNode* const> Methods() const { return m_methods; }
 	[[nodiscard]] size_t Size() const { return m_size; }
 };
 
 class ClassDeclaration : public StructDeclaration
 {
-	[[nodiscard]] std::string class_name() const override { return "ClassDeclaration"; }
 };
 
 class MemberExpression : public Expression
 {
-	[[nodiscard]] std::string class_name() const override { return "MemberExpression"; }
-	std::unique_ptr<Identifier> m_object;
-	std::unique_ptr<Identifier> m_member;
-	std::variant<TokenType, std::unique_ptr<Identifier>> m_type;
+	Identifier* m_object;
+	Identifier* m_member;
+	std::variant<TokenType, Identifier*> m_type;
 	TokenType m_accessor;
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
 
 	MemberExpression(TokenType accessor,
-					 std::unique_ptr<Identifier> object,
-					 std::unique_ptr<Identifier> member,
-					 std::variant<TokenType, std::unique_ptr<Identifier>> type)
-	  : m_object(std::move(object)),
-		m_member(std::move(member)),
-		m_type(std::move(type)),
+					 Identifier* object,
+					 Identifier* member,
+					 std::variant<TokenType, Identifier*> type)
+	  : Expression(NodeKind::MemberExpression),
+		m_object(object),
+		m_member(member),
+		m_type(type),
 		m_accessor(accessor)
 	{}
 
@@ -394,20 +504,19 @@ public:
 	[[nodiscard]] const Identifier& Member() const { return *m_member; }
 	[[nodiscard]] auto* Type() const { return &m_type; }
 	[[nodiscard]] TokenType TypeAsPrimitive() const { return std::get<0>(m_type); }
-	[[nodiscard]] Identifier* TypeAsIdentifier() const { return std::get<1>(m_type).get(); }
+	[[nodiscard]] Identifier* TypeAsIdentifier() const { return std::get<1>(m_type); }
 	[[nodiscard]] size_t TypeIndex() const { return m_type.index(); }
 	[[nodiscard]] TokenType Accessor() const { return m_accessor; }
 };
 
 class ReturnStatement : public ASTNode
 {
-	[[nodiscard]] std::string class_name() const override { return "ReturnStatement"; }
-	std::unique_ptr<Expression> m_argument;
+	Expression* m_argument;
 
 public:
 	[[maybe_unused]] void PrintNode(int indent) const override;
-	explicit ReturnStatement(std::unique_ptr<Expression> argument) : m_argument(std::move(argument)) {}
-	[[nodiscard]] Expression* Argument() const { return m_argument.get(); }
+	explicit ReturnStatement(Expression* argument) : ASTNode(NodeKind::ReturnStatement), m_argument(argument) {}
+	[[nodiscard]] Expression* Argument() const { return m_argument; }
 };
 
 }
\ No newline at end of file
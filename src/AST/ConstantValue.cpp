@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-29.
+//
+
+#include "ConstantValue.h"
+
+#include <cmath>
+#include <limits>
+
+namespace alx {
+
+namespace {
+
+// The type both operands of a binary operator are converted to, as in C: bool, char and short are promoted to int
+// first, and the result is the wider of the two
+TokenType commonType(TokenType lhs, TokenType rhs)
+{
+	if (lhs == TokenType::T_DOUBLE || rhs == TokenType::T_DOUBLE)
+		return TokenType::T_DOUBLE;
+	if (lhs == TokenType::T_FLOAT || rhs == TokenType::T_FLOAT)
+		return TokenType::T_FLOAT;
+	if (lhs == TokenType::T_LONG || rhs == TokenType::T_LONG)
+		return TokenType::T_LONG;
+	return TokenType::T_INT;
+}
+
+// The type of a constant made from a literal or of a type. As in C, an integer literal too big for an int is a long.
+TokenType typeOf(TokenType type, NumberValue value)
+{
+	if (!isNumberLiteral(type))
+		return type;
+	const auto* integer = std::get_if<long>(&value);
+	if (type == TokenType::T_INT_L && integer && *integer != static_cast<int32_t>(*integer))
+		return TokenType::T_LONG;
+	return literal_to_type(type);
+}
+
+long wrap(TokenType type, long value)
+{
+	switch (type) {
+	case TokenType::T_BOOL:
+		return value != 0;
+	case TokenType::T_CHAR:
+		return static_cast<int8_t>(value);
+	case TokenType::T_SHORT:
+		return static_cast<int16_t>(value);
+	case TokenType::T_INT:
+		return static_cast<int32_t>(value);
+	case TokenType::T_LONG:
+		return value;
+	default:
+		ASSERT_NOT_REACHABLE();
+	}
+}
+
+// Out of range values saturate rather than being undefined like a plain cast
+long toInteger(double value)
+{
+	constexpr auto limit = static_cast<double>(std::numeric_limits<long>::max());
+	if (std::isnan(value))
+		return 0;
+	if (value >= limit)
+		return std::numeric_limits<long>::max();
+	if (value <= -limit)
+		return std::numeric_limits<long>::min();
+	return static_cast<long>(value);
+}
+
+// A float result that overflowed or isn't a number has no literal to fold to, so it's left for the program to work out
+std::optional<ConstantValue> finite(const ConstantValue& value)
+{
+	if (std::isfinite(value.AsDouble()))
+		return value;
+	return {};
+}
+
+// Integer arithmetic is done on unsigned values so that overflow wraps instead of being undefined
+long wrappingAdd(long lhs, long rhs)
+{
+	return static_cast<long>(static_cast<unsigned long>(lhs) + static_cast<unsigned long>(rhs));
+}
+
+long wrappingSub(long lhs, long rhs)
+{
+	return static_cast<long>(static_cast<unsigned long>(lhs) - static_cast<unsigned long>(rhs));
+}
+
+long wrappingMul(long lhs, long rhs)
+{
+	return static_cast<long>(static_cast<unsigned long>(lhs) * static_cast<unsigned long>(rhs));
+}
+
+std::optional<long> integerPow(long base, long exponent)
+{
+	if (exponent < 0) {
+		if (base == 0)
+			return {};
+		if (base == 1 || base == -1)
+			return exponent % 2 ? base : 1;
+		return 0;
+	}
+	long result = 1;
+	for (; exponent; exponent >>= 1) {
+		if (exponent & 1)
+			result = wrappingMul(result, base);
+		base = wrappingMul(base, base);
+	}
+	return result;
+}
+
+ConstantValue truth(bool value)
+{
+	return { TokenType::T_INT, static_cast<long>(value) };
+}
+
+} // namespace
+
+ConstantValue::ConstantValue(TokenType type, NumberValue value)
+  : m_type(typeOf(type, value))
+{
+	MUST(isNumberType(m_type) && "Constants can only be of a number type");
+	if (IsFloatingPoint()) {
+		const auto number = std::visit([](auto v) { return static_cast<double>(v); }, value);
+		m_value = m_type == TokenType::T_FLOAT ? static_cast<float>(number) : number;
+	}
+	else if (std::holds_alternative<double>(value))
+		m_value = m_type == TokenType::T_BOOL ? std::get<double>(value) != 0
+											  : wrap(m_type, toInteger(std::get<double>(value)));
+	else
+		m_value = wrap(m_type, std::get<long>(value));
+}
+
+std::optional<ConstantValue> ConstantValue::Fold(TokenType op, const ConstantValue& lhs, const ConstantValue& rhs)
+{
+	const auto type = commonType(lhs.m_type, rhs.m_type);
+	if (type == TokenType::T_FLOAT || type == TokenType::T_DOUBLE) {
+		const auto a = lhs.AsDouble();
+		const auto b = rhs.AsDouble();
+		switch (op) {
+		case TokenType::T_PLUS:
+			return finite({ type, a + b });
+		case TokenType::T_MINUS:
+			return finite({ type, a - b });
+		case TokenType::T_STAR:
+			return finite({ type, a * b });
+		case TokenType::T_FWD_SLASH:
+		case TokenType::T_COLON:
+			return finite({ type, a / b });
+		case TokenType::T_MOD:
+			return finite({ type, std::fmod(a, b) });
+		case TokenType::T_POW:
+			return finite({ type, std::pow(a, b) });
+		case TokenType::T_LT:
+			return truth(a < b);
+		case TokenType::T_GT:
+			return truth(a > b);
+		case TokenType::T_LTE:
+			return truth(a <= b);
+		case TokenType::T_GTE:
+			return truth(a >= b);
+		case TokenType::T_EQEQ:
+			return truth(a == b);
+		case TokenType::T_NOT_EQ:
+			return truth(a != b);
+		default:
+			return {};
+		}
+	}
+
+	const auto a = lhs.AsInt();
+	const auto b = rhs.AsInt();
+	switch (op) {
+	case TokenType::T_PLUS:
+		return ConstantValue{ type, wrappingAdd(a, b) };
+	case TokenType::T_MINUS:
+		return ConstantValue{ type, wrappingSub(a, b) };
+	case TokenType::T_STAR:
+		return ConstantValue{ type, wrappingMul(a, b) };
+	case TokenType::T_FWD_SLASH:
+	case TokenType::T_COLON:
+		if (b == 0)
+			return {};
+		// The one quotient that doesn't fit: LONG_MIN / -1
+		return ConstantValue{ type, b == -1 ? wrappingSub(0, a) : a / b };
+	case TokenType::T_MOD:
+		if (b == 0)
+			return {};
+		return ConstantValue{ type, b == -1 ? 0 : a % b };
+	case TokenType::T_POW: {
+		const auto result = integerPow(a, b);
+		if (!result)
+			return {};
+		return ConstantValue{ type, *result };
+	}
+	case TokenType::T_LT:
+		return truth(a < b);
+	case TokenType::T_GT:
+		return truth(a > b);
+	case TokenType::T_LTE:
+		return truth(a <= b);
+	case TokenType::T_GTE:
+		return truth(a >= b);
+	case TokenType::T_EQEQ:
+		return truth(a == b);
+	case TokenType::T_NOT_EQ:
+		return truth(a != b);
+	default:
+		return {};
+	}
+}
+
+std::optional<ConstantValue> ConstantValue::Fold(TokenType op, const ConstantValue& operand)
+{
+	const auto type = commonType(operand.m_type, TokenType::T_INT);
+	switch (op) {
+	case TokenType::T_PLUS:
+		return operand.Cast(type);
+	case TokenType::T_MINUS:
+		if (operand.IsFloatingPoint())
+			return ConstantValue{ type, -operand.AsDouble() };
+		return ConstantValue{ type, wrappingSub(0, operand.AsInt()) };
+	case TokenType::T_NOT:
+		return truth(!operand.AsBool());
+	default:
+		return {};
+	}
+}
+
+TokenType ConstantValue::LiteralType() const
+{
+	switch (m_type) {
+	case TokenType::T_BOOL:
+		return AsInt() ? TokenType::T_TRUE : TokenType::T_FALSE;
+	case TokenType::T_CHAR:
+		return TokenType::T_CHAR_L;
+	case TokenType::T_FLOAT:
+		return TokenType::T_FLOAT_L;
+	case TokenType::T_DOUBLE:
+		return TokenType::T_DOUBLE_L;
+	default:
+		return TokenType::T_INT_L;
+	}
+}
+
+long ConstantValue::AsInt() const
+{
+	if (auto number = std::get_if<double>(&m_value))
+		return toInteger(*number);
+	return std::get<long>(m_value);
+}
+
+double ConstantValue::AsDouble() const
+{
+	return std::visit([](auto number) { return static_cast<double>(number); }, m_value);
+}
+
+} // namespace alx
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-29.
+//
+
+#pragma once
+
+#include <optional>
+#include "../Utils/Types.h"
+
+namespace alx {
+
+// The value of a constant expression, held as one of the language's number types: bool, char (i8), short (i16),
+// int (i32), long (i64), float or double. Integers wrap to their type's width the way two's complement hardware does,
+// and floats are rounded to single precision, so a folded expression has the value the program would compute at run
+// time.
+class ConstantValue
+{
+	TokenType m_type;
+	NumberValue m_value; // long for bool and the integer types, double for float and double
+
+public:
+	// `type` is a number type or a number literal's token; `value` is converted to it
+	ConstantValue(TokenType type, NumberValue value);
+
+	// Null if the operation isn't one that can be folded (assignments, ++ and --) or has no value, e.g. dividing an
+	// integer by zero or a float result that overflows, which is left for the program to do.
+	[[nodiscard]] static std::optional<ConstantValue>
+	Fold(TokenType op, const ConstantValue& lhs, const ConstantValue& rhs);
+	[[nodiscard]] static std::optional<ConstantValue> Fold(TokenType op, const ConstantValue& operand);
+
+	// The value as it would be stored in a variable of type `type`
+	[[nodiscard]] ConstantValue Cast(TokenType type) const { return { type, m_value }; }
+
+	[[nodiscard]] TokenType Type() const { return m_type; }
+	// The literal token with this value's type, e.g. T_INT_L for an int, and T_TRUE or T_FALSE for a bool
+	[[nodiscard]] TokenType LiteralType() const;
+	[[nodiscard]] const NumberValue& Value() const { return m_value; }
+	[[nodiscard]] bool IsFloatingPoint() const { return m_type == TokenType::T_FLOAT || m_type == TokenType::T_DOUBLE; }
+	[[nodiscard]] long AsInt() const;
+	[[nodiscard]] double AsDouble() const;
+	[[nodiscard]] bool AsBool() const { return IsFloatingPoint() ? AsDouble() != 0 : AsInt() != 0; }
+};
+
+} // namespace alx
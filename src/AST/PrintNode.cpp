@@ -27,7 +27,7 @@ static std::string access_mode_to_string(AccessModeType mode)
 	}
 }
 
-void ScopeNode::dump_nodes(const std::vector<std::unique_ptr<ASTNode>>& Children, int indent)
+void ScopeNode::dump_nodes(std::span<ASTNode* const> Children, int indent)
 {
 	for (const auto& child : Children) {
 		child->PrintNode(indent);
@@ -52,19 +52,19 @@ void NumberLiteral::PrintNode(int indent) const
 	switch (m_type) {
 	case TokenType::T_INT_L:
 		println("{>}type: {}", indent + 2, "int");
-		println("{>}value: {}", indent + 2, m_value);
+		println("{>}value: {}", indent + 2, Value());
 		break;
 	case TokenType::T_FLOAT_L:
 		println("{>}type: {}", indent + 2, "float");
-		println("{>}value: {}", indent + 2, m_value);
+		println("{>}value: {}", indent + 2, Value());
 		break;
 	case TokenType::T_DOUBLE_L:
 		println("{>}type: {}", indent + 2, "double");
-		println("{>}value: {}", indent + 2, m_value);
+		println("{>}value: {}", indent + 2, Value());
 		break;
 	case TokenType::T_CHAR_L:
 		println("{>}type: {}", indent + 2, "char");
-		println("{>}value: {}", indent + 2, m_value);
+		println("{>}value: {}", indent + 2, Value());
 		break;
 	case TokenType::T_FALSE:
 	case TokenType::T_TRUE:
@@ -113,7 +113,7 @@ void FunctionDeclaration::PrintNode(int indent) const
 void BinaryExpression::PrintNode(int indent) const
 {
 	println("{>}BinaryExpression: {", indent);
-	println("{>}constexpr: {}", indent + 2, m_constexpr);
+	println("{>}constexpr: {}", indent + 2, Constexpr());
 	println("{>}lhs:", indent + 2);
 	m_lhs->PrintNode(indent + 4);
 	println("{>}operator: {}", indent + 2, token_to_string(m_binary_op));
@@ -124,7 +124,7 @@ void BinaryExpression::PrintNode(int indent) const
 
 void StringLiteral::PrintNode(int indent) const
 {
-	println("{>}ReturnStatement: {\n{>}value: {}\n{>}length: ", indent, indent + 2, m_value, indent + 2, Length());
+	println("{>}ReturnStatement: {\n{>}value: {}\n{>}length: {}", indent, indent + 2, m_value, indent + 2, Length());
 	println("{>}}", indent);
 }
 void ReturnStatement::PrintNode(int indent) const
@@ -153,6 +153,8 @@ void UnaryExpression::PrintNode(int indent) const
 {
 	println("{>}UnaryExpression: {", indent);
 	println("{>}operator: {}", indent + 2, token_to_string(m_unary_op));
+	if (m_postfix)
+		println("{>}postfix", indent + 2);
 	println("{>}rhs:", indent + 2);
 	m_rhs->PrintNode(indent + 4);
 	println("{>}}", indent);
@@ -173,7 +175,7 @@ void StructDeclaration::PrintNode(int indent) const
 	println("{>}member variables:", indent + 2);
 	if (!m_members.empty()) {
 		for (const auto& var : m_members) {
-			auto member = static_cast<VariableDeclaration*>(var.get());
+			auto member = static_cast<VariableDeclaration*>(var);
 			println("{>}type: {}, identifier: {}, access mode: {}, default initialised?: {}",
 					indent + 4,
 					token_to_string(member->TypeAsPrimitive()),
@@ -185,8 +187,8 @@ void StructDeclaration::PrintNode(int indent) const
 	if (!m_methods.empty()) {
 		println("{>}member methods:", indent + 2);
 		for (const auto& var : m_methods) {
-			auto method = static_cast<FunctionDeclaration*>(var.get());
-			println("{>}return type: {}, identifier: {}, default initialised?: {}",
+			auto method = static_cast<FunctionDeclaration*>(var);
+			println("{>}return type: {}, identifier: {}",
 					indent + 4,
 					token_to_string(method->ReturnType()),
 					method->Name());
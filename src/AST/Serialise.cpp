@@ -0,0 +1,618 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-28.
+//
+
+#include "Serialise.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "../Utils/Utils.h"
+
+namespace alx {
+
+namespace {
+
+constexpr std::array<char, 4> Magic{ 'A', 'L', 'X', 'A' };
+
+struct Header {
+	std::array<char, 4> Magic;
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t StringCount;
+	uint32_t StringWords; // Bytes of string data, rounded up to whole words
+	uint32_t NodeCount;
+	uint32_t NodeWords;
+	uint32_t StatementCount;
+	uint32_t Reserved;
+};
+static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % sizeof(uint32_t) == 0);
+
+constexpr size_t WordsPerStatement = 3;
+
+// Calls `visit` with every node `node` refers to, which may include nulls
+template<typename Callback>
+void forEachChild(const ASTNode* node, Callback visit)
+{
+	const auto visitAll = [&visit](auto children) {
+		for (const auto* child : children)
+			visit(child);
+	};
+	switch (node->Kind()) {
+	case NodeKind::Identifier:
+	case NodeKind::NumberLiteral:
+	case NodeKind::StringLiteral:
+		return;
+	case NodeKind::BinaryExpression: {
+		auto binary = static_cast<const BinaryExpression*>(node);
+		visit(binary->Lhs());
+		visit(binary->Rhs());
+		return;
+	}
+	case NodeKind::UnaryExpression:
+		visit(static_cast<const UnaryExpression*>(node)->Rhs());
+		return;
+	case NodeKind::VariableDeclaration: {
+		auto variable = static_cast<const VariableDeclaration*>(node);
+		if (variable->TypeIndex() == 1)
+			visit(variable->TypeAsIdentifier());
+		visit(&variable->Ident());
+		visit(variable->Value());
+		return;
+	}
+	case NodeKind::MemberExpression: {
+		auto member = static_cast<const MemberExpression*>(node);
+		visit(&member->Object());
+		visit(&member->Member());
+		if (member->TypeIndex() == 1)
+			visit(member->TypeAsIdentifier());
+		return;
+	}
+	case NodeKind::ReturnStatement:
+		visit(static_cast<const ReturnStatement*>(node)->Argument());
+		return;
+	case NodeKind::StructDeclaration: {
+		auto declaration = static_cast<const StructDeclaration*>(node);
+		visitAll(declaration->Members());
+		visitAll(declaration->Methods());
+		return;
+	}
+	case NodeKind::BlockStatement:
+		break;
+	case NodeKind::IfStatement: {
+		auto statement = static_cast<const IfStatement*>(node);
+		visit(statement->Condition());
+		visit(&statement->Body());
+		if (statement->HasAlternate())
+			visit(statement->GetAlternate());
+		break;
+	}
+	case NodeKind::WhileStatement: {
+		auto statement = static_cast<const WhileStatement*>(node);
+		visit(statement->Condition());
+		visit(statement->BodyPtr());
+		break;
+	}
+	case NodeKind::FunctionDeclaration: {
+		auto function = static_cast<const FunctionDeclaration*>(node);
+		visit(&function->Ident());
+		visitAll(function->Arguments());
+		visit(&function->Body());
+		break;
+	}
+	default:
+		throw std::runtime_error("Can't serialise a " + std::string(node->class_name()));
+	}
+	visitAll(static_cast<const ScopeNode*>(node)->Children());
+}
+
+class Writer
+{
+	const Interner& m_interner;
+	std::vector<std::string_view> m_strings;
+	std::unordered_map<std::string_view, uint32_t> m_string_indices;
+	std::vector<uint32_t> m_nodes;
+	std::unordered_map<const ASTNode*, uint32_t> m_node_refs;
+	std::vector<uint32_t> m_statements;
+
+public:
+	explicit Writer(const Interner& interner) : m_interner(interner) {}
+
+	std::string Write(const Program& program, uint64_t key)
+	{
+		const auto statements = program.GetChildren();
+		const auto spans = program.Spans();
+		for (size_t i = 0; i < statements.size(); ++i) {
+			write_tree(statements[i]);
+			m_statements.push_back(ref(statements[i]));
+			m_statements.push_back(static_cast<uint32_t>(spans[i].Begin));
+			m_statements.push_back(static_cast<uint32_t>(spans[i].End));
+		}
+
+		std::vector<uint32_t> stringTable;
+		std::string stringData;
+		for (const auto string : m_strings) {
+			stringTable.push_back(static_cast<uint32_t>(stringData.size()));
+			stringTable.push_back(static_cast<uint32_t>(string.size()));
+			stringData += string;
+		}
+		stringData.resize((stringData.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t));
+
+		const Header header{ .Magic = Magic,
+							 .Version = AstFormatVersion,
+							 .Key = key,
+							 .StringCount = static_cast<uint32_t>(m_strings.size()),
+							 .StringWords = static_cast<uint32_t>(stringData.size() / sizeof(uint32_t)),
+							 .NodeCount = static_cast<uint32_t>(m_node_refs.size()),
+							 .NodeWords = static_cast<uint32_t>(m_nodes.size()),
+							 .StatementCount = static_cast<uint32_t>(statements.size()),
+							 .Reserved = 0 };
+		std::string bytes;
+		bytes.reserve(sizeof(header) + stringData.size()
+					  + (stringTable.size() + m_nodes.size() + m_statements.size()) * sizeof(uint32_t));
+		bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		append(bytes, stringTable);
+		bytes += stringData;
+		append(bytes, m_nodes);
+		append(bytes, m_statements);
+		return bytes;
+	}
+
+private:
+	static void append(std::string& bytes, const std::vector<uint32_t>& words)
+	{
+		bytes.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint32_t));
+	}
+
+	// Writes out every node under `root` that hasn't been already, children first. Expressions can nest far deeper
+	// than the native stack would allow recursing, so this walks the tree on a stack of its own.
+	void write_tree(const ASTNode* root)
+	{
+		std::vector<std::pair<const ASTNode*, bool>> stack{ { root, false } };
+		while (!stack.empty()) {
+			const auto [node, expanded] = stack.back();
+			if (m_node_refs.contains(node)) {
+				stack.pop_back();
+				continue;
+			}
+			if (expanded) {
+				write_node(node);
+				stack.pop_back();
+				continue;
+			}
+			stack.back().second = true;
+			forEachChild(node, [this, &stack](const ASTNode* child) {
+				if (child && !m_node_refs.contains(child))
+					stack.emplace_back(child, false);
+			});
+		}
+	}
+
+	void write_node(const ASTNode* node)
+	{
+		m_nodes.push_back(static_cast<uint32_t>(node->Kind()));
+		switch (node->Kind()) {
+		case NodeKind::Identifier: {
+			auto identifier = static_cast<const Identifier*>(node);
+			symbol(identifier->Symbol());
+			string(identifier->Name());
+			m_nodes.push_back((identifier->Assignable() ? 1 : 0) | (identifier->Deprecated() ? 2 : 0));
+			break;
+		}
+		case NodeKind::NumberLiteral: {
+			auto literal = static_cast<const NumberLiteral*>(node);
+			token(literal->Type());
+			string(literal->Value());
+			const auto& number = literal->Number();
+			const auto bits = std::visit([](auto value) { return std::bit_cast<uint64_t>(value); }, number);
+			m_nodes.push_back(static_cast<uint32_t>(number.index()));
+			m_nodes.push_back(static_cast<uint32_t>(bits));
+			m_nodes.push_back(static_cast<uint32_t>(bits >> 32));
+			break;
+		}
+		case NodeKind::StringLiteral:
+			string(static_cast<const StringLiteral*>(node)->Value());
+			break;
+		case NodeKind::BinaryExpression: {
+			auto binary = static_cast<const BinaryExpression*>(node);
+			token(binary->Operator());
+			child(binary->Lhs());
+			child(binary->Rhs());
+			break;
+		}
+		case NodeKind::UnaryExpression: {
+			auto unary = static_cast<const UnaryExpression*>(node);
+			token(unary->Operator());
+			m_nodes.push_back(unary->Postfix());
+			child(unary->Rhs());
+			break;
+		}
+		case NodeKind::VariableDeclaration: {
+			auto variable = static_cast<const VariableDeclaration*>(node);
+			type(variable->Type());
+			child(&variable->Ident());
+			child(variable->Value());
+			m_nodes.push_back(static_cast<uint32_t>(variable->AccessMode()));
+			symbol(variable->Scope());
+			break;
+		}
+		case NodeKind::MemberExpression: {
+			auto member = static_cast<const MemberExpression*>(node);
+			token(member->Accessor());
+			child(&member->Object());
+			child(&member->Member());
+			type(*member->Type());
+			break;
+		}
+		case NodeKind::ReturnStatement:
+			child(static_cast<const ReturnStatement*>(node)->Argument());
+			break;
+		case NodeKind::StructDeclaration: {
+			auto declaration = static_cast<const StructDeclaration*>(node);
+			string(declaration->Name());
+			children(declaration->Members());
+			children(declaration->Methods());
+			break;
+		}
+		case NodeKind::BlockStatement:
+			children(static_cast<const BlockStatement*>(node)->Children());
+			break;
+		case NodeKind::IfStatement: {
+			auto statement = static_cast<const IfStatement*>(node);
+			child(statement->Condition());
+			child(&statement->Body());
+			m_nodes.push_back(statement->HasAlternate());
+			child(statement->HasAlternate() ? statement->GetAlternate() : nullptr);
+			children(statement->Children());
+			break;
+		}
+		case NodeKind::WhileStatement: {
+			auto statement = static_cast<const WhileStatement*>(node);
+			child(statement->Condition());
+			child(statement->BodyPtr());
+			children(statement->Children());
+			break;
+		}
+		case NodeKind::FunctionDeclaration: {
+			auto function = static_cast<const FunctionDeclaration*>(node);
+			token(function->ReturnType());
+			child(&function->Ident());
+			children(function->Arguments());
+			child(&function->Body());
+			m_nodes.push_back(static_cast<uint32_t>(function->AccessMode()));
+			children(function->Children());
+			break;
+		}
+		default:
+			ASSERT_NOT_REACHABLE(); // forEachChild() has already turned it down
+		}
+		m_node_refs.emplace(node, static_cast<uint32_t>(m_node_refs.size() + 1));
+	}
+
+	[[nodiscard]] uint32_t ref(const ASTNode* node) const { return node ? m_node_refs.at(node) : 0; }
+	void child(const ASTNode* node) { m_nodes.push_back(ref(node)); }
+	template<typename T>
+	void children(std::span<T* const> nodes)
+	{
+		m_nodes.push_back(static_cast<uint32_t>(nodes.size()));
+		for (const auto* node : nodes)
+			child(node);
+	}
+	void token(TokenType type) { m_nodes.push_back(static_cast<uint32_t>(type)); }
+	void type(const std::variant<TokenType, Identifier*>& type)
+	{
+		m_nodes.push_back(static_cast<uint32_t>(type.index()));
+		if (type.index() == 0)
+			token(std::get<TokenType>(type));
+		else
+			child(std::get<Identifier*>(type));
+	}
+
+	void string(std::string_view text)
+	{
+		auto [it, inserted] = m_string_indices.try_emplace(text, static_cast<uint32_t>(m_strings.size()));
+		if (inserted)
+			m_strings.push_back(text);
+		m_nodes.push_back(it->second);
+	}
+	// Symbols are written as their name's string index plus one, 0 being NoSymbol
+	void symbol(SymbolId symbol)
+	{
+		if (symbol == NoSymbol) {
+			m_nodes.push_back(0);
+			return;
+		}
+		string(m_interner.Name(symbol));
+		++m_nodes.back();
+	}
+};
+
+template<typename T>
+constexpr bool isKindOf(NodeKind kind)
+{
+	if constexpr (std::is_same_v<T, ASTNode>)
+		return true;
+	else if constexpr (std::is_same_v<T, Expression>)
+		return kind == NodeKind::Identifier || kind == NodeKind::NumberLiteral || kind == NodeKind::StringLiteral
+			|| kind == NodeKind::BinaryExpression || kind == NodeKind::UnaryExpression
+			|| kind == NodeKind::MemberExpression;
+	else if constexpr (std::is_same_v<T, ScopeNode>)
+		return kind == NodeKind::BlockStatement || kind == NodeKind::IfStatement || kind == NodeKind::WhileStatement
+			|| kind == NodeKind::FunctionDeclaration;
+	else if constexpr (std::is_same_v<T, Identifier>)
+		return kind == NodeKind::Identifier;
+	else if constexpr (std::is_same_v<T, BlockStatement>)
+		return kind == NodeKind::BlockStatement;
+	else if constexpr (std::is_same_v<T, VariableDeclaration>)
+		return kind == NodeKind::VariableDeclaration;
+	else
+		static_assert(!sizeof(T), "No kind check for this node type");
+}
+
+// Reads a file written by Writer, checking every index and count against the file as it goes so a damaged file is
+// turned down rather than trusted
+class Reader
+{
+	std::string_view m_bytes;
+	size_t m_offset{};
+	size_t m_end{}; // End of the section being read
+	Interner& m_interner;
+	Program& m_program;
+	std::vector<std::string_view> m_strings;
+	std::vector<SymbolId> m_symbols; // Interned on first use, by string index
+	std::vector<ASTNode*> m_nodes;
+
+public:
+	Reader(std::string_view bytes, Interner& interner, Program& program)
+	  : m_bytes(bytes),
+		m_interner(interner),
+		m_program(program)
+	{}
+
+	void Read(const Header& header)
+	{
+		m_offset = sizeof(Header);
+		const auto stringData = m_offset + size_t{ header.StringCount } * 2 * sizeof(uint32_t);
+		const auto nodes = stringData + size_t{ header.StringWords } * sizeof(uint32_t);
+		const auto statements = nodes + size_t{ header.NodeWords } * sizeof(uint32_t);
+		if (statements + size_t{ header.StatementCount } * WordsPerStatement * sizeof(uint32_t) != m_bytes.size())
+			corrupt();
+
+		m_end = stringData;
+		m_strings.reserve(header.StringCount);
+		for (uint32_t i = 0; i < header.StringCount; ++i) {
+			const auto offset = word();
+			const auto length = word();
+			if (size_t{ offset } + length > nodes - stringData)
+				corrupt();
+			m_strings.push_back(m_bytes.substr(stringData + offset, length));
+		}
+		m_symbols.resize(m_strings.size(), NoSymbol);
+
+		m_offset = nodes;
+		m_end = statements;
+		m_nodes.reserve(header.NodeCount);
+		while (m_offset < m_end)
+			m_nodes.push_back(read_node());
+		if (m_nodes.size() != header.NodeCount)
+			corrupt();
+
+		m_end = m_bytes.size();
+		for (uint32_t i = 0; i < header.StatementCount; ++i) {
+			auto* statement = node<ASTNode>();
+			const auto begin = word();
+			const auto end = word();
+			m_program.Append(statement, { .Begin = begin, .End = end });
+		}
+	}
+
+private:
+	[[noreturn]] static void corrupt() { throw std::runtime_error("Corrupt AST file"); }
+
+	uint32_t word()
+	{
+		if (m_offset + sizeof(uint32_t) > m_end)
+			corrupt();
+		uint32_t word;
+		std::memcpy(&word, m_bytes.data() + m_offset, sizeof(word));
+		m_offset += sizeof(word);
+		return word;
+	}
+
+	template<typename T, typename... Args>
+	T* make(Args&&... args)
+	{
+		return m_program.Arena().Make<T>(std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	T* node(bool optional = false)
+	{
+		const auto ref = word();
+		if (ref == 0 && optional)
+			return nullptr;
+		if (ref == 0 || ref > m_nodes.size() || !isKindOf<T>(m_nodes[ref - 1]->Kind()))
+			corrupt();
+		return static_cast<T*>(m_nodes[ref - 1]);
+	}
+	template<typename T>
+	std::span<T*> children()
+	{
+		const auto count = word();
+		if (count > (m_end - m_offset) / sizeof(uint32_t))
+			corrupt();
+		auto nodes = m_program.Arena().Allocate<T*>(count);
+		for (auto& child : nodes)
+			child = node<T>();
+		return nodes;
+	}
+	TokenType token()
+	{
+		const auto type = word();
+		if (type >= TokenTypeCount)
+			corrupt();
+		return static_cast<TokenType>(type);
+	}
+	std::variant<TokenType, Identifier*> type()
+	{
+		const auto index = word();
+		if (index > 1)
+			corrupt();
+		if (index == 0)
+			return token();
+		return node<Identifier>();
+	}
+	AccessModeType access_mode()
+	{
+		const auto mode = word();
+		if (mode > static_cast<uint32_t>(AccessModeType::a_private))
+			corrupt();
+		return static_cast<AccessModeType>(mode);
+	}
+	uint32_t string_index()
+	{
+		const auto index = word();
+		if (index >= m_strings.size())
+			corrupt();
+		return index;
+	}
+	std::string_view string() { return m_strings[string_index()]; }
+	SymbolId symbol()
+	{
+		const auto ref = word();
+		if (ref == 0)
+			return NoSymbol;
+		if (ref > m_strings.size())
+			corrupt();
+		auto& symbol = m_symbols[ref - 1];
+		if (symbol == NoSymbol)
+			symbol = m_interner.Intern(m_strings[ref - 1]);
+		return symbol;
+	}
+
+	ASTNode* read_node()
+	{
+		switch (static_cast<NodeKind>(word())) {
+		case NodeKind::Identifier: {
+			const auto symbol = this->symbol();
+			const auto name = string();
+			const auto flags = word();
+			auto* identifier = make<Identifier>(symbol, name, (flags & 1) != 0);
+			identifier->SetDeprecated((flags & 2) != 0);
+			return identifier;
+		}
+		case NodeKind::NumberLiteral: {
+			const auto type = token();
+			const auto value = string();
+			const auto index = word();
+			const uint64_t low = word();
+			const uint64_t bits = low | uint64_t{ word() } << 32;
+			if (index > 1)
+				corrupt();
+			const auto number = index == 0 ? NumberValue(std::bit_cast<long>(bits)) : std::bit_cast<double>(bits);
+			return make<NumberLiteral>(type, value, number);
+		}
+		case NodeKind::StringLiteral:
+			return make<StringLiteral>(string());
+		case NodeKind::BinaryExpression: {
+			const auto op = token();
+			auto* lhs = node<Expression>();
+			auto* rhs = node<Expression>();
+			if (!isBinaryOp(op))
+				corrupt();
+			return make<BinaryExpression>(lhs, rhs, op);
+		}
+		case NodeKind::UnaryExpression: {
+			const auto op = token();
+			const auto postfix = word() != 0;
+			return make<UnaryExpression>(node<Expression>(), op, postfix);
+		}
+		case NodeKind::VariableDeclaration: {
+			const auto type = this->type();
+			auto* identifier = node<Identifier>();
+			auto* value = node<Expression>(true);
+			const auto accessMode = access_mode();
+			return make<VariableDeclaration>(type, identifier, value, accessMode, symbol());
+		}
+		case NodeKind::MemberExpression: {
+			const auto accessor = token();
+			auto* object = node<Identifier>();
+			auto* member = node<Identifier>();
+			return make<MemberExpression>(accessor, object, member, type());
+		}
+		case NodeKind::ReturnStatement:
+			return make<ReturnStatement>(node<Expression>(true));
+		case NodeKind::StructDeclaration: {
+			const auto name = string();
+			const auto members = children<ASTNode>();
+			for (const auto* member : members) {
+				if (member->Kind() != NodeKind::VariableDeclaration)
+					corrupt();
+			}
+			return make<StructDeclaration>(name, members, children<ASTNode>());
+		}
+		case NodeKind::BlockStatement: {
+			auto* block = make<BlockStatement>();
+			block->SetChildren(children<ASTNode>());
+			return block;
+		}
+		case NodeKind::IfStatement: {
+			auto* condition = node<Expression>();
+			auto* statement = make<IfStatement>(condition, node<BlockStatement>());
+			const auto hasAlternate = word() != 0;
+			auto* alternate = node<ScopeNode>(!hasAlternate);
+			if (hasAlternate)
+				statement->SetAlternate(alternate);
+			statement->SetChildren(children<ASTNode>());
+			return statement;
+		}
+		case NodeKind::WhileStatement: {
+			auto* condition = node<Expression>();
+			auto* statement = make<WhileStatement>(condition, node<BlockStatement>());
+			statement->SetChildren(children<ASTNode>());
+			return statement;
+		}
+		case NodeKind::FunctionDeclaration: {
+			const auto returnType = token();
+			auto* identifier = node<Identifier>();
+			const auto arguments = children<VariableDeclaration>();
+			auto* body = node<BlockStatement>();
+			auto* function = make<FunctionDeclaration>(returnType, identifier, body, arguments, access_mode());
+			function->SetChildren(children<ASTNode>());
+			return function;
+		}
+		default:
+			corrupt();
+		}
+	}
+};
+
+} // namespace
+
+std::string serialiseProgram(const Program& program, const Interner& interner, uint64_t key)
+{
+	return Writer(interner).Write(program, key);
+}
+
+std::unique_ptr<Program> deserialiseProgram(std::string_view bytes, Interner& interner, uint64_t key)
+{
+	Header header{};
+	if (bytes.size() < sizeof(header))
+		return nullptr;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if (header.Magic != Magic || header.Version != AstFormatVersion || header.Key != key)
+		return nullptr;
+	auto program = std::make_unique<Program>();
+	Reader(bytes, interner, *program).Read(header);
+	return program;
+}
+
+} // namespace alx
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-28.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "Ast.h"
+#include "../Utils/Interner.h"
+
+namespace alx {
+
+// Bumped whenever the layout below or the meaning of a node's fields changes, so that older files are ignored
+constexpr uint32_t AstFormatVersion = 1;
+
+// Binary AST format. Everything is a 32-bit word in the host's byte order, after a fixed header:
+//
+//   strings:    (offset, length) for each string, then the string bytes padded to a whole word
+//   nodes:      one record per node, children before their parents. A record is the node's kind followed by its
+//               fields; a child is referred to by its node's index plus one, so that 0 can mean none, and a list of
+//               children is its length followed by the children
+//   statements: (node, source span begin, source span end) for each of the Program's statements
+//
+// Names and literals are indices into the string table, and symbols are interned again when the file is read, so a
+// file doesn't depend on the interner it was written with.
+//
+// `key` is stored in the header and has to match when the file is read back, e.g. a hash of the source the Program
+// was parsed from.
+[[nodiscard]] std::string serialiseProgram(const Program& program, const Interner& interner, uint64_t key);
+
+// Rebuilds a Program from serialiseProgram()'s output. Nodes are allocated in the Program's arena in one pass over
+// the nodes, and every name and literal still points into `bytes`, which has to outlive both the Program and
+// `interner`. Returns null if `bytes` is of another format version or for another key, and throws if it's corrupt.
+[[nodiscard]] std::unique_ptr<Program> deserialiseProgram(std::string_view bytes, Interner& interner, uint64_t key);
+
+} // namespace alx
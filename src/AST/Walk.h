@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-30.
+//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace alx {
+
+// Walks a tree depth first on a stack of its own rather than by recursing, so that how deeply the tree can nest is
+// only limited by memory, not by the size of the thread's stack. Machine generated code easily nests expressions and
+// else if chains tens of thousands deep.
+//
+// `expand(item, push)` calls `push` with each of `item`'s children that should be walked, in order. `leave(item)` is
+// called once all of them have been left, so children are always left before their parents, and siblings in the order
+// they were pushed. An item is whatever a pass needs to carry down the tree, e.g. a node and the context it's in.
+template<typename Item, typename Expand, typename Leave>
+void walkPostOrder(Item root, Expand&& expand, Leave&& leave)
+{
+	struct Frame {
+		Item Value;
+		bool Expanded;
+	};
+	std::vector<Frame> stack;
+	stack.push_back({ std::move(root), false });
+	std::vector<Item> children;
+	while (!stack.empty()) {
+		if (stack.back().Expanded) {
+			auto item = std::move(stack.back().Value);
+			stack.pop_back();
+			leave(item);
+			continue;
+		}
+		stack.back().Expanded = true;
+		children.clear();
+		expand(stack.back().Value, [&children](Item child) { children.push_back(std::move(child)); });
+		// Pushed last to first, so the first child is on top and is walked first
+		for (auto child = children.rbegin(); child != children.rend(); ++child)
+			stack.push_back({ std::move(*child), false });
+	}
+}
+
+} // namespace alx
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-28.
+//
+
+#include "AstCache.h"
+
+#include <unistd.h>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include "AST/Serialise.h"
+#include "libs/Println.h"
+
+namespace alx {
+
+namespace {
+
+// Hashes the source 8 bytes at a time so that a cache hit costs a fraction of tokenising. This only has to tell
+// apart versions of a file, not resist anyone trying to collide it.
+uint64_t hashSource(std::string_view source)
+{
+	const auto mix = [](uint64_t value) {
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdULL;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ULL;
+		value ^= value >> 33;
+		return value;
+	};
+	uint64_t hash = source.size();
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= source.size(); i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, source.data() + i, sizeof(word));
+		hash = mix(hash ^ word) + i;
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, source.data() + i, source.size() - i);
+	return mix(hash ^ tail);
+}
+
+} // namespace
+
+std::unique_ptr<Program> AstCache::Load(std::string_view source, Interner& interner)
+{
+	const auto key = hashSource(source);
+	m_file = SourceBuffer::Open(path_for(key));
+	if (!m_file)
+		return nullptr;
+	try {
+		if (auto program = deserialiseProgram(m_file->View(), interner, key))
+			return program;
+	}
+	catch (std::runtime_error&) {
+		// A damaged file is a miss too, and gets overwritten once the source has been parsed again. It stays mapped
+		// all the same: it may have got as far as interning some of its names.
+	}
+	return nullptr;
+}
+
+void AstCache::Store(std::string_view source, const Program& program, const Interner& interner) const
+{
+	const auto key = hashSource(source);
+	std::string bytes;
+	try {
+		bytes = serialiseProgram(program, interner, key);
+	}
+	catch (std::runtime_error&) {
+		return; // Not every node can be serialised yet
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_directory, error);
+	// Written next to its final name and moved into place, so a compile running alongside never reads half a file
+	const auto path = path_for(key);
+	auto temporary = path;
+	temporary += getFormatted(".{}.tmp", ::getpid());
+	{
+		std::ofstream out(temporary, std::ios::binary);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		if (!out.good()) {
+			out.close();
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+	}
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+		std::filesystem::remove(temporary, error);
+}
+
+std::filesystem::path AstCache::path_for(uint64_t key) const
+{
+	std::array<char, 16> hex{};
+	const auto end = std::to_chars(hex.data(), hex.data() + hex.size(), key, 16).ptr;
+	return m_directory / (std::string(hex.data(), end) + ".ast");
+}
+
+} // namespace alx
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-28.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include "AST/Ast.h"
+#include "Utils/Interner.h"
+#include "Utils/SourceBuffer.h"
+
+namespace alx {
+
+// A directory of serialised ASTs, one file per source, named after a hash of the source's contents. Compiling a file
+// that hasn't changed since it was last cached then skips tokenising and parsing altogether.
+class AstCache
+{
+	std::filesystem::path m_directory;
+	// The loaded AST's names and literals point into this mapping, as do the interner's, so it's kept for as long as
+	// the cache
+	std::optional<SourceBuffer> m_file;
+
+public:
+	explicit AstCache(std::filesystem::path directory) : m_directory(std::move(directory)) {}
+
+	// The cached AST of `source`, if there is one, with its symbols interned in `interner`. It stays valid for as long
+	// as this cache does.
+	[[nodiscard]] std::unique_ptr<Program> Load(std::string_view source, Interner& interner);
+	// Caches the AST of `source`. A cache that can't be written isn't an error, so this fails silently and the next
+	// compile parses the file again.
+	void Store(std::string_view source, const Program& program, const Interner& interner) const;
+
+private:
+	[[nodiscard]] std::filesystem::path path_for(uint64_t key) const;
+};
+
+} // namespace alx
@@ -6,37 +6,67 @@
 // Created by aelliixx on 2023-09-09.
 //
 
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "misc-no-recursion"
-#endif
-
 #include "BlockGenerator.h"
+#include "../../AST/Walk.h"
 
 namespace alx {
 
 void BlockGenerator::generate_binary_expression(const ASTNode* node, std::optional<Context> context)
 {
-	auto expr = static_cast<const BinaryExpression*>(node);
+	// The operands an operator expects in rax are generated before it, on a stack of our own rather than recursively,
+	// so how deeply the expression nests doesn't matter
+	using Operator = std::pair<const BinaryExpression*, std::optional<Context>>;
+	walkPostOrder(
+		Operator{ static_cast<const BinaryExpression*>(node), context },
+		[this](const Operator& item, auto push) {
+			const auto& [expr, context] = item;
+			auto lhs = expr->Lhs();
+			auto rhs = expr->Rhs();
+			if (expr->Operator() == TokenType::T_EQ) {
+				if (lhs->Kind() == NodeKind::Identifier && rhs->Kind() == NodeKind::BinaryExpression
+					&& !static_cast<BinaryExpression*>(rhs)->Constexpr())
+				{
+					auto lhsSize = m_stack[stack_key(static_cast<Identifier*>(lhs)->Symbol())].second;
+					push(Operator{ static_cast<BinaryExpression*>(rhs), Context{ .LhsSize = lhsSize } });
+				}
+				else if (lhs->Kind() == NodeKind::BinaryExpression && rhs->Kind() == NodeKind::BinaryExpression)
+					push(Operator{ static_cast<BinaryExpression*>(lhs), Context{ .LhsSize = 4 } }); // FIXME
+				return;
+			}
+			if (lhs->Kind() == NodeKind::Identifier || lhs->Kind() == NodeKind::NumberLiteral) {
+				if (rhs->Kind() == NodeKind::BinaryExpression)
+					push(Operator{ static_cast<BinaryExpression*>(rhs), std::nullopt });
+			}
+			else if (lhs->Kind() == NodeKind::BinaryExpression) {
+				push(Operator{ static_cast<BinaryExpression*>(lhs), context });
+				if (rhs->Kind() == NodeKind::BinaryExpression)
+					push(Operator{ static_cast<BinaryExpression*>(rhs), context });
+			}
+		},
+		[this](const Operator& item) { generate_binary_operator(item.first, item.second); });
+}
+
+void BlockGenerator::generate_binary_operator(const BinaryExpression* expr, std::optional<Context> context)
+{
 	auto lhs = expr->Lhs();
 	auto rhs = expr->Rhs();
 	auto op = expr->Operator();
 	if (op == TokenType::T_EQ) {
-		generate_bin_eq(node, context);
+		generate_bin_eq(expr, context);
 		return;
 	}
 
-	if (lhs->class_name() == "Identifier") {
+	if (lhs->Kind() == NodeKind::Identifier) {
 		auto lhsId = static_cast<Identifier*>(lhs);
 
-		auto lhsSize = m_stack[lhsId->Name()].second;
-		auto lhsPtr = m_stack[lhsId->Name()].first;
+		auto lhsSize = m_stack[stack_key(lhsId->Symbol())].second;
+		auto lhsPtr = m_stack[stack_key(lhsId->Symbol())].first;
 
-		if (rhs->class_name() == "Identifier") // a + b
+		if (rhs->Kind() == NodeKind::Identifier) // a + b
 		{
 			auto rhsId = static_cast<Identifier*>(rhs);
 			assert_ident_initialised(rhsId);
-			auto rhsPtr = m_stack[rhsId->Name()].first;
+			auto rhsPtr = m_stack[stack_key(rhsId->Symbol())].first;
 			m_asm << mov(Reg::rax, lhsSize, offset(lhsPtr, lhsSize));
 
 			auto src = reg(Reg::rdx, lhsSize);
@@ -60,7 +90,7 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 				ASSERT_NOT_IMPLEMENTED();
 			}
 		}
-		else if (rhs->class_name() == "NumberLiteral") // a + 5
+		else if (rhs->Kind() == NodeKind::NumberLiteral) // a + 5
 		{
 			auto rhs_num = static_cast<NumberLiteral*>(rhs);
 			switch (op) {
@@ -100,9 +130,7 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 			m_asm << reg(Reg::rax, lhsSize) << ", " << rhs_num->Value() << "\n";
 			return;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
-			auto rhsBin = static_cast<BinaryExpression*>(rhs);
-			generate_binary_expression(rhsBin);
+		else if (rhs->Kind() == NodeKind::BinaryExpression) {
 			switch (op) {
 			case TokenType::T_SUB_EQ:
 				m_asm << "sub " << offset(lhsPtr, lhsSize) << ", " << reg(Reg::rax, lhsSize) << "\n";
@@ -116,15 +144,15 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 			return;
 		}
 	}
-	if (lhs->class_name() == "NumberLiteral") {
+	if (lhs->Kind() == NodeKind::NumberLiteral) {
 		auto lhsNum = static_cast<NumberLiteral*>(lhs);
 		auto lhsSize = size_of(lhsNum->Type());
 
-		if (rhs->class_name() == "Identifier") // 5 + a
+		if (rhs->Kind() == NodeKind::Identifier) // 5 + a
 		{
 			auto rhsId = static_cast<Identifier*>(rhs);
-			auto rhsSize = m_stack[rhsId->Name()].second;
-			auto rhsPtr = m_stack[rhsId->Name()].first;
+			auto rhsSize = m_stack[stack_key(rhsId->Symbol())].second;
+			auto rhsPtr = m_stack[stack_key(rhsId->Symbol())].first;
 			m_asm << mov(Reg::rax, rhsSize, lhsNum->Value());
 
 			switch (op) {
@@ -141,15 +169,14 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 				ASSERT_NOT_IMPLEMENTED();
 			}
 		}
-		if (rhs->class_name() == "NumberLiteral") // 5 + 2
+		if (rhs->Kind() == NodeKind::NumberLiteral) // 5 + 2
 		{
 			MUST(expr->Constexpr() && "Expression with number literals on both sides should be constexpr");
-			m_asm << mov(Reg::rax, lhsSize, expr->Evaluate()->Value());
+			m_asm << mov(Reg::rax, lhsSize, expr->Evaluate().AsInt());
 			return;
 		}
-		if (rhs->class_name() == "BinaryExpression") // 5 + 2 * 10
+		if (rhs->Kind() == NodeKind::BinaryExpression) // 5 + 2 * 10
 		{
-			generate_binary_expression(rhs);
 			switch (op) {
 			case TokenType::T_PLUS:
 				m_asm << "add " << reg(Reg::rax, lhsSize) << ", " << lhsNum->Value() << "\n";
@@ -165,14 +192,13 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 			}
 		}
 	}
-	if (lhs->class_name() == "BinaryExpression") {
-		generate_binary_expression(lhs, context);
+	if (lhs->Kind() == NodeKind::BinaryExpression) {
 		MUST(context.has_value() && "lhs context is missing");
 		auto lhsSize = context.value().LhsSize;
-		if (rhs->class_name() == "Identifier") {
+		if (rhs->Kind() == NodeKind::Identifier) {
 			auto rhsId = static_cast<Identifier*>(rhs);
 			assert_ident_initialised(rhsId);
-			auto rhsPtr = m_stack[rhsId->Name()].first;
+			auto rhsPtr = m_stack[stack_key(rhsId->Symbol())].first;
 			switch (op) {
 			case TokenType::T_PLUS:
 				m_asm << "add " << reg(Reg::rax, lhsSize) << ", " << offset(rhsPtr, lhsSize) << "\n";
@@ -187,7 +213,7 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 				ASSERT_NOT_IMPLEMENTED();
 			}
 		}
-		if (rhs->class_name() == "NumberLiteral") {
+		if (rhs->Kind() == NodeKind::NumberLiteral) {
 			auto rhsNum = static_cast<NumberLiteral*>(rhs);
 			switch (op) {
 			case TokenType::T_PLUS:
@@ -206,10 +232,8 @@ void BlockGenerator::generate_binary_expression(const ASTNode* node, std::option
 				ASSERT_NOT_IMPLEMENTED();
 			}
 		}
-		if (rhs->class_name() == "BinaryExpression") {
-			generate_binary_expression(rhs, context);
+		if (rhs->Kind() == NodeKind::BinaryExpression)
 			return;
-		}
 	}
 	ASSERT_NOT_REACHABLE();
 }
@@ -222,8 +246,8 @@ void BlockGenerator::generate_assignment_ident(const Identifier& rhsId, size_t l
 {
 	// - Get underlying types, type sizes, whether the value we're trying to assign is unsigned (and therefore
 	//	 we should extend the value)
-	auto rhsSize = m_stack.at(rhsId.Name()).second;
-	auto rhsPtrOffset = m_stack.at(rhsId.Name()).first;
+	auto rhsSize = m_stack.at(stack_key(rhsId.Symbol())).second;
+	auto rhsPtrOffset = m_stack.at(stack_key(rhsId.Symbol())).first;
 
 	if (rhsSize <= 2)
 		m_asm << mov(Reg::rax, rhsSize, offset(rhsPtrOffset, rhsSize), lhsSize, isUnsigned); // FIXME: Add back signs
@@ -232,20 +256,19 @@ void BlockGenerator::generate_assignment_ident(const Identifier& rhsId, size_t l
 	m_asm << mov(offset(m_bp_offset, lhsSize), rhsSize, Reg::rax, lhsSize);
 }
 
-void BlockGenerator::generate_bin_eq(const ASTNode* node, std::optional<Context> context)
+void BlockGenerator::generate_bin_eq(const BinaryExpression* expr, std::optional<Context> context)
 {
-	auto expr = static_cast<const BinaryExpression*>(node);
 	auto lhs = expr->Lhs();
 	auto rhs = expr->Rhs();
 	auto op = TokenType::T_EQ;
-	if (lhs->class_name() == "Identifier") {
+	if (lhs->Kind() == NodeKind::Identifier) {
 		auto lhsId = static_cast<Identifier&>(*lhs);
-		auto lhsPtr = m_stack[lhsId.Name()].first;
-		auto lhsSize = m_stack[lhsId.Name()].second;
+		auto lhsPtr = m_stack[stack_key(lhsId.Symbol())].first;
+		auto lhsSize = m_stack[stack_key(lhsId.Symbol())].second;
 
 		//		add_to_stack(lhsId.Name(), lhsSize, TokenType::T_VOID);
 
-		if (rhs->class_name() == "NumberLiteral") {
+		if (rhs->Kind() == NodeKind::NumberLiteral) {
 			auto rhsNum = static_cast<NumberLiteral*>(rhs);
 			m_asm << "mov " << bytes_to_data_size(lhsSize) << " [rbp-" << lhsPtr << "], " << rhsNum->Value() << "\n";
 			if (context.has_value() && context.value().AssignmentChain)
@@ -253,52 +276,45 @@ void BlockGenerator::generate_bin_eq(const ASTNode* node, std::optional<Context>
 			//			generate_assign_num_l(lhs_size, rhs_num);
 			return;
 		}
-		if (rhs->class_name() == "Identifier") {
+		if (rhs->Kind() == NodeKind::Identifier) {
 			auto rhsId = static_cast<Identifier&>(*rhs);
-			generate_assignment_ident(rhsId, m_stack[lhsId.Name()].second, false);
+			generate_assignment_ident(rhsId, m_stack[stack_key(lhsId.Symbol())].second, false);
 			return;
 		}
-		if (rhs->class_name() == "BinaryExpression") {
+		if (rhs->Kind() == NodeKind::BinaryExpression) {
 			auto rhsBin = static_cast<BinaryExpression*>(rhs);
 			if (rhsBin->Constexpr()) {
-				m_asm << mov(offset(m_bp_offset, lhsSize), lhsSize, rhsBin->Evaluate()->Value());
+				const auto value = rhsBin->Evaluate().Cast(m_stack_types[stack_key(lhsId.Symbol())]);
+				m_asm << mov(offset(m_bp_offset, lhsSize), lhsSize, value.AsInt());
 				return;
 			}
-			Context newContext = { .LhsSize = lhsSize };
-			generate_binary_expression(rhs, newContext);
 			m_asm << mov(offset(m_bp_offset, lhsSize), lhsSize, reg(Reg::rax, lhsSize));
 			return;
 		}
 	}
-	if (lhs->class_name() == "BinaryExpression") {
+	if (lhs->Kind() == NodeKind::BinaryExpression) {
 		// TODO: Refactor this out
 		auto lhsBinExp = static_cast<BinaryExpression*>(lhs);
-		if (lhsBinExp->Rhs()->class_name() == "NumberLiteral")
+		if (lhsBinExp->Rhs()->Kind() == NodeKind::NumberLiteral)
 			throw_not_assignable(lhsBinExp->Rhs(), rhs, op);
 		size_t lhsSize = 4; // FIXME
 
-		if (rhs->class_name() == "NumberLiteral") {
+		if (rhs->Kind() == NodeKind::NumberLiteral) {
 			auto rhsNum = static_cast<NumberLiteral*>(rhs);
 			generate_assign_num_l(lhsSize, rhsNum);
 			return;
 		}
-		else if (rhs->class_name() == "Identifier") {
+		else if (rhs->Kind() == NodeKind::Identifier) {
 			auto rhsId = static_cast<Identifier&>(*rhs);
 			generate_assignment_ident(rhsId, 2, false); // FIXME: fix the sign
 			return;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
-			Context newContext = { .LhsSize = lhsSize };
-			generate_binary_expression(lhs, newContext);
+		else if (rhs->Kind() == NodeKind::BinaryExpression)
 			return;
-		}
 		ASSERT_NOT_IMPLEMENTED();
 	}
-	if (lhs->class_name() == "NumberLiteral")
+	if (lhs->Kind() == NodeKind::NumberLiteral)
 		throw_not_assignable(lhs, rhs, op);
 }
 
 }
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
\ No newline at end of file
@@ -17,42 +17,47 @@ void BlockGenerator::GenerateBlock()
 {
 	for (const auto& node : m_block_ast.Children())
 	{
-		auto nodeName = node->class_name();
-		if (nodeName == "VariableDeclaration")
+		switch (node->Kind())
 		{
-			const auto& var = static_cast<VariableDeclaration&>(*node);
-			if (var.TypeIndex() == 0)
+		case NodeKind::VariableDeclaration:
+			if (static_cast<VariableDeclaration&>(*node).TypeIndex() == 0)
 				generate_variables(node);
 			else
 				generate_struct_variable(*node);
-		}
-		else if (nodeName == "ReturnStatement")
+			break;
+		case NodeKind::ReturnStatement:
 			generate_return_statement(node);
-		else if (nodeName == "BinaryExpression")
-			generate_binary_expression(node.get());
-		else if (nodeName == "IfStatement")
-			generate_if_statement(node.get(), {});
-		else if (nodeName == "WhileStatement")
-			generate_while_statement(node.get());
-		else if (nodeName == "StructDeclaration")
+			break;
+		case NodeKind::BinaryExpression:
+			generate_binary_expression(node);
+			break;
+		case NodeKind::IfStatement:
+			generate_if_statement(node, {});
+			break;
+		case NodeKind::WhileStatement:
+			generate_while_statement(node);
+			break;
+		case NodeKind::StructDeclaration:
 			generate_structs(*node);
-		else
-			error("Codegen Error: Unexpected node '{}'", nodeName);
+			break;
+		default:
+			error("Codegen Error: Unexpected node '{}'", node->class_name());
+		}
 	}
 }
 
-void BlockGenerator::generate_return_statement(const std::unique_ptr<ASTNode>& node)
+void BlockGenerator::generate_return_statement(const ASTNode* node)
 {
-	auto ret = static_cast<ReturnStatement*>(node.get());
+	auto ret = static_cast<const ReturnStatement*>(node);
 	auto arg = ret->Argument();
 	// FIXME get the actual class
-	if (arg->class_name() == "Identifier")
+	if (arg->Kind() == NodeKind::Identifier)
 	{
 		const auto identifier = static_cast<Identifier*>(arg);
-		auto rhsPtr = m_stack.at(identifier->Name()).first;
+		auto rhsPtr = m_stack.at(stack_key(identifier->Symbol())).first;
 		m_asm << mov(Reg::rax, 8, offset(rhsPtr, 8));
 	}
-	else if (arg->class_name() == "NumberLiteral")
+	else if (arg->Kind() == NodeKind::NumberLiteral)
 	{
 		const auto literal = static_cast<NumberLiteral*>(arg);
 		switch (literal->Type())
@@ -76,15 +81,15 @@ void BlockGenerator::generate_return_statement(const std::unique_ptr<ASTNode>& n
 			MUST(false && "Not reached");
 		}
 	}
-	else if (arg->class_name() == "BinaryExpression")
+	else if (arg->Kind() == NodeKind::BinaryExpression)
 		generate_binary_expression(arg);
-	else if (arg->class_name() == "UnaryExpression")
+	else if (arg->Kind() == NodeKind::UnaryExpression)
 		generate_unary_expression(arg);
-	else if (arg->class_name() == "MemberExpression")
+	else if (arg->Kind() == NodeKind::MemberExpression)
 	{
 		// TODO: Test this code
 		const auto member = static_cast<MemberExpression*>(arg);
-		auto rhsPtr = m_stack.at(member->Object().Name() + "::" + member->Member().Name()).first;
+		auto rhsPtr = m_stack.at(stack_key(member->Object().Symbol(), member->Member().Symbol())).first;
 		m_asm << mov(Reg::rax, 8, offset(rhsPtr, 8));
 	}
 	else
@@ -100,7 +105,7 @@ void BlockGenerator::generate_return_statement(const std::unique_ptr<ASTNode>& n
 	m_early_returns = true;
 }
 
-void BlockGenerator::add_to_stack(const std::string& name, size_t size, TokenType type)
+void BlockGenerator::add_to_stack(QualifiedSymbol name, size_t size, TokenType type)
 {
 	align_stack(size);
 	m_bp_offset += size;
@@ -149,12 +154,12 @@ std::string BlockGenerator::bytes_to_data_size(size_t bytes)
 
 void BlockGenerator::throw_not_assignable(const Expression* lhs, const Expression* rhs, TokenType op)
 {
-	if (rhs->class_name() == "NumberLiteral")
+	if (rhs->Kind() == NodeKind::NumberLiteral)
 		error("Expression '{} {} {}' is not assignable",
 			  static_cast<const NumberLiteral*>(lhs)->Value(),
 			  token_to_string(op),
 			  static_cast<const NumberLiteral*>(rhs)->Value());
-	else if (rhs->class_name() == "Identifier")
+	else if (rhs->Kind() == NodeKind::Identifier)
 		error("Expression '{} {} {}' is not assignable",
 			  static_cast<const NumberLiteral*>(lhs)->Value(),
 			  token_to_string(op),
@@ -163,7 +168,7 @@ void BlockGenerator::throw_not_assignable(const Expression* lhs, const Expressio
 
 std::string BlockGenerator::mov(BlockGenerator::Reg dest,
 								size_t srcSize,
-								const std::string& src,
+								std::string_view src,
 								size_t destSize,
 								bool isUnsigned)
 {
@@ -207,7 +212,7 @@ std::string BlockGenerator::mov(const std::string& dest,
 
 std::string BlockGenerator::mov(const std::string& dest,
 								size_t srcSize,
-								const std::string& src,
+								std::string_view src,
 								size_t destSize,
 								bool isUnsigned)
 {
@@ -327,7 +332,7 @@ void BlockGenerator::generate_body(const BlockStatement& block)
 
 void BlockGenerator::assert_ident_initialised(const Identifier* lhsId)
 {
-	auto it = m_stack.find(lhsId->Name());
+	auto it = m_stack.find(stack_key(lhsId->Symbol()));
 	if (it == m_stack.end())
 		error("Codegen Error: Use of undeclared identifier '{}'. This is a codegen "
 			  "Error and must be fixed in the parser.", lhsId->Name());
@@ -338,7 +343,7 @@ void BlockGenerator::assert_ident_initialised(const Identifier* lhsId)
 
 void BlockGenerator::assert_ident_declared(const Identifier* lhsId)
 {
-	auto it = m_stack.find(lhsId->Name());
+	auto it = m_stack.find(stack_key(lhsId->Symbol()));
 	if (it == m_stack.end())
 		error("Codegen Error: Use of undeclared identifier '{}'. This is a codegen "
 			  "Error and must be fixed in the parser.", lhsId->Name());
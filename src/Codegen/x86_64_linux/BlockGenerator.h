@@ -44,20 +44,20 @@ class BlockGenerator
 	bool m_early_returns = false;
 	bool m_explicit_return = false;
 	bool m_in_global_scope = false;
-	const std::vector<std::unique_ptr<ASTNode>>& m_program_ast;
-	std::unordered_map<std::string, std::pair<size_t, size_t>> m_stack;
-	std::unordered_map<std::string, TokenType> m_stack_types;
+	std::span<ASTNode* const> m_program_ast;
+	std::unordered_map<QualifiedSymbol, std::pair<size_t, size_t>> m_stack;
+	std::unordered_map<QualifiedSymbol, TokenType> m_stack_types;
 	TokenType m_return_type;
 
 	Flags m_flags{};
 public:
 	BlockGenerator(BlockGenerator&& other) = delete;
 	BlockGenerator(const ScopeNode& block,
-				   const std::unordered_map<std::string, std::pair<size_t, size_t>>& stack,
+				   const std::unordered_map<QualifiedSymbol, std::pair<size_t, size_t>>& stack,
 				   size_t bpOffset,
 				   size_t labelIndex,
 				   std::list<std::pair<ASTNode*, std::string>>& labels,
-				   const std::vector<std::unique_ptr<ASTNode>>& parent,
+				   std::span<ASTNode* const> parent,
 				   Flags flags)
 		: m_block_ast(block),
 		  m_local_labels(labels),
@@ -68,7 +68,7 @@ public:
 		  m_flags(flags) {}
 
 	BlockGenerator(const ScopeNode& block,
-				   const std::vector<std::unique_ptr<ASTNode>>& node,
+				   std::span<ASTNode* const> node,
 				   Flags flags,
 				   TokenType returnType)
 		: m_block_ast(block), m_program_ast(node), m_return_type(returnType), m_flags(flags)
@@ -90,14 +90,17 @@ protected:
 private:
 	static std::string reg(Reg reg, size_t bytes = 4);
 
-	void add_to_stack(const std::string&, size_t, TokenType);
+	// Stack slots are keyed by identifier symbol, and struct members by the member qualified with its object
+	static QualifiedSymbol stack_key(SymbolId name) { return qualify(NoSymbol, name); }
+	static QualifiedSymbol stack_key(SymbolId object, SymbolId member) { return qualify(object, member); }
+	void add_to_stack(QualifiedSymbol, size_t, TokenType);
 	void push(const std::string&);
 	void pop(const std::string&);
 	std::string generate_local_label(ASTNode*);
 
 	static std::string mov(Reg dest,
 						   size_t srcSize,
-						   const std::string& src,
+						   std::string_view src,
 						   size_t destSize = 0,
 						   bool isUnsigned = false);
 	static std::string mov(const std::string& dest,
@@ -106,7 +109,7 @@ private:
 						   size_t destSize = 0);
 	static std::string mov(const std::string& dest,
 						   size_t srcSize,
-						   const std::string& src,
+						   std::string_view src,
 						   size_t destSize = 0,
 						   bool isUnsigned = false);
 	static std::string mov(Reg dest,
@@ -128,8 +131,8 @@ private:
 							  size_t regSize = 8,
 							  bool positive = false);
 
-	void generate_variables(const std::unique_ptr<ASTNode>&);
-	void generate_return_statement(const std::unique_ptr<ASTNode>&);
+	void generate_variables(const ASTNode*);
+	void generate_return_statement(const ASTNode*);
 	void generate_binary_expression(const ASTNode*, std::optional<Context> = {});
 	void generate_unary_expression(const ASTNode*);
 	void generate_structs(const ASTNode&);
@@ -151,7 +154,9 @@ private:
 
 	// Binary methods
 
-	void generate_bin_eq(const ASTNode*, std::optional<Context>);
+	// Generate a single operator, once generate_binary_expression has generated the operands it expects in rax
+	void generate_binary_operator(const BinaryExpression*, std::optional<Context>);
+	void generate_bin_eq(const BinaryExpression*, std::optional<Context>);
 
 	void align_stack(size_t offset);
 	void assert_ident_initialised(const Identifier* lhsId);
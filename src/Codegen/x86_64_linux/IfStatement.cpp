@@ -10,58 +10,64 @@
 
 namespace alx {
 
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "misc-no-recursion"
-#endif
 void BlockGenerator::generate_if_statement(ASTNode* node, const std::optional<std::string>& exitLabel)
 {
+	// The links of an else if chain are generated in turn rather than recursively, however long the chain is. All of
+	// them exit to the first link's exit label.
 	auto statement = static_cast<IfStatement*>(node);
-	auto condition = statement->Condition();
-	auto exitLabelActual = exitLabel.has_value() ? exitLabel.value() : generate_local_label(statement);
-
-	if (condition->class_name() == "NumberLiteral")
+	auto chainExitLabel = exitLabel;
+	while (true)
 	{
-		auto condNum = static_cast<NumberLiteral*>(condition);
-		if (condNum->AsInt())
+		auto condition = statement->Condition();
+		auto exitLabelActual = chainExitLabel.has_value() ? chainExitLabel.value() : generate_local_label(statement);
+
+		if (const auto constant = constantValueOf(*condition))
 		{
-			generate_body(statement->Body());
+			// Only the branch that's taken is generated
+			if (constant->AsBool())
+				generate_body(statement->Body());
+			else if (statement->HasAlternate() && statement->GetAlternate()->Kind() == NodeKind::IfStatement)
+			{
+				statement = static_cast<IfStatement*>(statement->GetAlternate());
+				continue;
+			}
+			else if (statement->HasAlternate())
+				generate_body(*static_cast<BlockStatement*>(statement->GetAlternate()));
+			// The branches before this one in an else if chain jump to the end of it
+			if (chainExitLabel.has_value())
+				m_asm << exitLabelActual << ":\n";
 			return;
 		}
-	}
-	else if (condition->class_name() == "BinaryExpression")
-	{
-		auto condBinExp = static_cast<BinaryExpression*>(condition);
-		if (condBinExp->Constexpr() && condBinExp->Evaluate()->AsInt())
+
+		generate_branch(condition, statement, exitLabelActual, true);
+		generate_body(statement->Body());
+
+		if (statement->HasAlternate())
+		{
+			m_asm << "jmp " << exitLabelActual << "\n";
+			m_asm << generate_local_label(statement->GetAlternate()) << ":\n";
+		}
+		else
 		{
-			generate_body(statement->Body());
+			m_asm << exitLabelActual << ":\n";
 			return;
 		}
-	}
-
-	generate_branch(condition, statement, exitLabelActual, true);
-	generate_body(statement->Body());
 
-	if (statement->HasAlternate())
-	{
-		m_asm << "jmp " << exitLabelActual << "\n";
-		m_asm << generate_local_label(statement->GetAlternate()) << ":\n";
-	}
-	else
-	{
-		m_asm << exitLabelActual << ":\n";
+		auto alternate = statement->GetAlternate();
+		if (alternate->Kind() == NodeKind::IfStatement)
+		{
+			statement = static_cast<IfStatement*>(alternate);
+			chainExitLabel = exitLabelActual;
+			continue;
+		}
+		if (alternate->Kind() == NodeKind::BlockStatement)
+		{
+			auto alternateBlock = static_cast<BlockStatement*>(alternate);
+			generate_body(*alternateBlock);
+			m_asm << exitLabelActual << ":\n";
+		}
 		return;
 	}
-
-	auto alternate = statement->GetAlternate();
-	if (alternate->class_name() == "IfStatement")
-		generate_if_statement(alternate, exitLabelActual);
-	else if (alternate->class_name() == "BlockStatement")
-	{
-		auto alternateBlock = static_cast<BlockStatement*>(alternate);
-		generate_body(*alternateBlock);
-		m_asm << exitLabelActual << ":\n";
-	}
 }
 
 void BlockGenerator::generate_branch(Expression* condition,
@@ -95,12 +101,12 @@ void BlockGenerator::generate_branch(Expression* condition,
 	  }
 	};
 
-	if (condition->class_name() == "NumberLiteral")
+	if (condition->Kind() == NodeKind::NumberLiteral)
 	{
 //		auto condNum = static_cast<NumberLiteral*>(condition);
 		ASSERT_NOT_IMPLEMENTED();
 	}
-	else if (condition->class_name() == "BinaryExpression")
+	else if (condition->Kind() == NodeKind::BinaryExpression)
 	{
 		auto condBinExp = static_cast<BinaryExpression*>(condition);
 
@@ -144,11 +150,11 @@ void BlockGenerator::generate_branch(Expression* condition,
 		ASSERT_NOT_REACHABLE();
 		}
 	}
-	else if (condition->class_name() == "Identifier")
+	else if (condition->Kind() == NodeKind::Identifier)
 	{
 		// TODO: Check if it's nullptr
 		auto ident = static_cast<Identifier*>(condition);
-		m_asm << "cmp BYTE " << offset(m_stack[ident->Name()].second, 8)
+		m_asm << "cmp BYTE " << offset(m_stack[stack_key(ident->Symbol())].second, 8)
 			  << ", 0\n"; // FIXME: Get the size of the identifier
 
 	}
@@ -166,8 +172,4 @@ void BlockGenerator::generate_branch(Expression* condition,
 		m_asm << jump(jumpType) << exitLabelActual << '\n';
 }
 
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
-
 }
\ No newline at end of file
@@ -19,9 +19,9 @@ std::string ProgramGenerator::Generate()
 	init();
 	for (const auto& node : m_ast)
 	{
-		if (node->class_name() == "FunctionDeclaration")
+		if (node->Kind() == NodeKind::FunctionDeclaration)
 		{
-			auto func = static_cast<FunctionDeclaration*>(node.get());
+			auto func = static_cast<FunctionDeclaration*>(node);
 			m_asm << "\n";
 			if (func->Name() == "main")
 				m_asm << func->Name() << ":\n";
@@ -77,15 +77,15 @@ void ProgramGenerator::init()
 	m_asm << "\n";
 
 	// Find main()
-	auto main_it = std::find_if(m_ast.begin(), m_ast.end(), [&](const std::unique_ptr<ASTNode>& node)
+	auto main_it = std::find_if(m_ast.begin(), m_ast.end(), [&](const ASTNode* node)
 	{
-	  return node->class_name() == "FunctionDeclaration"
-		  && static_cast<FunctionDeclaration*>(node.get())->Name() == "main";
+	  return node->Kind() == NodeKind::FunctionDeclaration
+		  && static_cast<const FunctionDeclaration*>(node)->Name() == "main";
 	});
 	if (main_it == m_ast.end())
 		error("No entry point 'main'");
 
-	auto main = static_cast<FunctionDeclaration*>(main_it->get());
+	auto main = static_cast<FunctionDeclaration*>(*main_it);
 
 	// Create _start
 	m_asm << "_start:\n";
@@ -100,11 +100,8 @@ void ProgramGenerator::init()
 	// Find return statement in main()
 	auto return_it = std::find_if(main->Body().Children().begin(),
 								  main->Body().Children().end(),
-								  [&](const std::unique_ptr<ASTNode>& node)
-								  {
-									auto name = node->class_name();
-									return node->class_name() == "ReturnStatement";
-								  });
+								  [&](const ASTNode* node)
+								  { return node->Kind() == NodeKind::ReturnStatement; });
 
 	if (return_it == main->Body().Children().end())
 		m_implicit_return = true;
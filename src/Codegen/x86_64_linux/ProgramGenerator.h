@@ -23,7 +23,7 @@ enum class bitness
 
 class ProgramGenerator
 {
-	const std::vector<std::unique_ptr<ASTNode>>& m_ast{};
+	std::span<ASTNode* const> m_ast{};
 	std::stringstream m_asm;
 	std::string m_asm_str;
 	bitness m_bitness = bitness::x86_64;
@@ -33,7 +33,7 @@ class ProgramGenerator
 	static size_t align_stack(size_t stackSize);
 
 public:
-	ProgramGenerator(const std::vector<std::unique_ptr<ASTNode>>& ast, Flags flags)
+	ProgramGenerator(std::span<ASTNode* const> ast, Flags flags)
 		: m_ast(ast),
 		  m_flags(flags) {}
 	[[nodiscard]] std::string Asm() const { return m_asm_str; }
@@ -18,17 +18,17 @@ void BlockGenerator::generate_struct_variable(const ASTNode& node)
 {
 	const auto& variable = static_cast<const VariableDeclaration&>(node);
 	auto structIt =
-		std::find_if(m_program_ast.begin(), m_program_ast.end(), [&variable](const std::unique_ptr<ASTNode>& ast_node)
+		std::find_if(m_program_ast.begin(), m_program_ast.end(), [&variable](const ASTNode* ast_node)
 		{
-		  if (ast_node->class_name() == "StructDeclaration")
+		  if (ast_node->Kind() == NodeKind::StructDeclaration)
 		  {
-			  return variable.TypeName() == static_cast<StructDeclaration*>(ast_node.get())->Name();
+			  return variable.TypeName() == static_cast<const StructDeclaration*>(ast_node)->Name();
 		  }
 		  return false;
 		});
 	MUST(structIt != m_program_ast.end() && "Could not find struct declaration");
 
-	auto structDecl = static_cast<StructDeclaration*>(structIt->get());
+	auto structDecl = static_cast<StructDeclaration*>(*structIt);
 
 	// Initialise all default initialised members
 	for (const auto& memberPtr : structDecl->Members())
@@ -36,8 +36,8 @@ void BlockGenerator::generate_struct_variable(const ASTNode& node)
 		const auto& member = static_cast<const VariableDeclaration&>(*memberPtr);
 		if (member.Value() != nullptr)
 		{
-			add_to_stack(variable.Name() + "::" + member.Name(), size_of(member.TypeAsPrimitive()), TokenType::T_STRUCT);
-			if (member.Value()->class_name() == "NumberLiteral")
+			add_to_stack(stack_key(variable.Symbol(), member.Symbol()), size_of(member.TypeAsPrimitive()), TokenType::T_STRUCT);
+			if (member.Value()->Kind() == NodeKind::NumberLiteral)
 			{
 				MUST(member.TypeIndex() == 0 && "Non-primitive types are not yet supported");
 				m_asm << mov(offset(m_bp_offset, size_of(member.TypeAsPrimitive())), 4,
@@ -15,32 +15,31 @@ void BlockGenerator::generate_unary_expression(const ASTNode* node)
 	auto expression = static_cast<const UnaryExpression*>(node);
 	auto rhs = expression->Rhs();
 
-	if (rhs->class_name() == "NumberLiteral")
+	if (rhs->Kind() == NodeKind::NumberLiteral)
 	{
 		auto num = static_cast<NumberLiteral*>(rhs);
 		std::string value = std::to_string(!num->AsInt());
 		m_asm << mov(Reg::rax, size_of(num->Type()), value);
 		return;
 	}
-	else if (rhs->class_name() == "Identifier")
+	else if (rhs->Kind() == NodeKind::Identifier)
 	{
 		auto ident = static_cast<Identifier*>(rhs);
-		auto rhs_ptr = m_stack[ident->Name()].first;
-		auto rhs_size = m_stack[ident->Name()].second;
+		auto rhs_ptr = m_stack[stack_key(ident->Symbol())].first;
+		auto rhs_size = m_stack[stack_key(ident->Symbol())].second;
 
 		m_asm << "cmp " << bytes_to_data_size(rhs_size) << " " << offset(rhs_ptr, rhs_size) << ", 0\n";
 		m_asm << "sete " << reg(Reg::rax, 1) << "\n";
 		m_asm << mov(Reg::rax, 1, reg(Reg::rax, 1), rhs_size, true);
 		return;
 	}
-	else if (rhs->class_name() == "BinaryExpression")
+	else if (rhs->Kind() == NodeKind::BinaryExpression)
 	{
 		auto bin_expr = static_cast<BinaryExpression*>(rhs);
 		if (bin_expr->Constexpr())
 		{
-			auto eval = bin_expr->Evaluate();
-			std::string value = std::to_string(!eval->AsInt());
-			m_asm << mov(Reg::rax, size_of(eval->Type()), value);
+			const auto& eval = bin_expr->Evaluate();
+			m_asm << mov(Reg::rax, size_of(eval.Type()), static_cast<long>(!eval.AsBool()));
 			return;
 		}
 		generate_binary_expression(bin_expr, {});
@@ -50,7 +49,7 @@ void BlockGenerator::generate_unary_expression(const ASTNode* node)
 		m_asm << mov(Reg::rax, 1, reg(Reg::rax, 1), true);
 		return;
 	}
-	else if (rhs->class_name() == "StringLiteral")
+	else if (rhs->Kind() == NodeKind::StringLiteral)
 	{
 		ASSERT_NOT_IMPLEMENTED();
 
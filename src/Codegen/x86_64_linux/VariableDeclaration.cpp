@@ -13,14 +13,14 @@
 
 namespace alx {
 
-void BlockGenerator::generate_variables(const std::unique_ptr<ASTNode>& node)
+void BlockGenerator::generate_variables(const ASTNode* node)
 {
-	auto variable = static_cast<VariableDeclaration*>(node.get());
+	auto variable = static_cast<const VariableDeclaration*>(node);
 	auto type = variable->TypeAsPrimitive();
 	auto size = size_of(type);
 	auto value = variable->Value();
-	add_to_stack(variable->Name(), size, type);
-	auto lhsPtr = m_stack[variable->Name()].first;
+	add_to_stack(stack_key(variable->Symbol()), size, type);
+	auto lhsPtr = m_stack[stack_key(variable->Symbol())].first;
 
 	if (type == TokenType::T_VOID)
 		error("Cannot declare variable of variable 'void'");
@@ -30,45 +30,45 @@ void BlockGenerator::generate_variables(const std::unique_ptr<ASTNode>& node)
 			MUST("Must initialise constant values");
 		return;
 	}
-	if (value->class_name() == "NumberLiteral")
+	if (value->Kind() == NodeKind::NumberLiteral)
 	{
 		auto rhs = static_cast<NumberLiteral*>(value);
 		auto rhsVal = type == TokenType::T_BOOL ? rhs->AsBoolNum() : rhs->AsInt();
 		m_asm << mov(offset(m_bp_offset, size), size, rhsVal, size, isUnsigned(rhs->Type()));
 		return;
 	}
-	else if (value->class_name() == "Identifier")
+	else if (value->Kind() == NodeKind::Identifier)
 	{
 		// - Get the underlying identifier of the rhs
 		auto rhs = static_cast<Identifier&>(*value);
-		auto rhsStack = m_stack[rhs.Name()];
+		auto rhsStack = m_stack[stack_key(rhs.Symbol())];
 			
-		if (m_stack_types[rhs.Name()] != TokenType::T_BOOL && type == TokenType::T_BOOL)
+		if (m_stack_types[stack_key(rhs.Symbol())] != TokenType::T_BOOL && type == TokenType::T_BOOL)
 		{
 			m_asm << "cmp " << offset(rhsStack.first, rhsStack.second) << ", 0\n";
 			m_asm << "setne " << reg(Reg::rax, size) << "\n";
 			m_asm << mov(offset(lhsPtr, size), size, Reg::rax);
 			return;
 		}
-		else if (size_of(m_stack_types[rhs.Name()]) <= 2
+		else if (size_of(m_stack_types[stack_key(rhs.Symbol())]) <= 2
 			&& (type == TokenType::T_CHAR || type == TokenType::T_BOOL || type == TokenType::T_SHORT))
 		{
-			if (type == TokenType::T_SHORT && !(m_stack_types[rhs.Name()] == TokenType::T_BOOL || m_stack_types[rhs.Name()] == TokenType::T_SHORT))
+			if (type == TokenType::T_SHORT && !(m_stack_types[stack_key(rhs.Symbol())] == TokenType::T_BOOL || m_stack_types[stack_key(rhs.Symbol())] == TokenType::T_SHORT))
 				m_asm << mov(reg(Reg::rax, 2), rhsStack.second, offset(rhsStack.first, rhsStack.second), 4, true);
 			else
 				m_asm << mov(Reg::rax, rhsStack.second, offset(rhsStack.first, rhsStack.second), 4, true);
 			m_asm << mov(offset(lhsPtr, size), size, Reg::rax);
 			return;
 		}
-		generate_assignment_ident(rhs, size, isUnsigned(m_stack_types[rhs.Name()]));
+		generate_assignment_ident(rhs, size, isUnsigned(m_stack_types[stack_key(rhs.Symbol())]));
 		return;
 	}
-	else if (value->class_name() == "BinaryExpression")
+	else if (value->Kind() == NodeKind::BinaryExpression)
 	{
 		auto rhs = static_cast<BinaryExpression*>(value);
 		if (rhs->Constexpr())
 		{
-			m_asm << mov(offset(m_bp_offset, size), size, rhs->Evaluate()->AsInt());
+			m_asm << mov(offset(m_bp_offset, size), size, rhs->Evaluate().Cast(type).AsInt());
 			return;
 		}
 		Context context = { .LhsSize = size, .AssignmentChain = true };
@@ -76,16 +76,16 @@ void BlockGenerator::generate_variables(const std::unique_ptr<ASTNode>& node)
 		m_asm << mov(offset(lhsPtr, size), size, reg(Reg::rax, size));
 		return;
 	}
-	else if (value->class_name() == "UnaryExpression")
+	else if (value->Kind() == NodeKind::UnaryExpression)
 	{
 		generate_unary_expression(variable->Value());
 		m_asm << mov(offset(lhsPtr, size), size, reg(Reg::rax, size));
 		return;
 	}
-	else if (value->class_name() == "MemberExpression")
+	else if (value->Kind() == NodeKind::MemberExpression)
 	{
 		const auto& rhs = static_cast<MemberExpression&>(*value);
-		auto rhsVar = m_stack.at(rhs.Object().Name() + "::" + rhs.Member().Name());
+		auto rhsVar = m_stack.at(stack_key(rhs.Object().Symbol(), rhs.Member().Symbol()));
 		m_asm << mov(Reg::rax, rhsVar.second, offset(rhsVar.first, rhsVar.second));
 		m_asm << mov(offset(lhsPtr, size), size, Reg::rax);
 		return;
@@ -10,18 +10,41 @@
 
 #include <chrono>
 #include <fstream>
+#include <iostream>
+#include <optional>
 #include <utility>
 
 namespace alx {
 
-Compiler::Compiler(const std::string& code, const std::string& filename, Flags flags, const DebugFlags debug_flags)
+namespace {
+
+// Points std::cout at another stream buffer until it goes out of scope
+class RedirectStdout
+{
+	std::streambuf* m_previous;
+
+public:
+	explicit RedirectStdout(std::streambuf* to) : m_previous(std::cout.rdbuf(to)) {}
+	RedirectStdout(const RedirectStdout&) = delete;
+	RedirectStdout& operator=(const RedirectStdout&) = delete;
+	~RedirectStdout() { std::cout.rdbuf(m_previous); }
+};
+
+} // namespace
+
+Compiler::Compiler(SourceBuffer source, const std::string& filename, Flags flags, const DebugFlags debug_flags)
   : m_flags(std::move(flags)),
-	m_code(code),
+	m_source(std::move(source)),
+	m_code(m_source.View()),
 	m_filename(filename),
 	m_debug_flags(debug_flags)
 {
-	m_error_handler = std::make_shared<ErrorHandler>(code, filename, m_flags.werror);
-	if (code.empty())
+	m_error_handler = std::make_shared<ErrorHandler>(
+		m_code, filename, m_flags.werror, m_flags.diagnostics_format, m_flags.error_limit);
+	m_interner = std::make_shared<Interner>();
+	if (!m_flags.ast_cache_dir.empty())
+		m_ast_cache = std::make_unique<AstCache>(m_flags.ast_cache_dir);
+	if (m_code.empty())
 		exit(1);
 }
 void Compiler::Compile()
@@ -30,34 +53,48 @@ void Compiler::Compile()
 	using Seconds = std::chrono::duration<double>;
 	const auto start = SysClock::now();
 
-	m_tokeniser = std::make_unique<Tokeniser>(m_code, m_error_handler);
-	auto tokens = m_tokeniser->Tokenise();
+	// In JSON mode stdout carries nothing but the diagnostics, which the error handler already writes to, so
+	// everything else the stages print goes to stderr
+	std::optional<RedirectStdout> statusToStderr;
+	if (m_flags.diagnostics_format == DiagnosticsFormat::Json)
+		statusToStderr.emplace(std::cerr.rdbuf());
 
-	if (m_debug_flags.show_timing) {
-		const Seconds duration = SysClock::now() - start;
-		println(Colour::LightGreen, "Tokenised in {}ms", duration.count() * 1000);
+	if (m_ast_cache) {
+		m_ast = m_ast_cache->Load(m_code, *m_interner);
+		if (m_debug_flags.show_timing) {
+			const Seconds duration = SysClock::now() - start;
+			println(Colour::LightGreen, "AST cache {} in {}ms", m_ast ? "hit" : "miss", duration.count() * 1000);
+		}
 	}
-
-	const auto parseStart = SysClock::now();
-	m_parser = std::make_unique<Parser>(tokens, m_error_handler);
-	const auto& ast = m_parser->Parse();
-
-	if (m_debug_flags.show_timing) {
-		const Seconds duration = SysClock::now() - parseStart;
-		println(Colour::LightGreen, "Built AST in {}ms", duration.count() * 1000);
+	if (!m_ast)
+		m_ast = build_ast();
+	// A program with syntax errors has holes where the broken statements were, so it goes no further
+	if (!m_ast) {
+		if (!m_debug_flags.quiet_mode)
+			m_error_handler->EmitErrorCount();
+		return;
 	}
 
 	const auto irStart = SysClock::now();
-	m_intermediate_representation = std::make_unique<ir::IR>(ast->GetChildren());
+	m_intermediate_representation = std::make_unique<ir::IR>(m_ast->GetChildren(), m_interner);
+	bool generatedIr = false;
 	try {
 		m_intermediate_representation->Generate();
+#if OUTPUT_IR_TO_STRING
+		m_intermediate_representation->Dump();
+#endif
+		generatedIr = true;
 	}
 	catch (std::runtime_error& err) {
 		if (!m_debug_flags.quiet_mode) {
 			println(Colour::LightRed, "Something went wrong when generating IR: {;255;255;255}", err.what());
 			if (m_debug_flags.dump_ast) {
 				println(Colour::LightRed, "Current AST:");
-				ast->PrintNode(0);
+				m_ast->PrintNode(0);
+			}
+			if (m_debug_flags.dump_ir_initial) {
+				println(Colour::LightRed, "Current IR:");
+				m_intermediate_representation->Dump();
 			}
 		}
 	}
@@ -65,27 +102,31 @@ void Compiler::Compile()
 		const Seconds duration = SysClock::now() - irStart;
 		println(Colour::LightGreen, "Generated IR in {}ms", duration.count() * 1000);
 	}
+	if (generatedIr) {
+		try {
+			optimise_ir();
+		}
+		catch (std::runtime_error& err) {
+			if (!m_debug_flags.quiet_mode)
+				println(Colour::LightRed, "Something went wrong when optimising IR: {;255;255;255}", err.what());
+		}
+	}
 
 	if (m_error_handler->ErrorCount() == 0) {
 		const auto generateStart = SysClock::now();
 		try {
-			m_generator = std::make_unique<ProgramGenerator>(ast->GetChildren(), m_flags);
+			m_generator = std::make_unique<ProgramGenerator>(m_ast->GetChildren(), m_flags);
 			m_generator->Generate();
 		}
 		catch (std::runtime_error& err) {
 #if OUTPUT_IR_TO_STRING
-			m_intermediate_representation->Dump();
 			return;
 #endif
 			if (!m_debug_flags.quiet_mode) {
 				println(Colour::LightRed, "Something went wrong when generating assembly: {;255;255;255}", err.what());
 				if (m_debug_flags.dump_ast) {
 					println(Colour::LightRed, "Current AST:");
-					ast->PrintNode(0);
-				}
-				if (m_debug_flags.dump_ir_initial) {
-					println(Colour::LightRed, "\nIR:");
-					m_intermediate_representation->Dump();
+					m_ast->PrintNode(0);
 				}
 				m_error_handler->EmitErrorCount();
 			}
@@ -101,7 +142,7 @@ void Compiler::Compile()
 				Assemble();
 			}
 			catch (const std::runtime_error& err) {
-				println(err.what());
+				println("{}", err.what());
 			}
 		}
 		else {
@@ -115,10 +156,6 @@ void Compiler::Compile()
 
 
 		println(Colour::LightGreen, "Total compilation time {}ms", totalDuration.count() * 1000);
-
-#if OUTPUT_IR_TO_STRING
-		m_intermediate_representation->Dump();
-#endif
 	}
 	if (m_debug_flags.quiet_mode)
 		return;
@@ -127,18 +164,97 @@ void Compiler::Compile()
 
 	if (m_debug_flags.dump_ast) {
 		println();
-		ast->PrintNode(0);
-	}
-	if (m_debug_flags.dump_ir_initial) {
-		println();
-		m_intermediate_representation->Dump();
+		m_ast->PrintNode(0);
 	}
 	if (m_debug_flags.dump_asm || m_debug_flags.dump_unformatted_asm) {
 		println();
 		if (m_debug_flags.dump_asm)
-			println(ProgramGenerator::FormatAsm(m_generator->Asm()));
+			println("{}", ProgramGenerator::FormatAsm(m_generator->Asm()));
 		else
-			println(m_generator->Asm());
+			println("{}", m_generator->Asm());
+	}
+}
+
+std::unique_ptr<Program> Compiler::build_ast()
+{
+	using SysClock = std::chrono::system_clock;
+	using Seconds = std::chrono::duration<double>;
+	const auto start = SysClock::now();
+
+	m_tokeniser = std::make_unique<Tokeniser>(m_code, m_error_handler, m_interner);
+	auto tokens = m_tokeniser->Tokenise();
+	m_error_handler->Flush();
+
+	if (m_debug_flags.show_timing) {
+		const Seconds duration = SysClock::now() - start;
+		println(Colour::LightGreen, "Tokenised in {}ms", duration.count() * 1000);
+	}
+
+	const auto parseStart = SysClock::now();
+	m_parser = std::make_unique<Parser>(std::move(tokens), m_error_handler, m_interner);
+	auto ast = m_parser->Parse(m_flags.parse_threads);
+	m_error_handler->Flush();
+
+	if (m_debug_flags.show_timing) {
+		const Seconds duration = SysClock::now() - parseStart;
+		println(Colour::LightGreen, "Built AST in {}ms", duration.count() * 1000);
+	}
+	// A cache hit reports nothing, so only a file that parsed without a single diagnostic is cached
+	if (ast && m_ast_cache && m_error_handler->DiagnosticCount() == 0) {
+		const auto storeStart = SysClock::now();
+		m_ast_cache->Store(m_code, *ast, *m_interner);
+		if (m_debug_flags.show_timing) {
+			const Seconds duration = SysClock::now() - storeStart;
+			println(Colour::LightGreen, "Cached AST in {}ms", duration.count() * 1000);
+		}
+	}
+	return ast;
+}
+
+void Compiler::optimise_ir()
+{
+	ir::PassManager passes;
+	passes.AddFunctionPass("mem2reg", "allocas promoted", ir::promoteAllocas);
+	passes.AddFunctionPass("phi-elimination", "phis eliminated", [](ir::Function& function, ir::FunctionAnalyses&) {
+		return ir::eliminatePhis(function);
+	});
+
+	if (!m_debug_flags.quiet_mode) {
+		for (const auto& pass : m_debug_flags.dump_ir_before) passes.DumpBefore(pass);
+		for (const auto& pass : m_debug_flags.dump_ir_after) passes.DumpAfter(pass);
+		if (m_debug_flags.dump_ir_all)
+			passes.DumpAfterAll();
+		for (const auto& pass : passes.UnknownDumps())
+			println(Colour::LightRed, "--dump-ir: there is no IR pass called {;255;255;255}", pass);
+		if (m_debug_flags.dump_ir_initial) {
+			println();
+			m_intermediate_representation->Dump("initial");
+		}
+	}
+	// Assembly is still generated from the AST, so all that sees the passes' output is a dump of it
+	const bool dumpsPassedIr = !m_debug_flags.quiet_mode
+		&& (m_debug_flags.dump_ir_all || m_debug_flags.dump_ir_isel || !m_debug_flags.dump_ir_before.empty()
+			|| !m_debug_flags.dump_ir_after.empty());
+	if (!dumpsPassedIr)
+		return;
+	passes.Run(*m_intermediate_representation);
+	if (m_debug_flags.dump_ir_isel && !m_debug_flags.quiet_mode) {
+		println();
+		m_intermediate_representation->Dump("isel");
+	}
+
+	if (m_debug_flags.show_timing) {
+		for (const auto& pass : passes.Statistics())
+			println(Colour::LightGreen,
+					"Ran {} in {}ms: {} {}, {} -> {} instructions, {} -> {} bytes of IR",
+					pass.Name,
+					pass.Milliseconds,
+					pass.Changes,
+					pass.Changed,
+					pass.InstructionsBefore,
+					pass.InstructionsAfter,
+					pass.BytesBefore,
+					pass.BytesAfter);
 	}
 }
 
@@ -163,9 +279,11 @@ void Compiler::Assemble()
 		throw std::runtime_error("ld exited with status code: " + std::to_string(ldStatus));
 }
 
+size_t Compiler::ErrorCount() const { return m_error_handler->ErrorCount(); }
+
 std::string Compiler::GetAsm() { return m_generator->Asm(); }
 
-const Program& Compiler::GetAst() { return m_parser->GetAst(); }
+const Program& Compiler::GetAst() { return *m_ast; }
 
 std::string Compiler::GetFormattedAsm() { return ProgramGenerator::FormatAsm(GetAsm()); }
 
@@ -7,10 +7,15 @@
 //
 #pragma once
 
+#include "AstCache.h"
 #include "Tokeniser/Tokeniser.h"
 #include "Parser/Parser.h"
 #include "Codegen/x86_64_linux/ProgramGenerator.h"
 #include "IR/Ir.h"
+#include "IR/PassManager.h"
+#include "IR/Transforms/Mem2Reg.h"
+#include "IR/Transforms/PhiElimination.h"
+#include "Utils/SourceBuffer.h"
 
 namespace alx {
 
@@ -18,19 +23,28 @@ class Compiler
 {
 	std::unique_ptr<Tokeniser> m_tokeniser;
 	std::unique_ptr<Parser> m_parser;
+	std::unique_ptr<Program> m_ast; // Parsed, or loaded from the cache without a parser
 	std::unique_ptr<ir::IR> m_intermediate_representation;
 	std::unique_ptr<ProgramGenerator> m_generator;
 	std::shared_ptr<ErrorHandler> m_error_handler;
+	std::shared_ptr<Interner> m_interner;
+	std::unique_ptr<AstCache> m_ast_cache; // Only with --ast-cache
 	const Flags m_flags;
-	const std::string m_code;
+	// The single copy of the source; tokens, AST identifiers and diagnostics all hold views into it.
+	const SourceBuffer m_source;
+	const std::string_view m_code;
 	const std::string& m_filename;
 	const DebugFlags m_debug_flags;
 
 public:
-	Compiler(const std::string& code, const std::string& filename, Flags flags, DebugFlags debug_flags);
+	Compiler(SourceBuffer source, const std::string& filename, Flags flags, DebugFlags debug_flags);
+	Compiler(std::string code, const std::string& filename, Flags flags, DebugFlags debug_flags)
+	  : Compiler(SourceBuffer::FromString(std::move(code)), filename, std::move(flags), debug_flags)
+	{}
 
 	void Compile();
 	void Assemble();
+	[[nodiscard]] size_t ErrorCount() const;
 
 	std::string GetAsm();
 	const Program& GetAst();
@@ -38,6 +52,13 @@ public:
 #if OUTPUT_IR_TO_STRING
 	std::string GetIr();
 #endif
+
+private:
+	// Tokenises and parses the source, and caches the result if there's a cache
+	std::unique_ptr<Program> build_ast();
+	// Runs the IR passes: promoting variables out of memory, then taking the phis that leaves back out for instruction
+	// selection. Only done when --dump-ir asks for the IR after them, as code generation doesn't read it yet.
+	void optimise_ir();
 };
 
 } // alx
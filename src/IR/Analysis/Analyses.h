@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-02.
+//
+
+#pragma once
+
+#include "ControlFlow.h"
+#include "Uses.h"
+
+namespace alx::ir {
+
+// The analyses of one function, each worked out the first time it's asked for and kept until the function changes.
+// Passes ask for what they need here rather than working anything out themselves, so that passes that don't change
+// the control flow share the graph and dominator tree. References returned are good until the next call.
+class FunctionAnalyses
+{
+	template<typename Analysis>
+	struct Cached {
+		std::optional<Analysis> Result{};
+		size_t Revision = 0;
+	};
+
+	const Function& m_function;
+	Cached<ControlFlowGraph> m_control_flow;
+	Cached<DominatorTree> m_dominators;
+	Cached<UseLists> m_uses;
+
+public:
+	explicit FunctionAnalyses(const Function& function) : m_function(function) {}
+
+	[[nodiscard]] const ControlFlowGraph& ControlFlow()
+	{
+		return get(m_control_flow, m_function.ControlFlowRevision, [this] { return ControlFlowGraph(m_function); });
+	}
+	[[nodiscard]] const DominatorTree& Dominators()
+	{
+		return get(m_dominators, m_function.ControlFlowRevision, [this] { return DominatorTree(ControlFlow()); });
+	}
+	[[nodiscard]] const UseLists& Uses()
+	{
+		return get(m_uses, m_function.InstructionRevision, [this] { return UseLists(m_function); });
+	}
+
+	// Drops everything, for when the function has been changed without saying so
+	void Invalidate()
+	{
+		m_control_flow.Result.reset();
+		m_dominators.Result.reset();
+		m_uses.Result.reset();
+	}
+
+private:
+	template<typename Analysis, typename Compute>
+	static const Analysis& get(Cached<Analysis>& cached, size_t revision, Compute&& compute)
+	{
+		if (!cached.Result || cached.Revision != revision) {
+			cached.Result.reset();
+			cached.Result.emplace(compute());
+			cached.Revision = revision;
+		}
+		return *cached.Result;
+	}
+};
+
+} // namespace alx::ir
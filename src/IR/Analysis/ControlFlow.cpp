@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-02.
+//
+
+#include "ControlFlow.h"
+
+#include <algorithm>
+
+namespace alx::ir {
+
+ControlFlowGraph::ControlFlowGraph(const Function& function)
+  : m_successors(function.Blocks.size()),
+	m_predecessors(function.Blocks.size()),
+	m_order(function.Blocks.size(), Unreachable)
+{
+	const auto blockOf = [&function](const LabelType& label) {
+		auto it = function.BlockIndices.find(label.Name);
+		MUST(it != function.BlockIndices.end() && "Branch to a block the function doesn't have");
+		return static_cast<BlockId>(it->second);
+	};
+	for (BlockId block = 0; block < function.Blocks.size(); ++block) {
+		for (const auto id : function.Blocks[block].Body) {
+			const auto& instruction = function.Instructions[id];
+			if (std::holds_alternative<ReturnInst>(instruction))
+				break;
+			if (const auto* branch = std::get_if<BranchInst>(&instruction)) {
+				m_successors[block].push_back(blockOf(branch->TrueLabel));
+				if (branch->FalseLabel && blockOf(*branch->FalseLabel) != m_successors[block].front())
+					m_successors[block].push_back(blockOf(*branch->FalseLabel));
+				break;
+			}
+		}
+		for (const auto successor : m_successors[block]) m_predecessors[successor].push_back(block);
+	}
+	if (function.Blocks.empty())
+		return;
+
+	// Depth first from the entry block, on a stack of its own. A block is finished once the last of its successors
+	// has been visited, and the finished blocks reversed are the reverse post-order.
+	struct Frame {
+		BlockId Block;
+		size_t NextSuccessor;
+	};
+	std::vector<Frame> stack{ { 0, 0 } };
+	std::vector<bool> visited(function.Blocks.size());
+	visited[0] = true;
+	while (!stack.empty()) {
+		auto& frame = stack.back();
+		if (frame.NextSuccessor < m_successors[frame.Block].size()) {
+			const auto successor = m_successors[frame.Block][frame.NextSuccessor++];
+			if (!visited[successor]) {
+				visited[successor] = true;
+				stack.push_back({ successor, 0 });
+			}
+			continue;
+		}
+		m_reverse_post_order.push_back(frame.Block);
+		stack.pop_back();
+	}
+	std::reverse(m_reverse_post_order.begin(), m_reverse_post_order.end());
+	for (uint32_t i = 0; i < m_reverse_post_order.size(); ++i) m_order[m_reverse_post_order[i]] = i;
+}
+
+DominatorTree::DominatorTree(const ControlFlowGraph& graph)
+  : m_immediate_dominators(graph.Size()),
+	m_children(graph.Size()),
+	m_frontiers(graph.Size()),
+	m_entered(graph.Size(), ControlFlowGraph::Unreachable),
+	m_left(graph.Size(), ControlFlowGraph::Unreachable)
+{
+	const auto& order = graph.ReversePostOrder();
+	if (order.empty())
+		return;
+
+	// Worked on in terms of positions in the reverse post-order, where a block's dominators all come before it. The
+	// entry block is its own dominator while the others are being found, which is what stops the walks up the tree.
+	std::vector<uint32_t> dominators(order.size(), ControlFlowGraph::Unreachable);
+	dominators[0] = 0;
+	const auto intersect = [&dominators](uint32_t lhs, uint32_t rhs) {
+		while (lhs != rhs) {
+			while (lhs > rhs) lhs = dominators[lhs];
+			while (rhs > lhs) rhs = dominators[rhs];
+		}
+		return lhs;
+	};
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (uint32_t i = 1; i < order.size(); ++i) {
+			auto dominator = ControlFlowGraph::Unreachable;
+			for (const auto predecessor : graph.Predecessors(order[i])) {
+				const auto position = graph.OrderOf(predecessor);
+				if (position == ControlFlowGraph::Unreachable || dominators[position] == ControlFlowGraph::Unreachable)
+					continue;
+				dominator = dominator == ControlFlowGraph::Unreachable ? position : intersect(position, dominator);
+			}
+			if (dominators[i] != dominator) {
+				dominators[i] = dominator;
+				changed = true;
+			}
+		}
+	}
+	for (uint32_t i = 1; i < order.size(); ++i) {
+		m_immediate_dominators[order[i]] = order[dominators[i]];
+		m_children[order[dominators[i]]].push_back(order[i]);
+	}
+
+	// A join point is in the frontier of each block from its predecessors up to, but not including, its immediate
+	// dominator. Blocks are joins in reverse post-order, so a frontier that already has this one has it last.
+	for (const auto block : order) {
+		const auto& predecessors = graph.Predecessors(block);
+		if (predecessors.size() < 2)
+			continue;
+		for (auto runner : predecessors) {
+			if (!graph.IsReachable(runner))
+				continue;
+			while (runner != m_immediate_dominators[block]) {
+				auto& frontier = m_frontiers[runner];
+				if (frontier.empty() || frontier.back() != block)
+					frontier.push_back(block);
+				if (!m_immediate_dominators[runner])
+					break; // The entry block, which is in its own frontier if a loop comes back to it
+				runner = *m_immediate_dominators[runner];
+			}
+		}
+	}
+
+	uint32_t clock = 0;
+	std::vector<std::pair<BlockId, size_t>> stack{ { order[0], 0 } };
+	m_entered[order[0]] = clock++;
+	while (!stack.empty()) {
+		auto& [block, nextChild] = stack.back();
+		if (nextChild < m_children[block].size()) {
+			const auto child = m_children[block][nextChild++];
+			m_entered[child] = clock++;
+			stack.emplace_back(child, 0);
+			continue;
+		}
+		m_left[block] = clock++;
+		stack.pop_back();
+	}
+}
+
+bool DominatorTree::Dominates(BlockId dominator, BlockId block) const
+{
+	if (m_entered[dominator] == ControlFlowGraph::Unreachable || m_entered[block] == ControlFlowGraph::Unreachable)
+		return false;
+	return m_entered[dominator] <= m_entered[block] && m_left[block] <= m_left[dominator];
+}
+
+} // namespace alx::ir
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-02.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include "../Ir.h"
+
+namespace alx::ir {
+
+// Index of a block in its function's blocks
+using BlockId = uint32_t;
+
+// The edges between a function's blocks, read off the branch or return that ends each of them. A block ends at its
+// first branch or return; anything after one can't run and isn't part of the graph.
+class ControlFlowGraph
+{
+	std::vector<std::vector<BlockId>> m_successors;
+	std::vector<std::vector<BlockId>> m_predecessors;
+	std::vector<BlockId> m_reverse_post_order;
+	// Each block's position in m_reverse_post_order, or Unreachable
+	std::vector<uint32_t> m_order;
+
+public:
+	static constexpr uint32_t Unreachable = UINT32_MAX;
+
+	explicit ControlFlowGraph(const Function& function);
+
+	[[nodiscard]] size_t Size() const { return m_successors.size(); }
+	// In the order the branch names them, so a conditional branch's true target comes first
+	[[nodiscard]] const std::vector<BlockId>& Successors(BlockId block) const { return m_successors[block]; }
+	[[nodiscard]] const std::vector<BlockId>& Predecessors(BlockId block) const { return m_predecessors[block]; }
+	// The blocks reachable from the entry block, each before all of its successors other than along back edges
+	[[nodiscard]] const std::vector<BlockId>& ReversePostOrder() const { return m_reverse_post_order; }
+	[[nodiscard]] uint32_t OrderOf(BlockId block) const { return m_order[block]; }
+	[[nodiscard]] bool IsReachable(BlockId block) const { return m_order[block] != Unreachable; }
+};
+
+// Which blocks dominate which, worked out with Cooper, Harvey and Kennedy's iterative algorithm ("A Simple, Fast
+// Dominance Algorithm"), and the dominance frontier of each block. Unreachable blocks are dominated by nothing and
+// dominate nothing.
+class DominatorTree
+{
+	std::vector<std::optional<BlockId>> m_immediate_dominators;
+	std::vector<std::vector<BlockId>> m_children;
+	std::vector<std::vector<BlockId>> m_frontiers;
+	// When each block is entered and left walking the tree depth first, so that a dominates b if and only if b's
+	// interval is inside a's
+	std::vector<uint32_t> m_entered;
+	std::vector<uint32_t> m_left;
+
+public:
+	explicit DominatorTree(const ControlFlowGraph& graph);
+
+	// None for the entry block and for unreachable blocks
+	[[nodiscard]] std::optional<BlockId> ImmediateDominator(BlockId block) const
+	{
+		return m_immediate_dominators[block];
+	}
+	// The blocks `block` immediately dominates, in reverse post-order
+	[[nodiscard]] const std::vector<BlockId>& Children(BlockId block) const { return m_children[block]; }
+	// The blocks where `block`'s dominance ends: those it doesn't strictly dominate but dominates a predecessor of
+	[[nodiscard]] const std::vector<BlockId>& Frontier(BlockId block) const { return m_frontiers[block]; }
+	// Every block dominates itself
+	[[nodiscard]] bool Dominates(BlockId dominator, BlockId block) const;
+};
+
+} // namespace alx::ir
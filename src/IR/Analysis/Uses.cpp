@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-02.
+//
+
+#include "Uses.h"
+
+namespace alx::ir {
+
+UseLists::UseLists(const Function& function)
+  : m_first_user(function.Instructions.size() + 1),
+	m_blocks(function.Instructions.size(), NoBlock)
+{
+	// Counted first, so every instruction's users can go in one array rather than one each
+	for (BlockId block = 0; block < function.Blocks.size(); ++block) {
+		for (const auto id : function.Blocks[block].Body) {
+			m_blocks[id] = block;
+			forEachOperand(function.Instructions[id], [this](Values operand) {
+				if (!operand.IsConstant())
+					++m_first_user[operand.Index() + 1];
+			});
+		}
+	}
+	for (size_t i = 1; i < m_first_user.size(); ++i) m_first_user[i] += m_first_user[i - 1];
+
+	m_users.resize(m_first_user.back());
+	auto next = m_first_user;
+	for (const auto& block : function.Blocks) {
+		for (const auto id : block.Body) {
+			forEachOperand(function.Instructions[id], [this, &next, id](Values operand) {
+				if (!operand.IsConstant())
+					m_users[next[operand.Index()]++] = id;
+			});
+		}
+	}
+}
+
+} // namespace alx::ir
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-02.
+//
+
+#pragma once
+
+#include <span>
+#include <type_traits>
+#include "ControlFlow.h"
+
+namespace alx::ir {
+
+// Calls `func` with each of an instruction's operands, as a reference that can be assigned to if the instruction
+// isn't const. A store's pointer and a load's are operands like any other.
+template<typename Instruction, typename Func>
+	requires std::is_same_v<std::remove_const_t<Instruction>, BodyTypes>
+void forEachOperand(Instruction& instruction, Func&& func)
+{
+	const auto binary = [&func](auto& inst) {
+		func(inst.Lhs);
+		func(inst.Rhs);
+	};
+	const auto variable = [&](auto& allocation) {
+		std::visit(
+			[&](auto& inst) {
+				using Inst = std::remove_const_t<std::remove_reference_t<decltype(inst)>>;
+				if constexpr (std::is_same_v<Inst, LoadInst>)
+					func(inst.Ptr);
+				else if constexpr (std::is_same_v<Inst, PhiInst>) {
+					for (auto& incoming : inst.Incoming) func(incoming.Value);
+				}
+				else if constexpr (!std::is_same_v<Inst, AllocaInst>)
+					binary(inst);
+			},
+			allocation);
+	};
+	std::visit(
+		[&](auto& inst) {
+			using Inst = std::remove_const_t<std::remove_reference_t<decltype(inst)>>;
+			if constexpr (std::is_same_v<Inst, Variable>)
+				variable(inst.Allocation);
+			else if constexpr (std::is_same_v<Inst, StoreInst>) {
+				func(inst.Value);
+				func(inst.Ptr);
+			}
+			else if constexpr (std::is_same_v<Inst, BranchInst>) {
+				if (inst.Condition)
+					func(*inst.Condition);
+			}
+			else if constexpr (std::is_same_v<Inst, ReturnInst>)
+				func(inst.Value);
+		},
+		instruction);
+}
+
+// The instructions that use each instruction's result, and the block each instruction is in. Only instructions that
+// have been placed in a block count, and an instruction that uses a value twice is listed twice.
+class UseLists
+{
+	// Users of instruction i are m_users[m_first_user[i]] up to m_users[m_first_user[i + 1]]
+	std::vector<uint32_t> m_first_user;
+	std::vector<InstructionId> m_users;
+	std::vector<BlockId> m_blocks;
+
+public:
+	static constexpr BlockId NoBlock = UINT32_MAX;
+
+	explicit UseLists(const Function& function);
+
+	// In the order the blocks are in, and within a block the order its instructions are in
+	[[nodiscard]] std::span<const InstructionId> Users(Values value) const
+	{
+		if (value.IsConstant())
+			return {};
+		return std::span(m_users).subspan(m_first_user[value.Index()],
+										   m_first_user[value.Index() + 1] - m_first_user[value.Index()]);
+	}
+	[[nodiscard]] bool IsUsed(Values value) const { return !Users(value).empty(); }
+	// NoBlock for an instruction that hasn't been placed
+	[[nodiscard]] BlockId BlockOf(InstructionId instruction) const { return m_blocks[instruction]; }
+};
+
+} // namespace alx::ir
@@ -8,8 +8,8 @@
 
 #pragma once
 
-#include <memory>
-#include "Variables.h"
+#include <optional>
+#include <vector>
 #include "Values.h"
 
 namespace alx::ir {
@@ -92,57 +92,20 @@ struct URemInst {
 
 // We use alloca instruction in the code generator to increment the stack pointer
 struct AllocaInst {
-	std::shared_ptr<Types> Type;
+	TypeId Type;
 	// Sizeof type in bytes
-	[[nodiscard]] size_t Size() const
-	{
-		struct SizeVisitor {
-			size_t operator()(const SingleValueType& value) const
-			{
-				switch (value) {
-				case SingleValueType::Void:
-					return 0;
-				case SingleValueType::Half:
-					return 2;
-				case SingleValueType::Float:
-					return 4;
-				case SingleValueType::Double:
-					return 8;
-				default:
-					ASSERT_NOT_REACHABLE();
-				}
-			}
-
-			size_t operator()(const IntType& type) const { return type.Size; }
-
-			size_t operator()(const PtrType&) const { return sizeof(void*); }
-
-			size_t operator()(const StructType& type) const
-			{
-				size_t size = 0;
-				for (const auto& t : type.TypeList) {
-					size += std::visit(SizeVisitor{}, t);
-				}
-				return size;
-			}
-
-			size_t operator()(const ArrayType& type) const { return type.Size * std::visit(SizeVisitor{}, *type.Type); }
-			size_t operator()(const LabelType&) const { ASSERT_NOT_REACHABLE(); };
-		};
-		return std::visit(SizeVisitor{}, *Type);
-	}
+	size_t Size;
 };
 
-struct Variable;
 struct StoreInst {
 	Values Value;
-	std::shared_ptr<Variable> Ptr;
+	Values Ptr;
 	AlignAttribute Alignment;
 };
 
 struct LoadInst {
-	Types Type;
-	std::shared_ptr<Variable> Ptr;
+	TypeId Type;
+	Values Ptr;
 	AlignAttribute Alignment;
 };
 
@@ -168,7 +131,20 @@ struct ICmpInst {
 	CmpPredicate Predicate;
 };
 
-using IdentifierInstruction = std::variant<AllocaInst, LoadInst, AddInst, SubInst, MulInst, SDivInst, ICmpInst>;
+// The value a variable has at the start of a block, from whichever block control came from. Only made by promoting
+// variables out of memory, and taken back out before instruction selection.
+struct PhiIncoming {
+	Values Value;
+	LabelType Block;
+};
+
+struct PhiInst {
+	TypeId Type;
+	std::vector<PhiIncoming> Incoming{};
+};
+
+using IdentifierInstruction =
+	std::variant<AllocaInst, LoadInst, AddInst, SubInst, MulInst, SDivInst, ICmpInst, PhiInst>;
 
 inline std::string cmpPredicateToString(CmpPredicate predicate)
 {
@@ -19,7 +19,7 @@ void IR::Generate()
 	println("Generating IR:");
 	for (const auto& node : m_ast)
 	{
-		if (node->class_name() == "FunctionDeclaration")
+		if (node->Kind() == NodeKind::FunctionDeclaration)
 		{
 			auto& func = static_cast<FunctionDeclaration&>(*node);
 			generate_function(func);
@@ -32,12 +32,12 @@ void IR::Generate()
 	println("Done generating IR");
 }
 
-Values IR::NumberLiteralToValue(const NumberLiteral& literal, size_t size)
+Values IR::NumberLiteralToValue(const NumberLiteral& literal, size_t size, Function& function)
 {
 	const auto& numLit = static_cast<const NumberLiteral&>(literal);
 	if (isIntegerLiteral(numLit.Type()))
 	{
-		return Constant{ .Type = IntType{ size }, .Value = numLit.AsInt() };
+		return function.MakeConstant(Constant{ .Type = IntType{ size }, .Value = numLit.AsInt() });
 	}
 	else if (!isIntegerLiteral(numLit.Type()) && isNumberLiteral(numLit.Type()))
 	{
@@ -46,7 +46,7 @@ Values IR::NumberLiteralToValue(const NumberLiteral& literal, size_t size)
 			type = SingleValueType::Float;
 		else if (numLit.Type() == TokenType::T_DOUBLE_L)
 			type = SingleValueType::Double;
-		return Constant{ .Type = type, .Value = numLit.AsDouble() };
+		return function.MakeConstant(Constant{ .Type = type, .Value = numLit.AsDouble() });
 	}
 	else
 	{
@@ -56,5 +56,16 @@ Values IR::NumberLiteralToValue(const NumberLiteral& literal, size_t size)
 	}
 }
 
+Values IR::ConstantToValue(const ConstantValue& constant, size_t size, Function& function)
+{
+	if (constant.Type() == TokenType::T_FLOAT)
+		return function.MakeConstant(Constant{ .Type = SingleValueType::Float, .Value = constant.AsDouble() });
+	if (constant.Type() == TokenType::T_DOUBLE)
+		return function.MakeConstant(Constant{ .Type = SingleValueType::Double, .Value = constant.AsDouble() });
+	// Wrapped to the width it's stored at, which can be narrower than the expression's
+	return function.MakeConstant(
+		Constant{ .Type = IntType{ size }, .Value = constant.Cast(integer_type_of(size)).AsInt() });
+}
+
 
 }
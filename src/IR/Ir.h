@@ -9,6 +9,7 @@
 #include <string>
 #include <variant>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <unordered_map>
 #include "Types.h"
@@ -29,23 +30,21 @@ struct FunctionParameter {
 };
 
 using BodyTypes = std::variant<LabelType, ReturnInst, Variable, StoreInst, BranchInst>;
-class LogicalBlock
+// Whether the instruction ends its block, which makes anything after it in the block unreachable
+inline bool isTerminator(const BodyTypes& instruction)
 {
-	std::unordered_map<std::string, std::shared_ptr<Variable>> m_identifiers;
+	return std::holds_alternative<BranchInst>(instruction) || std::holds_alternative<ReturnInst>(instruction);
+}
+
+// Index of an instruction in its function's instructions
+using InstructionId = uint32_t;
 
+class LogicalBlock
+{
 public:
 	LabelType Label;
-	std::vector<BodyTypes> Body;
-
-	[[nodiscard]] const std::unordered_map<std::string, std::shared_ptr<Variable>>& Identifiers() const
-	{
-		return m_identifiers;
-	}
-
-	void AddIdentifier(const std::string& name, const std::shared_ptr<Variable>& variable)
-	{
-		m_identifiers[name] = variable;
-	}
+	// The block's instructions in order, which live in the function
+	std::vector<InstructionId> Body;
 
 	LogicalBlock() = default;
 
@@ -61,64 +60,161 @@ struct Function {
 
 	std::vector<FunctionParameter> Arguments{};
 	std::vector<LogicalBlock> Blocks{};
-	LogicalBlock ReturnBlock{};
 	bool Returns = false;
 	bool MultipleReturns = false;
 
-	[[nodiscard]] std::shared_ptr<Variable> FindVariableByIdentifier(const std::string& name);
+	// Every instruction of the function, in the order they were made rather than the order they run in, which is
+	// what the blocks are for. Operands refer to them and to the constants and types below by index, so lowering
+	// allocates as the vectors grow rather than per instruction.
+	std::vector<BodyTypes> Instructions{};
+	std::vector<Constant> Constants{};
+	std::unordered_map<Constant::Key, uint32_t, Constant::Key::Hash> ConstantIds{};
+	std::vector<Types> TypePool{};
+
+	// Indices into the above, kept up to date as variables and blocks are appended so that finding either doesn't
+	// depend on how many blocks the function has
+	struct DeclaredVariable {
+		size_t Block;
+		Values Allocation;
+	};
+	std::unordered_map<SymbolId, DeclaredVariable> DeclaredVariables{};
+	std::unordered_map<std::string, size_t> BlockIndices{};
+
+	// Bumped whenever the function changes, which is how analyses of it know they're out of date. Anything that
+	// changes the function other than through the methods below has to say so by calling one of the *Changed methods.
+	size_t ControlFlowRevision = 0;
+	size_t InstructionRevision = 0;
+	// Blocks, or the branches and returns that end them
+	void ControlFlowChanged()
+	{
+		++ControlFlowRevision;
+		++InstructionRevision;
+	}
+	void InstructionsChanged() { ++InstructionRevision; }
+
+	[[nodiscard]] std::optional<Values> FindVariableByIdentifier(const alx::Identifier& identifier);
 	[[nodiscard]] LogicalBlock& GetBlockByLabel(const std::string& label);
 
 	void PrintNode(IR&) const;
 
 	size_t UnnamedTemporaryCounter = 0;
 
-	std::unordered_map<std::string, size_t> NamedTemporaries{};
+	std::unordered_map<SymbolId, size_t> NamedTemporaries{};
 
 	void ResolveReturnSentinels();
 
-	void AppendInstruction(const BodyTypes& body)
+	// Adds a variable to the function without placing it in a block yet, which `AppendInstruction` does
+	[[nodiscard]] Values NewVariable(Variable variable)
+	{
+		InstructionsChanged();
+		Instructions.emplace_back(std::move(variable));
+		return Values::OfInstruction(static_cast<InstructionId>(Instructions.size() - 1));
+	}
+
+	// A load of the variable `ptr` points to into a new temporary, which still has to be appended
+	[[nodiscard]] Values NewLoad(Values ptr);
+
+	void AppendInstruction(Values variable)
+	{
+		MUST(!variable.IsConstant());
+		InstructionsChanged();
+		Blocks.back().Body.push_back(variable.Index());
+		// Temporaries have no symbol and are never looked up by identifier
+		if (const auto symbol = VariableOf(variable).Symbol; symbol != NoSymbol)
+			declare(symbol, variable);
+	}
+
+	void AppendInstruction(BodyTypes instruction)
+	{
+		if (auto* variable = std::get_if<Variable>(&instruction)) {
+			AppendInstruction(NewVariable(std::move(*variable)));
+			return;
+		}
+		if (isTerminator(instruction))
+			ControlFlowChanged();
+		else
+			InstructionsChanged();
+		Instructions.push_back(std::move(instruction));
+		Blocks.back().Body.push_back(static_cast<InstructionId>(Instructions.size() - 1));
+	}
+
+	void AppendBlock(const LogicalBlock& block)
 	{
-		Blocks.back().Body.push_back(body);
-		if (std::holds_alternative<Variable>(body))
-			Blocks.back().AddIdentifier(std::get<Variable>(body).Name,
-										std::make_shared<Variable>(std::get<Variable>(const_cast<BodyTypes&>(body))));
+		ControlFlowChanged();
+		BlockIndices.try_emplace(block.Label.Name, Blocks.size());
+		Blocks.push_back(block);
 	}
 
-	void AppendBlock(const LogicalBlock& block) { Blocks.push_back(block); }
+	// The function's copy of a constant, made the first time it's used
+	[[nodiscard]] Values MakeConstant(const Constant& constant);
+	[[nodiscard]] TypeId InternType(const Types& type);
+
+	[[nodiscard]] const Variable& VariableOf(Values value) const
+	{
+		return std::get<Variable>(Instructions[value.Index()]);
+	}
+	[[nodiscard]] const Constant& ConstantOf(Values value) const { return Constants[value.Index()]; }
+	[[nodiscard]] const Types& TypeOf(TypeId type) const { return TypePool[type]; }
+	// Size in bytes
+	[[nodiscard]] size_t SizeOf(Values value) const;
 
 	std::string GetNewUnnamedTemporary() { return std::to_string(UnnamedTemporaryCounter++); }
-	std::string GetNewNamedTemporary(const std::string& name)
+	std::string GetNewNamedTemporary(const Interner& interner, SymbolId symbol)
 	{
-		auto it = NamedTemporaries.find(name);
-		if (it == NamedTemporaries.end()) {
-			NamedTemporaries[name] = 1;
+		std::string name(interner.Name(symbol));
+		auto [it, inserted] = NamedTemporaries.try_emplace(symbol, 1);
+		if (inserted)
 			return name;
-		}
 		return name + "." + std::to_string(it->second++);
 	}
+
+private:
+	void declare(SymbolId symbol, Values variable);
 };
 
 using IRNodes = std::variant<std::unique_ptr<Function>>;
 class IR
 {
-	const std::vector<std::unique_ptr<ASTNode>>& m_ast{};
+	std::span<ASTNode* const> m_ast{};
+	std::shared_ptr<Interner> m_interner;
+	// Label prefixes, interned once so that per-function label counters are keyed by symbol
+	const SymbolId m_if_then;
+	const SymbolId m_if_else;
+	const SymbolId m_if_end;
+	const SymbolId m_while_body;
+	const SymbolId m_while_cond;
+	const SymbolId m_while_end;
 	std::vector<IRNodes> m_ir;
 	std::string m_ir_string;
+	// The values of the operands of the expression being lowered, which are lowered before the expressions using them
+	std::unordered_map<const Expression*, Values> m_lowered;
 	friend void FunctionParameter::PrintNode(IR& ir) const;
 	friend void Function::PrintNode(IR&) const;
-	friend void Variable::PrintNode(IR& ir) const;
+	friend void Variable::PrintNode(IR& ir, const Function& function) const;
 
 public:
-	explicit IR(const std::vector<std::unique_ptr<ASTNode>>& ast) : m_ast(ast) {}
+	IR(std::span<ASTNode* const> ast, const std::shared_ptr<Interner>& interner)
+	  : m_ast(ast),
+		m_interner(interner),
+		m_if_then(interner->Intern("if.then")),
+		m_if_else(interner->Intern("if.else")),
+		m_if_end(interner->Intern("if.end")),
+		m_while_body(interner->Intern("while.body")),
+		m_while_cond(interner->Intern("while.cond")),
+		m_while_end(interner->Intern("while.end"))
+	{}
 
 	void Generate();
 	[[nodiscard]] const std::vector<IRNodes>& GetIR() const { return m_ir; }
-	void Dump();
+	[[nodiscard]] std::vector<IRNodes>& GetIR() { return m_ir; }
+	// Prints the IR as it is after the named stage of the pipeline
+	void Dump(const std::string& stage = "initial");
 
 	static std::string EnumToString(std::variant<LinkageType, ParameterAttributes>);
 	static std::string TypesToString(const Types&);
 	static Types TokenTypeToIRType(TokenType);
-	static Values NumberLiteralToValue(const NumberLiteral&, size_t);
+	static Values NumberLiteralToValue(const NumberLiteral&, size_t, Function&);
+	static Values ConstantToValue(const ConstantValue&, size_t, Function&);
 
 #if OUTPUT_IR_TO_STRING
 	[[nodiscard]] const std::string& GetIRString() const { return m_ir_string; }
@@ -131,32 +227,28 @@ private:
 	void generate_variable(const VariableDeclaration&, Function&);
 	void generate_return_statement(const ReturnStatement&, Function&);
 	std::optional<Values> generate_binary_expression(const BinaryExpression&, Function&);
-
-	[[nodiscard]] std::optional<std::shared_ptr<Variable>> generate_unary_expression(const UnaryExpression&, Function&);
+	[[nodiscard]] std::optional<Values> generate_unary_expression(const UnaryExpression&, Function&);
+	// Lowers an expression tree operands first, on a stack of its own so that how deeply it nests doesn't matter
+	std::optional<Values> generate_expression(const Expression&, Function&);
+	[[nodiscard]] bool has_lowered(const Expression&) const;
+	[[nodiscard]] Values take_lowered(const Expression&);
+
+	// Lower a single operator, whose lowered operands are in m_lowered
+	std::optional<Values> generate_binary_operator(const BinaryExpression&, Function&);
+	[[nodiscard]] std::optional<Values> generate_unary_operator(const UnaryExpression&, Function&);
 	template<typename Func>
-	[[nodiscard]] std::optional<std::shared_ptr<Variable>> generate_unary_op(const UnaryExpression&, Function&, Func);
+	[[nodiscard]] std::optional<Values> generate_unary_op(const UnaryExpression&, Function&, Func);
 
 	[[nodiscard]] std::optional<Values> generate_bin_eq(const BinaryExpression&, Function&);
 	template<typename Func>
-	[[nodiscard]] std::optional<std::shared_ptr<Variable>> generate_binary_op(const BinaryExpression& binaryExpression,
-																			  Function& function,
-																			  Func instruction);
+	[[nodiscard]] std::optional<Values> generate_binary_op(const BinaryExpression& binaryExpression,
+														   Function& function,
+														   Func instruction);
 
 	void generate_if_statement(IfStatement&, Function&);
+	// Lowers one link of an else if chain, returning the next link if there is one
+	IfStatement* generate_if_link(IfStatement&, Function&, std::vector<LogicalBlock>& openEnds);
 	void generate_while_statement(WhileStatement&, Function&);
 };
 
-using Instruction = std::variant<AllocaInst,
-								 LoadInst,
-								 AddInst,
-								 SubInst,
-								 MulInst,
-								 SDivInst,
-								 ICmpInst,
-								 LabelType,
-								 ReturnInst,
-								 Variable,
-								 StoreInst,
-								 BranchInst>;
-
 } // namespace alx::ir
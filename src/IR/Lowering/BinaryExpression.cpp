@@ -7,104 +7,89 @@
 //
 
 #include "../Ir.h"
+#include "../../AST/Walk.h"
 
 namespace alx::ir {
-std::optional<Values>
 
-IR::generate_bin_eq(const BinaryExpression& eqExpr, // NOLINT(*-no-recursion)
-					Function& function)
+std::optional<Values> IR::generate_bin_eq(const BinaryExpression& eqExpr, Function& function)
 {
 	auto lhs = eqExpr.Lhs();
 	auto rhs = eqExpr.Rhs();
-	if (lhs->class_name() == "Identifier") {
+	if (lhs->Kind() == NodeKind::Identifier) {
 		auto astIdentifier = static_cast<const Identifier&>(*lhs);
-		auto variable = function.FindVariableByIdentifier(astIdentifier.Name());
+		auto variable = function.FindVariableByIdentifier(astIdentifier);
 		if (!variable)
 			return {};
 
-		if (rhs->class_name() == "NumberLiteral") {
-			auto value = IR::NumberLiteralToValue(static_cast<const NumberLiteral&>(*rhs), variable->Size());
-			StoreInst store{ .Value = value, .Ptr = variable, .Alignment = { variable->Size() } };
+		if (rhs->Kind() == NodeKind::NumberLiteral) {
+			auto value =
+				IR::NumberLiteralToValue(static_cast<const NumberLiteral&>(*rhs), function.SizeOf(*variable), function);
+			StoreInst store{ .Value = value, .Ptr = *variable, .Alignment = { function.SizeOf(*variable) } };
 			function.AppendInstruction(store);
 			return value;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
+		else if (rhs->Kind() == NodeKind::BinaryExpression) {
 			auto& binExpr = static_cast<BinaryExpression&>(*rhs);
 			if (binExpr.Constexpr()) {
-				const auto& rhsExpr = static_cast<const BinaryExpression&>(*rhs);
-				auto eval = rhsExpr.Evaluate();
-				auto value = IR::NumberLiteralToValue(*eval, variable->Size());
-				StoreInst store{ .Value = value, .Ptr = variable, .Alignment = { variable->Size() } };
+				auto value = IR::ConstantToValue(binExpr.Evaluate(), function.SizeOf(*variable), function);
+				StoreInst store{ .Value = value, .Ptr = *variable, .Alignment = { function.SizeOf(*variable) } };
 				function.AppendInstruction(store);
 				return value;
 			}
 			else {
-				auto expr = generate_binary_expression(binExpr, function);
-				MUST(expr);
-				StoreInst store{ .Value = expr.value(), .Ptr = variable, .Alignment = { variable->Size() } };
+				auto expr = take_lowered(binExpr);
+				StoreInst store{ .Value = expr, .Ptr = *variable, .Alignment = { function.SizeOf(*variable) } };
 				function.AppendInstruction(store);
-				return expr.value();
+				return expr;
 			}
 		}
-		else if (rhs->class_name() == "Identifier") {
+		else if (rhs->Kind() == NodeKind::Identifier) {
 			auto& ident = static_cast<Identifier&>(*rhs);
-			auto rhsVariable = function.FindVariableByIdentifier(ident.Name());
+			auto rhsVariable = function.FindVariableByIdentifier(ident);
 			if (!rhsVariable)
 				return {};
-			LoadInst load{ .Type = *(std::get<AllocaInst>(rhsVariable->Allocation).Type),
-						   .Ptr = rhsVariable,
-						   .Alignment = { std::get<AllocaInst>(rhsVariable->Allocation).Size() } };
-			auto loadTemp = std::make_shared<Variable>(
-				Variable{ .Name = function.GetNewUnnamedTemporary(),
-						  .Attributes = { AlignAttribute{ std::get<AllocaInst>(rhsVariable->Allocation).Size() } },
-						  .Allocation = load,
-						  .IsTemporary = true });
+			auto loadTemp = function.NewLoad(*rhsVariable);
 			StoreInst store{ .Value = loadTemp,
-							 .Ptr = variable,
-							 .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-			function.Blocks.back().Body.emplace_back(*loadTemp);
+							 .Ptr = *variable,
+							 .Alignment = { function.SizeOf(*variable) } };
+			function.AppendInstruction(loadTemp);
 			function.AppendInstruction(store);
 			return loadTemp;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
+		else if (rhs->Kind() == NodeKind::BinaryExpression) {
 			auto& binExpr = static_cast<BinaryExpression&>(*rhs);
 			if (binExpr.Constexpr()) {
-				const auto& rhsExpr = static_cast<const BinaryExpression&>(*rhs);
-				auto eval = rhsExpr.Evaluate();
-				auto value = IR::NumberLiteralToValue(*eval, variable->Size());
-				StoreInst store{ .Value = value, .Ptr = variable, .Alignment = { variable->Size() } };
+				auto value = IR::ConstantToValue(binExpr.Evaluate(), function.SizeOf(*variable), function);
+				StoreInst store{ .Value = value, .Ptr = *variable, .Alignment = { function.SizeOf(*variable) } };
 				function.AppendInstruction(store);
 				return value;
 			}
-			else {
-				auto result = generate_binary_expression(binExpr, function);
-				MUST(result.has_value());
-				return result.value();
-			}
+			else
+				return take_lowered(binExpr);
 		}
-		else if (rhs->class_name() == "UnaryExpression") {
+		else if (rhs->Kind() == NodeKind::UnaryExpression) {
 			auto& unExpr = static_cast<UnaryExpression&>(*rhs);
-			auto result = generate_unary_expression(unExpr, function);
-			if (!result.has_value())
+			if (!has_lowered(unExpr))
 				return {};
-			StoreInst store{ .Value = result.value(), .Ptr = variable, .Alignment = { variable->Size() } };
-			function.Blocks.back().Body.emplace_back(store);
-			return result.value();
+			auto result = take_lowered(unExpr);
+			StoreInst store{ .Value = result, .Ptr = *variable, .Alignment = { function.SizeOf(*variable) } };
+			function.AppendInstruction(store);
+			return result;
 		}
 		else // TODO: MemberExpression, StringLiteral
 		{
 			println(Colour::Red, "Unknown rhs expression type: {;255;255;255}", rhs->class_name());
 		}
 	}
-	else if (lhs->class_name() == "NumberLiteral")
+	else if (lhs->Kind() == NodeKind::NumberLiteral)
 		ASSERT_NOT_REACHABLE(); // Can't assign to prvalue
-	else if (lhs->class_name() == "BinaryExpression")
+	else if (lhs->Kind() == NodeKind::BinaryExpression)
 		ASSERT_NOT_REACHABLE(); // Can't assign to prvalue
-	else if (lhs->class_name() == "UnaryExpression")
+	else if (lhs->Kind() == NodeKind::UnaryExpression)
 		ASSERT_NOT_REACHABLE(); // Can't assign to prvalue
-	else if (lhs->class_name() == "MemberExpression")
+	else if (lhs->Kind() == NodeKind::MemberExpression)
 		ASSERT_NOT_IMPLEMENTED();
-	else if (lhs->class_name() == "StringLiteral")
+	else if (lhs->Kind() == NodeKind::StringLiteral)
 		ASSERT_NOT_REACHABLE(); // Read-only value is not assignable
 
 	println(Colour::Red, "Unknown lhs expression type: {;255;255;255}", lhs->class_name());
@@ -112,262 +97,194 @@ IR::generate_bin_eq(const BinaryExpression& eqExpr, // NOLINT(*-no-recursion)
 }
 
 template<typename Func>
-std::optional<std::shared_ptr<Variable>> IR::generate_binary_op(const BinaryExpression& binaryExpression,
-																Function& function,
-																Func instruction)
+std::optional<Values> IR::generate_binary_op(const BinaryExpression& binaryExpression,
+											 Function& function,
+											 Func instruction)
 {
 	auto lhs = binaryExpression.Lhs();
 	auto rhs = binaryExpression.Rhs();
-	if (lhs->class_name() == "Identifier") {
+	if (lhs->Kind() == NodeKind::Identifier) {
 		auto astIdentifier = static_cast<const Identifier&>(*lhs);
 		
-		auto variable = function.FindVariableByIdentifier(astIdentifier.Name());
+		auto variable = function.FindVariableByIdentifier(astIdentifier);
 		MUST(variable);
 
-		LoadInst loadLhs{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-						  .Ptr = variable,
-						  .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-		auto temporary = std::make_shared<Variable>(
-			Variable{ .Name = function.GetNewUnnamedTemporary(),
-					  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-					  .Allocation = loadLhs,
-					  .IsTemporary = true });
+		auto temporary = function.NewLoad(*variable);
 
-		if (rhs->class_name() == "NumberLiteral") {
+		if (rhs->Kind() == NodeKind::NumberLiteral) {
 			const auto& numLit = static_cast<const NumberLiteral&>(*rhs);
-			auto value = IR::NumberLiteralToValue(numLit, variable->Size());
-			function.AppendInstruction(*temporary);
+			auto value = IR::NumberLiteralToValue(numLit, function.SizeOf(*variable), function);
+			function.AppendInstruction(temporary);
 			auto instructionTemp = instruction(temporary, value);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "Identifier") {
+		else if (rhs->Kind() == NodeKind::Identifier) {
 			auto& ident = static_cast<Identifier&>(*rhs);
-			auto rhsVariable = function.FindVariableByIdentifier(ident.Name());
+			auto rhsVariable = function.FindVariableByIdentifier(ident);
 			MUST(rhsVariable);
 
-			LoadInst loadRhs{ .Type = *(std::get<AllocaInst>(rhsVariable->Allocation).Type),
-							  .Ptr = rhsVariable,
-							  .Alignment = { std::get<AllocaInst>(rhsVariable->Allocation).Size() } };
-			auto temporaryRhs = std::make_shared<Variable>(
-				Variable{ .Name = function.GetNewUnnamedTemporary(),
-						  .Attributes = { AlignAttribute{ std::get<AllocaInst>(rhsVariable->Allocation).Size() } },
-						  .Allocation = loadRhs,
-						  .IsTemporary = true });
-			function.AppendInstruction(*temporary);
-			function.AppendInstruction(*temporaryRhs);
+			auto temporaryRhs = function.NewLoad(*rhsVariable);
+			function.AppendInstruction(temporary);
+			function.AppendInstruction(temporaryRhs);
 			auto instructionTemp = instruction(temporary, temporaryRhs);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
-			auto result = generate_binary_expression(static_cast<BinaryExpression&>(*rhs), function);
-			MUST(result.has_value());
-			function.AppendInstruction(*temporary);
-			auto instructionTemp = instruction(temporary, result.value());
+		else if (rhs->Kind() == NodeKind::BinaryExpression || rhs->Kind() == NodeKind::UnaryExpression) {
+			auto result = take_lowered(*rhs);
+			function.AppendInstruction(temporary);
+			auto instructionTemp = instruction(temporary, result);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "UnaryExpression") {
-			auto result = generate_unary_expression(static_cast<UnaryExpression&>(*rhs), function);
-			MUST(result.has_value());
-			function.AppendInstruction(*temporary);
-			auto instructionTemp = instruction(temporary, result.value());
-			return instructionTemp;
-		}
-		else if (rhs->class_name() == "MemberExpression") {
+		else if (rhs->Kind() == NodeKind::MemberExpression) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
-		else if (rhs->class_name() == "StringLiteral") {
+		else if (rhs->Kind() == NodeKind::StringLiteral) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
 		println(Colour::Red, "Unknown rhs expression type: {;255;255;255}", rhs->class_name());
 	}
-	else if (lhs->class_name() == "NumberLiteral") {
+	else if (lhs->Kind() == NodeKind::NumberLiteral) {
 		auto& numLit = static_cast<const NumberLiteral&>(*lhs);
-		auto value = IR::NumberLiteralToValue(numLit, size_of(numLit.Type()));
+		auto value = IR::NumberLiteralToValue(numLit, size_of(numLit.Type()), function);
 
-		if (rhs->class_name() == "Identifier") {
+		if (rhs->Kind() == NodeKind::Identifier) {
 			auto ident = static_cast<const Identifier&>(*rhs);
-			auto variable = function.FindVariableByIdentifier(ident.Name());
+			auto variable = function.FindVariableByIdentifier(ident);
 			MUST(variable);
-			LoadInst loadLhs{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-							  .Ptr = variable,
-							  .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-			auto temporary = std::make_shared<Variable>(
-				Variable{ .Name = function.GetNewUnnamedTemporary(),
-						  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-						  .Allocation = loadLhs,
-						  .IsTemporary = true });
-			function.AppendInstruction(*temporary);
+			auto temporary = function.NewLoad(*variable);
+			function.AppendInstruction(temporary);
 			auto instructionTemp = instruction(value, temporary);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "NumberLiteral") {
+		else if (rhs->Kind() == NodeKind::NumberLiteral) {
 			// This should always be a constant expression
 			ASSERT_NOT_REACHABLE();
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
-			auto result = generate_binary_expression(static_cast<BinaryExpression&>(*rhs), function);
-			MUST(result.has_value());
-			auto instructionTemp = instruction(value, result.value());
-			return instructionTemp;
-		}
-		else if (rhs->class_name() == "UnaryExpression") {
-			auto result = generate_unary_expression(static_cast<UnaryExpression&>(*rhs), function);
-			MUST(result.has_value());
-			auto instructionTemp = instruction(value, result.value());
+		else if (rhs->Kind() == NodeKind::BinaryExpression || rhs->Kind() == NodeKind::UnaryExpression) {
+			auto instructionTemp = instruction(value, take_lowered(*rhs));
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "MemberExpression") {
+		else if (rhs->Kind() == NodeKind::MemberExpression) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
-		else if (rhs->class_name() == "StringLiteral") {
+		else if (rhs->Kind() == NodeKind::StringLiteral) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
 		println(Colour::Red, "Unknown rhs expression type: {;255;255;255}", rhs->class_name());
 	}
-	else if (lhs->class_name() == "BinaryExpression") {
+	else if (lhs->Kind() == NodeKind::BinaryExpression) {
 		const auto& binExp = static_cast<const BinaryExpression&>(*lhs);
 
-		std::shared_ptr<Variable> resulting;
-		std::variant<Values, NumberLiteral> result;
+		std::variant<Values, ConstantValue> result;
 		if (binExp.Constexpr())
-			result = *binExp.Evaluate();
-		else {
-			auto eval = generate_binary_expression(binExp, function);
-			MUST(eval.has_value());
-			result = eval.value();
-		}
-		if (rhs->class_name() == "Identifier") {
+			result = binExp.Evaluate();
+		else
+			result = take_lowered(binExp);
+		if (rhs->Kind() == NodeKind::Identifier) {
 
 			auto ident = static_cast<const Identifier&>(*rhs);
-			auto variable = function.FindVariableByIdentifier(ident.Name());
+			auto variable = function.FindVariableByIdentifier(ident);
 			MUST(variable);
-			LoadInst loadLhs{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-							  .Ptr = variable,
-							  .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-			auto temporary = std::make_shared<Variable>(
-				Variable{ .Name = function.GetNewUnnamedTemporary(),
-						  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-						  .Allocation = loadLhs,
-						  .IsTemporary = true });
+			auto temporary = function.NewLoad(*variable);
 			if (binExp.Constexpr()) {
-				auto lhsValue = NumberLiteralToValue(std::get<NumberLiteral>(result),
-													 size_of(std::get<NumberLiteral>(result).Type()));
+				auto lhsValue = ConstantToValue(std::get<ConstantValue>(result),
+												size_of(std::get<ConstantValue>(result).Type()), function);
 				auto instructionTemp = instruction(lhsValue, temporary);
-				function.AppendInstruction(*temporary);
+				function.AppendInstruction(temporary);
 				return instructionTemp;
 			}
 			auto lhsValue = std::get<Values>(result);
-			function.AppendInstruction(*temporary);
+			function.AppendInstruction(temporary);
 			auto instructionTemp = instruction(lhsValue, temporary);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "NumberLiteral") {
+		else if (rhs->Kind() == NodeKind::NumberLiteral) {
 			// If this is not constexpr, we messed up in the parser
 			MUST(!binExp.Constexpr() && "Binary op with 'NumberLiteral's on both sides should be constexpr");
 			auto resultVariable = std::get<Values>(result);
 			auto value = IR::NumberLiteralToValue(static_cast<const NumberLiteral&>(*rhs),
-												  std::get<std::shared_ptr<Variable>>(resultVariable)->Size());
+												  function.SizeOf(resultVariable), function);
 			auto instructionTemp = instruction(resultVariable, value);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
+		else if (rhs->Kind() == NodeKind::BinaryExpression) {
 			const auto& rhsBinExp = static_cast<const BinaryExpression&>(*rhs);
 			if (binExp.Constexpr()) {
 
-				auto lhsValue = NumberLiteralToValue(std::get<NumberLiteral>(result),
-													 size_of(std::get<NumberLiteral>(result).Type()));
+				auto lhsValue = ConstantToValue(std::get<ConstantValue>(result),
+												size_of(std::get<ConstantValue>(result).Type()), function);
 				if (rhsBinExp.Constexpr()) {
-					auto rhsValue =
-						NumberLiteralToValue(*rhsBinExp.Evaluate(), size_of(std::get<NumberLiteral>(result).Type()));
+					auto rhsValue = ConstantToValue(
+						rhsBinExp.Evaluate(), size_of(std::get<ConstantValue>(result).Type()), function);
 					auto instructionTemp = instruction(lhsValue, rhsValue);
 					return instructionTemp;
 				}
-				auto rhsValue = generate_binary_expression(rhsBinExp, function);
-				MUST(rhsValue.has_value());
-				auto instructionTemp = instruction(lhsValue, rhsValue.value());
+				auto instructionTemp = instruction(lhsValue, take_lowered(rhsBinExp));
 				return instructionTemp;
 			}
 			if (rhsBinExp.Constexpr()) {
-				auto rhsValue =
-					NumberLiteralToValue(*rhsBinExp.Evaluate(), size_of(std::get<NumberLiteral>(result).Type()));
+				auto rhsValue = ConstantToValue(rhsBinExp.Evaluate(), size_of(rhsBinExp.Evaluate().Type()), function);
 				auto instructionTemp = instruction(std::get<Values>(result), rhsValue);
 				return instructionTemp;
 			}
-			auto rhsValue = generate_binary_expression(rhsBinExp, function);
-			MUST(rhsValue.has_value());
-			auto instructionTemp = instruction(std::get<Values>(result), rhsValue.value());
+			auto instructionTemp = instruction(std::get<Values>(result), take_lowered(rhsBinExp));
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "UnaryExpression") {
-			auto rhsValue = generate_unary_expression(static_cast<UnaryExpression&>(*rhs), function);
-			MUST(rhsValue.has_value());
+		else if (rhs->Kind() == NodeKind::UnaryExpression) {
+			auto rhsValue = take_lowered(*rhs);
 			if (binExp.Constexpr()) {
-				auto lhsValue = NumberLiteralToValue(std::get<NumberLiteral>(result),
-													 size_of(std::get<NumberLiteral>(result).Type()));
-				auto instructionTemp = instruction(lhsValue, rhsValue.value());
+				auto lhsValue = ConstantToValue(std::get<ConstantValue>(result),
+												size_of(std::get<ConstantValue>(result).Type()), function);
+				auto instructionTemp = instruction(lhsValue, rhsValue);
 				return instructionTemp;
 			}
-			auto instructionTemp = instruction(std::get<Values>(result), rhsValue.value());
+			auto instructionTemp = instruction(std::get<Values>(result), rhsValue);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "MemberExpression") {
+		else if (rhs->Kind() == NodeKind::MemberExpression) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
-		else if (rhs->class_name() == "StringLiteral") {
+		else if (rhs->Kind() == NodeKind::StringLiteral) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
 		println(Colour::Red, "Unknown rhs expression type: {;255;255;255}", rhs->class_name());
 	}
-	else if (lhs->class_name() == "UnaryExpression") {
+	else if (lhs->Kind() == NodeKind::UnaryExpression) {
 		auto& unExpr = static_cast<UnaryExpression&>(*lhs);
-		auto result = generate_unary_expression(unExpr, function);
+		auto result = take_lowered(unExpr);
 
-		if (rhs->class_name() == "Identifier") {
+		if (rhs->Kind() == NodeKind::Identifier) {
 			auto ident = static_cast<const Identifier&>(*rhs);
-			auto variable = function.FindVariableByIdentifier(ident.Name());
+			auto variable = function.FindVariableByIdentifier(ident);
 			MUST(variable);
 
-			LoadInst loadRhs{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-							  .Ptr = variable,
-							  .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-			auto temporary = std::make_shared<Variable>(
-				Variable{ .Name = function.GetNewUnnamedTemporary(),
-						  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-						  .Allocation = loadRhs,
-						  .IsTemporary = true });
-			function.AppendInstruction(*temporary);
-			auto instructionTemp = instruction(result.value(), temporary);
-			return instructionTemp;
-		}
-		else if (rhs->class_name() == "NumberLiteral") {
-			auto value = IR::NumberLiteralToValue(static_cast<const NumberLiteral&>(*rhs), result.value()->Size());
-			auto instructionTemp = instruction(result.value(), value);
+			auto temporary = function.NewLoad(*variable);
+			function.AppendInstruction(temporary);
+			auto instructionTemp = instruction(result, temporary);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "BinaryExpression") {
-			auto rhsValue = generate_binary_expression(static_cast<BinaryExpression&>(*rhs), function);
-			MUST(rhsValue.has_value());
-			auto instructionTemp = instruction(result.value(), rhsValue.value());
+		else if (rhs->Kind() == NodeKind::NumberLiteral) {
+			auto value =
+				IR::NumberLiteralToValue(static_cast<const NumberLiteral&>(*rhs), function.SizeOf(result), function);
+			auto instructionTemp = instruction(result, value);
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "UnaryExpression") {
-			auto rhsValue = generate_unary_expression(static_cast<UnaryExpression&>(*rhs), function);
-			MUST(rhsValue.has_value());
-			auto instructionTemp = instruction(result.value(), rhsValue.value());
+		else if (rhs->Kind() == NodeKind::BinaryExpression || rhs->Kind() == NodeKind::UnaryExpression) {
+			auto instructionTemp = instruction(result, take_lowered(*rhs));
 			return instructionTemp;
 		}
-		else if (rhs->class_name() == "MemberExpression") {
+		else if (rhs->Kind() == NodeKind::MemberExpression) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
-		else if (rhs->class_name() == "StringLiteral") {
+		else if (rhs->Kind() == NodeKind::StringLiteral) {
 			ASSERT_NOT_IMPLEMENTED();
 		}
 		println(Colour::Red, "Unknown rhs expression type: {;255;255;255}", rhs->class_name());
 	}
-	else if (lhs->class_name() == "MemberExpression") {
+	else if (lhs->Kind() == NodeKind::MemberExpression) {
 		ASSERT_NOT_IMPLEMENTED();
 	}
-	else if (lhs->class_name() == "StringLiteral") {
+	else if (lhs->Kind() == NodeKind::StringLiteral) {
 		ASSERT_NOT_IMPLEMENTED();
 	}
 	else {
@@ -376,8 +293,7 @@ std::optional<std::shared_ptr<Variable>> IR::generate_binary_op(const BinaryExpr
 	ASSERT_NOT_REACHABLE();
 }
 
-std::optional<Values> IR::generate_binary_expression(const BinaryExpression& binaryExpression, // NOLINT(*-no-recursion)
-													 Function& function)
+std::optional<Values> IR::generate_binary_operator(const BinaryExpression& binaryExpression, Function& function)
 {
 	switch (binaryExpression.Operator()) {
 	case TokenType::T_EQ:
@@ -385,34 +301,34 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 	case TokenType::T_PLUS:
 		return generate_binary_op(binaryExpression, function, [&function](const Values& variable, const Values& value) {
 			AddInst add{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_MINUS:
 		return generate_binary_op(binaryExpression, function, [&function](const Values& variable, const Values& value) {
 			SubInst add{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_STAR:
 		return generate_binary_op(binaryExpression, function, [&function](const Values& variable, const Values& value) {
 			MulInst add{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_FWD_SLASH:
 		return generate_binary_op(binaryExpression, function, [&function](const Values& variable, const Values& value) {
 			// FIXME: Check whether we need to use sdiv or udiv
 			SDivInst add{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_POW:
@@ -422,9 +338,9 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::SLT };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_GT:
@@ -432,9 +348,9 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::SGT };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_LTE:
@@ -442,9 +358,9 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::SLE };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_GTE:
@@ -452,9 +368,9 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::SGE };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_EQEQ:
@@ -462,9 +378,9 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::EQ };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_MOD:
@@ -476,75 +392,79 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 			// FIXME: Check whether we need to use icmp or fcmp
 			// FIXME: Check whether we need to use slt or ult
 			ICmpInst cmp{ .Lhs = variable, .Rhs = value, .Predicate = CmpPredicate::NE };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-			function.AppendInstruction(*instructionTemp);
+			function.AppendInstruction(instructionTemp);
 			return instructionTemp;
 		});
 	case TokenType::T_ADD_EQ: {
-		MUST(binaryExpression.Lhs()->class_name() == "Identifier");
+		MUST(binaryExpression.Lhs()->Kind() == NodeKind::Identifier);
 		auto lhsIdent = static_cast<const Identifier&>(*binaryExpression.Lhs());
-		auto lhsVar = function.FindVariableByIdentifier(lhsIdent.Name());
+		auto lhsVar = function.FindVariableByIdentifier(lhsIdent);
+		MUST(lhsVar);
 		return generate_binary_op(
 			binaryExpression, function, [&lhsVar, &function](const Values& variable, const Values& value) {
 			AddInst add{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
 			StoreInst store{ .Value = instructionTemp,
-							 .Ptr = lhsVar,
-							 .Alignment = { std::get<AllocaInst>(lhsVar->Allocation).Size() } };
-			function.AppendInstruction(*instructionTemp);
+							 .Ptr = *lhsVar,
+							 .Alignment = { function.SizeOf(*lhsVar) } };
+			function.AppendInstruction(instructionTemp);
 			function.AppendInstruction(store);
 			return instructionTemp;
 		});
 	}
 	case TokenType::T_SUB_EQ: {
-		MUST(binaryExpression.Lhs()->class_name() == "Identifier");
+		MUST(binaryExpression.Lhs()->Kind() == NodeKind::Identifier);
 		auto lhsIdent = static_cast<const Identifier&>(*binaryExpression.Lhs());
-		auto lhsVar = function.FindVariableByIdentifier(lhsIdent.Name());
+		auto lhsVar = function.FindVariableByIdentifier(lhsIdent);
+		MUST(lhsVar);
 		return generate_binary_op(
 			binaryExpression, function, [&lhsVar, &function](const Values& variable, const Values& value) {
 			SubInst sub{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = sub, .IsTemporary = true });
 			StoreInst store{ .Value = instructionTemp,
-							 .Ptr = lhsVar,
-							 .Alignment = { std::get<AllocaInst>(lhsVar->Allocation).Size() } };
-			function.AppendInstruction(*instructionTemp);
+							 .Ptr = *lhsVar,
+							 .Alignment = { function.SizeOf(*lhsVar) } };
+			function.AppendInstruction(instructionTemp);
 			function.AppendInstruction(store);
 			return instructionTemp;
 		});
 	}
 	case TokenType::T_MULT_EQ: {
-		MUST(binaryExpression.Lhs()->class_name() == "Identifier");
+		MUST(binaryExpression.Lhs()->Kind() == NodeKind::Identifier);
 		auto lhsIdent = static_cast<const Identifier&>(*binaryExpression.Lhs());
-		auto lhsVar = function.FindVariableByIdentifier(lhsIdent.Name());
+		auto lhsVar = function.FindVariableByIdentifier(lhsIdent);
+		MUST(lhsVar);
 		return generate_binary_op(
 			binaryExpression, function, [&lhsVar, &function](const Values& variable, const Values& value) {
 			MulInst mul{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = mul, .IsTemporary = true });
 			StoreInst store{ .Value = instructionTemp,
-							 .Ptr = lhsVar,
-							 .Alignment = { std::get<AllocaInst>(lhsVar->Allocation).Size() } };
-			function.AppendInstruction(*instructionTemp);
+							 .Ptr = *lhsVar,
+							 .Alignment = { function.SizeOf(*lhsVar) } };
+			function.AppendInstruction(instructionTemp);
 			function.AppendInstruction(store);
 			return instructionTemp;
 		});
 	}
 	case TokenType::T_DIV_EQ: {
-		MUST(binaryExpression.Lhs()->class_name() == "Identifier");
+		MUST(binaryExpression.Lhs()->Kind() == NodeKind::Identifier);
 		auto lhsIdent = static_cast<const Identifier&>(*binaryExpression.Lhs());
-		auto lhsVar = function.FindVariableByIdentifier(lhsIdent.Name());
+		auto lhsVar = function.FindVariableByIdentifier(lhsIdent);
+		MUST(lhsVar);
 		return generate_binary_op(
 			binaryExpression, function, [&lhsVar, &function](const Values& variable, const Values& value) {
 			SDivInst div{ .Lhs = variable, .Rhs = value };
-			auto instructionTemp = std::make_shared<Variable>(
+			auto instructionTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = div, .IsTemporary = true });
 			StoreInst store{ .Value = instructionTemp,
-							 .Ptr = lhsVar,
-							 .Alignment = { std::get<AllocaInst>(lhsVar->Allocation).Size() } };
-			function.AppendInstruction(*instructionTemp);
+							 .Ptr = *lhsVar,
+							 .Alignment = { function.SizeOf(*lhsVar) } };
+			function.AppendInstruction(instructionTemp);
 			function.AppendInstruction(store);
 			return instructionTemp;
 		});
@@ -561,4 +481,63 @@ std::optional<Values> IR::generate_binary_expression(const BinaryExpression& bin
 	ASSERT_NOT_REACHABLE();
 }
 
+std::optional<Values> IR::generate_binary_expression(const BinaryExpression& binaryExpression, Function& function)
+{
+	return generate_expression(binaryExpression, function);
+}
+
+std::optional<Values> IR::generate_expression(const Expression& expression, Function& function)
+{
+	// Operands whose values have to be computed by instructions of their own, as opposed to loaded or known
+	const auto lowered = [](const Expression& operand) {
+		return operand.Kind() == NodeKind::UnaryExpression
+			   || (operand.Kind() == NodeKind::BinaryExpression
+				   && !static_cast<const BinaryExpression&>(operand).Constexpr());
+	};
+	m_lowered.clear();
+	walkPostOrder(
+		&expression,
+		[&lowered](const Expression* node, auto push) {
+			if (node->Kind() == NodeKind::BinaryExpression) {
+				const auto& binaryExpression = static_cast<const BinaryExpression&>(*node);
+				// What's assigned to is a variable, not a value
+				if (binaryExpression.Operator() != TokenType::T_EQ && lowered(*binaryExpression.Lhs()))
+					push(binaryExpression.Lhs());
+				if (lowered(*binaryExpression.Rhs()))
+					push(binaryExpression.Rhs());
+			}
+			else if (node->Kind() == NodeKind::UnaryExpression) {
+				const auto& unaryExpression = static_cast<const UnaryExpression&>(*node);
+				if (lowered(*unaryExpression.Rhs()))
+					push(unaryExpression.Rhs());
+			}
+		},
+		[this, &function](const Expression* node) {
+			std::optional<Values> value;
+			if (node->Kind() == NodeKind::BinaryExpression)
+				value = generate_binary_operator(static_cast<const BinaryExpression&>(*node), function);
+			else if (auto variable = generate_unary_operator(static_cast<const UnaryExpression&>(*node), function))
+				value = *variable;
+			if (value)
+				m_lowered.insert_or_assign(node, *value);
+		});
+	std::optional<Values> result;
+	if (has_lowered(expression))
+		result = take_lowered(expression);
+	m_lowered.clear();
+	return result;
+}
+
+bool IR::has_lowered(const Expression& expression) const
+{
+	return m_lowered.contains(&expression);
+}
+
+Values IR::take_lowered(const Expression& expression)
+{
+	auto node = m_lowered.extract(&expression);
+	MUST(!node.empty() && "Operand wasn't lowered before the expression using it");
+	return std::move(node.mapped());
+}
+
 } // namespace alx::ir
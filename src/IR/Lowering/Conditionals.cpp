@@ -12,27 +12,41 @@ namespace alx::ir {
 
 void IR::generate_if_statement(IfStatement& statement, Function& function)
 {
+	// An else if chain is lowered a link at a time rather than recursively, however long it is. Each link that goes on
+	// to another leaves its if.end block open, and they're closed innermost first once the last link is lowered.
+	std::vector<LogicalBlock> openEnds;
+	for (auto* link = &statement; link;)
+		link = generate_if_link(*link, function, openEnds);
+	for (auto end = openEnds.rbegin(); end != openEnds.rend(); ++end) {
+		function.AppendInstruction(BranchInst{ .TrueLabel = end->Label });
+		function.AppendBlock(*end);
+	}
+}
 
-	if (statement.Condition()->class_name() == "BinaryExpression"
-		|| statement.Condition()->class_name() == "UnaryExpression")
+IfStatement* IR::generate_if_link(IfStatement& statement, Function& function, std::vector<LogicalBlock>& openEnds)
+{
+
+	if (statement.Condition()->Kind() == NodeKind::BinaryExpression
+		|| statement.Condition()->Kind() == NodeKind::UnaryExpression)
 	{
-		LogicalBlock ifThen{ { function.GetNewNamedTemporary("if.then") } };
-		LogicalBlock ifEnd{ { function.GetNewNamedTemporary("if.end") } };
-		LogicalBlock ifElse =
-			statement.HasAlternate() ? LogicalBlock{ { function.GetNewNamedTemporary("if.else") } } : ifEnd;
+		LogicalBlock ifThen{ { function.GetNewNamedTemporary(*m_interner, m_if_then) } };
+		LogicalBlock ifEnd{ { function.GetNewNamedTemporary(*m_interner, m_if_end) } };
+		LogicalBlock ifElse = statement.HasAlternate()
+			? LogicalBlock{ { function.GetNewNamedTemporary(*m_interner, m_if_else) } }
+			: ifEnd;
 
 		std::optional<Values> condition;
-		if (statement.Condition()->class_name() == "BinaryExpression")
+		if (statement.Condition()->Kind() == NodeKind::BinaryExpression)
 			condition = generate_binary_expression(static_cast<BinaryExpression&>(*statement.Condition()), function);
-		else if (statement.Condition()->class_name() == "UnaryExpression") {
+		else if (statement.Condition()->Kind() == NodeKind::UnaryExpression) {
 			condition = generate_unary_expression(static_cast<UnaryExpression&>(*statement.Condition()), function);
 			// FIXME: use fcmp for floating point
 			// FIXME: use unsigned compares for unsigned types
 			ICmpInst icmpInst{ .Lhs = condition.value(),
-							   .Rhs = Constant{ .Type = IntType{ 4 }, .Value = 0 },
+							   .Rhs = function.MakeConstant(Constant{ .Type = IntType{ 4 }, .Value = 0 }),
 							   .Predicate = CmpPredicate::NE };
 			Variable icmpTemp{ .Name = function.GetNewUnnamedTemporary(),
-							   .Attributes = { AlignAttribute{ 4 } },
+							   .Alignment = AlignAttribute{ 4 },
 							   .Allocation = icmpInst,
 							   .IsTemporary = true };
 			function.AppendInstruction(icmpTemp);
@@ -56,54 +70,48 @@ void IR::generate_if_statement(IfStatement& statement, Function& function)
 		// Else
 		if (statement.HasAlternate()) {
 			function.AppendBlock(ifElse);
-			if (statement.Alternate().value()->class_name() == "IfStatement")
-				generate_if_statement(static_cast<IfStatement&>(*statement.Alternate().value()), function);
-			else
-				generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
+			if (statement.Alternate().value()->Kind() == NodeKind::IfStatement) {
+				openEnds.push_back(ifEnd);
+				return static_cast<IfStatement*>(statement.Alternate().value());
+			}
+			generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
 			function.AppendInstruction(endBranch);
 		}
 		function.AppendBlock(ifEnd);
-		return;
+		return nullptr;
 	}
-	else if (statement.Condition()->class_name() == "NumberLiteral") {
+	else if (statement.Condition()->Kind() == NodeKind::NumberLiteral) {
 		auto& condNum = static_cast<NumberLiteral&>(*statement.Condition());
 		if (condNum.AsInt()) {
 			generate_body(statement.Body(), function);
-			return;
+			return nullptr;
 		}
 		else {
 			if (statement.HasAlternate()) {
-				if (statement.Alternate().value()->class_name() == "IfStatement")
-					generate_if_statement(static_cast<IfStatement&>(*statement.Alternate().value()), function);
-				else
-					generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
+				if (statement.Alternate().value()->Kind() == NodeKind::IfStatement)
+					return static_cast<IfStatement*>(statement.Alternate().value());
+				generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
 			}
-			return;
+			return nullptr;
 		}
 	}
-	else if (statement.Condition()->class_name() == "Identifier") {
+	else if (statement.Condition()->Kind() == NodeKind::Identifier) {
 		const auto& ident = static_cast<Identifier&>(*statement.Condition());
-		const auto& variable = function.FindVariableByIdentifier(ident.Name());
-
-		LogicalBlock ifThen{ { function.GetNewNamedTemporary("if.then") } };
-		LogicalBlock ifElse{ { function.GetNewNamedTemporary("if.else") } };
-		LogicalBlock ifEnd{ { function.GetNewNamedTemporary("if.end") } };
-
-		LoadInst load{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-					   .Ptr = variable,
-					   .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-		auto loadTemp = std::make_shared<Variable>(
-			Variable{ .Name = function.GetNewUnnamedTemporary(),
-					  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-					  .Allocation = load,
-					  .IsTemporary = true });
+		const auto variable = function.FindVariableByIdentifier(ident);
+		MUST(variable);
+
+		LogicalBlock ifThen{ { function.GetNewNamedTemporary(*m_interner, m_if_then) } };
+		LogicalBlock ifElse{ { function.GetNewNamedTemporary(*m_interner, m_if_else) } };
+		LogicalBlock ifEnd{ { function.GetNewNamedTemporary(*m_interner, m_if_end) } };
+
+		auto loadTemp = function.NewLoad(*variable);
 		ICmpInst icmpInst{ .Lhs = loadTemp,
-						   .Rhs = Constant{ .Type = IntType{ 1 }, .Value = 0 },
+						   .Rhs = function.MakeConstant(Constant{ .Type = IntType{ 1 }, .Value = 0 }),
 						   .Predicate = CmpPredicate::NE };
-		auto icmpTemp = std::make_shared<Variable>(
+		auto icmpTemp = function.NewVariable(
 			Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = icmpInst, .IsTemporary = true });
-		function.AppendInstruction(*loadTemp);
-		function.AppendInstruction(*icmpTemp);
+		function.AppendInstruction(loadTemp);
+		function.AppendInstruction(icmpTemp);
 		BranchInst branchInst{ .Condition = icmpTemp,
 							   .TrueLabel = ifThen.Label,
 							   .FalseLabel = statement.HasAlternate() ? ifElse.Label : ifEnd.Label };
@@ -117,21 +125,22 @@ void IR::generate_if_statement(IfStatement& statement, Function& function)
 		if (statement.HasAlternate()) {
 			function.AppendInstruction(BranchInst{ .TrueLabel = ifEnd.Label });
 			function.AppendBlock(ifElse);
-			if (statement.Alternate().value()->class_name() == "IfStatement")
-				generate_if_statement(static_cast<IfStatement&>(*statement.Alternate().value()), function);
-			else
-				generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
+			if (statement.Alternate().value()->Kind() == NodeKind::IfStatement) {
+				openEnds.push_back(ifEnd);
+				return static_cast<IfStatement*>(statement.Alternate().value());
+			}
+			generate_body(static_cast<BlockStatement&>(*statement.Alternate().value()), function);
 		}
 
 		BranchInst endBranch{ .TrueLabel = ifEnd.Label };
 		function.AppendInstruction(endBranch);
 		
 		function.AppendBlock(ifEnd);
-		return;
+		return nullptr;
 	}
 	else {
 		ASSERT_NOT_IMPLEMENTED_MSG(getFormatted("Unknown condition type: {}", statement.Condition()->class_name()));
-		return;
+		return nullptr;
 	}
 	ASSERT_NOT_REACHABLE();
 }
@@ -140,29 +149,23 @@ void IR::generate_if_statement(IfStatement& statement, Function& function)
 void IR::generate_while_statement(WhileStatement& statement, Function& function)
 {
 
-	if (statement.Condition()->class_name() == "BinaryExpression"
-		|| statement.Condition()->class_name() == "UnaryExpression")
+	if (statement.Condition()->Kind() == NodeKind::BinaryExpression
+		|| statement.Condition()->Kind() == NodeKind::UnaryExpression)
 	{
 
 		std::optional<Values> condition;
 
 		bool isAlwaysTrue = false;
 		bool isNeverTrue = false;
-		if (statement.Condition()->class_name() == "BinaryExpression") {
-			const auto& binExp = static_cast<const BinaryExpression&>(*statement.Condition());
-			if (binExp.Constexpr()) {
-				isAlwaysTrue = binExp.Evaluate()->AsBoolNum();
-				isNeverTrue = !isAlwaysTrue;
-			}
-		}
-		else if (statement.Condition()->class_name() == "UnaryExpression") {
-			// FIXME: check if unary is constexpr
+		if (const auto constant = constantValueOf(*statement.Condition())) {
+			isAlwaysTrue = constant->AsBool();
+			isNeverTrue = !isAlwaysTrue;
 		}
 
 		if (isNeverTrue)
 			return;
 
-		LogicalBlock whileBody{ { function.GetNewNamedTemporary("while.body") } };
+		LogicalBlock whileBody{ { function.GetNewNamedTemporary(*m_interner, m_while_body) } };
 		if (isAlwaysTrue) {
 			auto bodyBranch = BranchInst{ .TrueLabel = whileBody.Label };
 			function.AppendInstruction(bodyBranch);
@@ -174,16 +177,16 @@ void IR::generate_while_statement(WhileStatement& statement, Function& function)
 		}
 
 
-		LogicalBlock whileCond{ { function.GetNewNamedTemporary("while.cond") } };
-		LogicalBlock whileEnd{ { function.GetNewNamedTemporary("while.end") } };
+		LogicalBlock whileCond{ { function.GetNewNamedTemporary(*m_interner, m_while_cond) } };
+		LogicalBlock whileEnd{ { function.GetNewNamedTemporary(*m_interner, m_while_end) } };
 		BranchInst condBranch{ .TrueLabel = whileCond.Label };
 		function.AppendInstruction(condBranch);
 
 		function.AppendBlock(whileCond);
 
-		if (statement.Condition()->class_name() == "BinaryExpression")
+		if (statement.Condition()->Kind() == NodeKind::BinaryExpression)
 			condition = generate_binary_expression(static_cast<BinaryExpression&>(*statement.Condition()), function);
-		else if (statement.Condition()->class_name() == "UnaryExpression")
+		else if (statement.Condition()->Kind() == NodeKind::UnaryExpression)
 			condition = generate_unary_expression(static_cast<UnaryExpression&>(*statement.Condition()), function);
 
 
@@ -200,10 +203,10 @@ void IR::generate_while_statement(WhileStatement& statement, Function& function)
 		function.AppendBlock(whileEnd);
 		return;
 	}
-	else if (statement.Condition()->class_name() == "NumberLiteral") {
+	else if (statement.Condition()->Kind() == NodeKind::NumberLiteral) {
 		auto& condNum = static_cast<NumberLiteral&>(*statement.Condition());
 		if (condNum.AsBoolNum()) {
-			LogicalBlock whileBody{ { function.GetNewNamedTemporary("while.body") } };
+			LogicalBlock whileBody{ { function.GetNewNamedTemporary(*m_interner, m_while_body) } };
 			auto bodyBranch = BranchInst{ .TrueLabel = whileBody.Label };
 			function.AppendInstruction(bodyBranch);
 			function.AppendBlock(whileBody);
@@ -216,32 +219,26 @@ void IR::generate_while_statement(WhileStatement& statement, Function& function)
 			return;
 		}
 	}
-	else if (statement.Condition()->class_name() == "Identifier") {
+	else if (statement.Condition()->Kind() == NodeKind::Identifier) {
 		const auto& ident = static_cast<const Identifier&>(*statement.Condition());
-		const auto& variable = function.FindVariableByIdentifier(ident.Name());
-		LogicalBlock whileBody{ { function.GetNewNamedTemporary("while.body") } };
-		LogicalBlock whileCond{ { function.GetNewNamedTemporary("while.cond") } };
-		LogicalBlock whileEnd{ { function.GetNewNamedTemporary("while.end") } };
+		const auto variable = function.FindVariableByIdentifier(ident);
+		MUST(variable);
+		LogicalBlock whileBody{ { function.GetNewNamedTemporary(*m_interner, m_while_body) } };
+		LogicalBlock whileCond{ { function.GetNewNamedTemporary(*m_interner, m_while_cond) } };
+		LogicalBlock whileEnd{ { function.GetNewNamedTemporary(*m_interner, m_while_end) } };
 
 		BranchInst condBranch{ .TrueLabel = whileCond.Label };
 		function.AppendInstruction(condBranch);
 
 		function.AppendBlock(whileCond);
-		LoadInst load{ .Type = *(std::get<AllocaInst>(variable->Allocation).Type),
-					   .Ptr = variable,
-					   .Alignment = { std::get<AllocaInst>(variable->Allocation).Size() } };
-		auto loadTemp = std::make_shared<Variable>(
-			Variable{ .Name = function.GetNewUnnamedTemporary(),
-					  .Attributes = { AlignAttribute{ std::get<AllocaInst>(variable->Allocation).Size() } },
-					  .Allocation = load,
-					  .IsTemporary = true });
+		auto loadTemp = function.NewLoad(*variable);
 		ICmpInst cmp{ .Lhs = loadTemp,
-					  .Rhs = Constant{ .Type = IntType{ 1 }, .Value = 0 },
+					  .Rhs = function.MakeConstant(Constant{ .Type = IntType{ 1 }, .Value = 0 }),
 					  .Predicate = CmpPredicate::NE };
-		auto icmpTemp = std::make_shared<Variable>(
+		auto icmpTemp = function.NewVariable(
 			Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = cmp, .IsTemporary = true });
-		function.AppendInstruction(*loadTemp);
-		function.AppendInstruction(*icmpTemp);
+		function.AppendInstruction(loadTemp);
+		function.AppendInstruction(icmpTemp);
 		BranchInst bodyBranch{ .Condition = icmpTemp, .TrueLabel = whileBody.Label, .FalseLabel = whileEnd.Label };
 		function.AppendInstruction(bodyBranch);
 
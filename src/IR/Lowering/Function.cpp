@@ -9,33 +9,85 @@
 #include "../Ir.h"
 
 namespace alx::ir {
-std::shared_ptr<Variable> Function::FindVariableByIdentifier(const std::string& name)
+std::optional<Values> Function::FindVariableByIdentifier(const alx::Identifier& identifier)
 {
-	std::shared_ptr<Variable> variable;
-	if (std::find_if(Blocks.begin(), Blocks.end(), [&name, &variable](LogicalBlock& block) {
-		const auto& identifiers = block.Identifiers();
-		auto it = identifiers.find(name);
-		if (it != identifiers.end()) {
-			variable = (it)->second;
-			return true;
-		}
-		return false;
-	}) == Blocks.end())
-	{
-		println(Colour::Red, "Could not find variable {} in any of the blocks", name);
-		return nullptr;
+	auto it = DeclaredVariables.find(identifier.Symbol());
+	if (it == DeclaredVariables.end()) {
+		println(Colour::Red, "Could not find variable {} in any of the blocks", identifier.Name());
+		return {};
 	}
-	return variable;
+	return it->second.Allocation;
+}
+
+void Function::declare(SymbolId symbol, Values variable)
+{
+	// A name declared in more than one block is found in the first of them, and a name declared again in the same
+	// block as its latest declaration there
+	const auto block = Blocks.size() - 1;
+	auto [it, inserted] = DeclaredVariables.try_emplace(symbol, DeclaredVariable{ block, variable });
+	if (!inserted && it->second.Block == block)
+		it->second.Allocation = variable;
+}
+
+Values Function::NewLoad(Values ptr)
+{
+	const auto& alloca = std::get<AllocaInst>(VariableOf(ptr).Allocation);
+	LoadInst load{ .Type = alloca.Type, .Ptr = ptr, .Alignment = { alloca.Size } };
+	return NewVariable(Variable{ .Name = GetNewUnnamedTemporary(),
+								 .Alignment = load.Alignment,
+								 .Allocation = load,
+								 .IsTemporary = true });
+}
+
+Values Function::MakeConstant(const Constant& constant)
+{
+	auto [it, inserted] = ConstantIds.try_emplace(constant.KeyOf(), static_cast<uint32_t>(Constants.size()));
+	if (inserted)
+		Constants.push_back(constant);
+	return Values::OfConstant(it->second);
+}
+
+TypeId Function::InternType(const Types& type)
+{
+	// Functions use a handful of types at most, so they're not worth hashing
+	for (TypeId id = 0; id < TypePool.size(); ++id)
+		if (sameType(TypePool[id], type))
+			return id;
+	TypePool.push_back(type);
+	return static_cast<TypeId>(TypePool.size() - 1);
+}
+
+size_t Function::SizeOf(Values value) const
+{
+	// An arithmetic result is the size of its lhs, which can be another result, so follow them along to what's loaded
+	while (!value.IsConstant()) {
+		const auto& allocation = VariableOf(value).Allocation;
+		if (const auto* alloca = std::get_if<AllocaInst>(&allocation))
+			return alloca->Size;
+		if (const auto* load = std::get_if<LoadInst>(&allocation))
+			return load->Alignment.Alignment;
+		if (const auto* phi = std::get_if<PhiInst>(&allocation))
+			return sizeOfType(TypeOf(phi->Type));
+		value = std::visit(
+			[](const auto& inst) -> Values {
+				if constexpr (requires { inst.Lhs; })
+					return inst.Lhs;
+				else
+					ASSERT_NOT_REACHABLE();
+			},
+			allocation);
+	}
+	return ConstantOf(value).Size();
 }
 
 [[maybe_unused]] LogicalBlock& Function::GetBlockByLabel(const std::string& label)
 {
-	auto it = std::find_if(
-		Blocks.begin(), Blocks.end(), [&label](const LogicalBlock& block) { return block.Label.Name == label; });
-	if (it == Blocks.end()) {
+	auto it = BlockIndices.find(label);
+	if (it == BlockIndices.end()) {
 		println(Colour::Red, "Could not find block with label {}", label);
+		ASSERT_NOT_REACHABLE();
 	}
-	return *it;
+	return Blocks[it->second];
 }
 
 [[maybe_unused]] void IR::generate_func_parameters([[maybe_unused]] FunctionDeclaration& functionDeclaration,
@@ -46,33 +98,28 @@ std::shared_ptr<Variable> Function::FindVariableByIdentifier(const std::string&
 void IR::generate_body(const BlockStatement& block, Function& function)
 {
 	for (const auto& node : block.Children()) {
-		if (node->class_name() == "ReturnStatement") {
+		switch (node->Kind()) {
+		case NodeKind::ReturnStatement:
 			generate_return_statement(static_cast<ReturnStatement&>(*node), function);
-		}
-		else if (node->class_name() == "VariableDeclaration") {
-			auto& varDecl = static_cast<VariableDeclaration&>(*node);
-			generate_variable(varDecl, function);
-		}
-		else if (node->class_name() == "BinaryExpression") {
-			auto& binExpr = static_cast<BinaryExpression&>(*node);
-			MUST(generate_binary_expression(binExpr, function).has_value());
-			// if (std::holds_alternative<std::shared_ptr<Variable>>(result.value()))
-			// function.Blocks.back().Body.emplace_back(*std::get<std::shared_ptr<Variable>>(result.value()));
-		}
-		else if (node->class_name() == "IfStatement") {
-			auto& ifStmt = static_cast<IfStatement&>(*node);
-			generate_if_statement(ifStmt, function);
-		}
-		else if (node->class_name() == "WhileStatement") {
-			auto& whileStmt = static_cast<WhileStatement&>(*node);
-			generate_while_statement(whileStmt, function);
-		}
-		else if (node->class_name() == "UnaryExpression") {
-			auto& unaryExpr = static_cast<UnaryExpression&>(*node);
-			MUST(generate_unary_expression(unaryExpr, function).has_value());
-		}
-		else
+			break;
+		case NodeKind::VariableDeclaration:
+			generate_variable(static_cast<VariableDeclaration&>(*node), function);
+			break;
+		case NodeKind::BinaryExpression:
+			MUST(generate_binary_expression(static_cast<BinaryExpression&>(*node), function).has_value());
+			break;
+		case NodeKind::IfStatement:
+			generate_if_statement(static_cast<IfStatement&>(*node), function);
+			break;
+		case NodeKind::WhileStatement:
+			generate_while_statement(static_cast<WhileStatement&>(*node), function);
+			break;
+		case NodeKind::UnaryExpression:
+			MUST(generate_unary_expression(static_cast<UnaryExpression&>(*node), function).has_value());
+			break;
+		default:
 			ASSERT_NOT_IMPLEMENTED_MSG(getFormatted("Unknown node type: {}", node->class_name()));
+		}
 	}
 	function.ResolveReturnSentinels();
 }
@@ -83,7 +130,7 @@ void IR::generate_function(FunctionDeclaration& functionDeclaration)
 	auto type = functionDeclaration.ReturnType();
 
 	// Resolve function name
-	auto identifier = functionDeclaration.Name() + "(";
+	auto identifier = std::string(functionDeclaration.Name()) + "(";
 	auto sep = "";
 	std::vector<FunctionParameter> parameters;
 	for (const auto& arg : functionDeclaration.Arguments()) {
@@ -91,13 +138,13 @@ void IR::generate_function(FunctionDeclaration& functionDeclaration)
 		sep = ", ";
 
 		const auto& argType = arg->Type();
-		const bool isIdent = std::holds_alternative<std::unique_ptr<Identifier>>(argType);
+		const bool isIdent = std::holds_alternative<Identifier*>(argType);
 		FunctionParameter param{
 			.Visibility = VisibilityAttribute::Local,
-			.Name = arg->Name(),
+			.Name = std::string(arg->Name()),
 		};
 		if (isIdent) {
-			param.Type = StructType{ .Name = std::get<std::unique_ptr<alx::Identifier>>(argType)->Name(),
+			param.Type = StructType{ .Name = std::string(std::get<alx::Identifier*>(argType)->Name()),
 									 .Visibility = VisibilityAttribute::Local };
 			param.Attributes.emplace_back(ParamAttributes::ByVal);
 			param.Attributes.emplace_back(AlignAttribute{ 8 });
@@ -114,7 +161,7 @@ void IR::generate_function(FunctionDeclaration& functionDeclaration)
 														 .Arguments = std::move(parameters) });
 
 	LogicalBlock entry{ { "entry" } };
-	function->Blocks.push_back(entry);
+	function->AppendBlock(entry);
 	generate_func_parameters(functionDeclaration, *function);
 
 	// Generate function body
@@ -13,36 +13,30 @@ namespace alx::ir {
 void Function::ResolveReturnSentinels()
 {
 	if (MultipleReturns) {
-		auto alloca = AllocaInst{ .Type = std::make_shared<Types>(ReturnType) };
-		auto retVal = std::make_shared<Variable>(
-			Variable{ .Name = "retval", .Attributes = { AlignAttribute{ alloca.Size() } }, .Allocation = alloca });
-		Blocks.front().Body.insert(Blocks.front().Body.begin(), *retVal);
+		ControlFlowChanged();
+		const auto size = sizeOfType(ReturnType);
+		auto retVal = NewVariable(Variable{ .Name = "retval",
+											.Alignment = AlignAttribute{ size },
+											.Allocation = AllocaInst{ .Type = InternType(ReturnType), .Size = size } });
+		Blocks.front().Body.insert(Blocks.front().Body.begin(), retVal.Index());
 
 		LogicalBlock ret{ { "return" } };
-		{
-			auto load = LoadInst{ .Type = ReturnType, .Ptr = retVal, .Alignment = { retVal->Size() } };
-			auto temporary = std::make_shared<Variable>(Variable{ .Name = GetNewUnnamedTemporary(),
-																  .Attributes = { load.Alignment },
-																  .Allocation = load,
-																  .IsTemporary = true });
-			auto retInst = ReturnInst{ .Value = temporary };
-			ret.Body.emplace_back(*temporary);
-			ret.Body.emplace_back(retInst);
-		}
-		
+		auto temporary = NewLoad(retVal);
+
 		// Loop over all blocks and replace return instructions with store instructions
 		for (auto& block : Blocks) {
-			for (auto& body : block.Body) {
+			for (size_t i = 0; i < block.Body.size(); ++i) {
+				auto& body = Instructions[block.Body[i]];
 				if (std::holds_alternative<ReturnInst>(body)) {
 					auto& retInst = std::get<ReturnInst>(body);
 					StoreInst store{ .Value = retInst.Value,
 									 .Ptr = retVal,
-									 .Alignment = { retVal->Size() } }; // FIXME: Do the ze, se, etc.
+									 .Alignment = { size } }; // FIXME: Do the ze, se, etc.
 					body = store;
 					bool found = false;
-					for (auto& body2 : block.Body) {
-						if (std::holds_alternative<BranchInst>(body2)) {
-							auto& branchInst = std::get<BranchInst>(body2);
+					for (auto id : block.Body) {
+						if (std::holds_alternative<BranchInst>(Instructions[id])) {
+							auto& branchInst = std::get<BranchInst>(Instructions[id]);
 							if (branchInst.TrueLabel.Name != ret.Label.Name)
 							{
 								branchInst.TrueLabel = ret.Label;
@@ -51,26 +45,26 @@ void Function::ResolveReturnSentinels()
 						}
 					}
 					if (!found) {
-						BranchInst branchInst{ .TrueLabel = ret.Label };
-						block.Body.emplace_back(branchInst);
+						Instructions.emplace_back(BranchInst{ .TrueLabel = ret.Label });
+						block.Body.push_back(static_cast<InstructionId>(Instructions.size() - 1));
 					}
 				}
 			}
 		}
 		AppendBlock(ret);
+		AppendInstruction(temporary);
+		AppendInstruction(ReturnInst{ .Value = temporary });
 	}
 }
 
 void IR::generate_return_statement(const ReturnStatement& astNode, Function& function)
 {
-	LogicalBlock ret{ { "return" } };
-
-	if (astNode.Argument()->class_name() == "NumberLiteral") {
+	if (astNode.Argument()->Kind() == NodeKind::NumberLiteral) {
 		auto& numLit = static_cast<NumberLiteral&>(*astNode.Argument());
 		auto value = numLit;
 		if (isIntegerLiteral(value.Type())) {
 			Constant returnValue{ .Type = IntType{ size_of(value.Type()) }, .Value = value.AsInt() };
-			ret.Body.emplace_back(ReturnInst{ returnValue });
+			function.AppendInstruction(ReturnInst{ function.MakeConstant(returnValue) });
 		}
 		else if (!isIntegerLiteral(value.Type()) && isNumberLiteral(value.Type())) {
 			SingleValueType type;
@@ -79,59 +73,35 @@ void IR::generate_return_statement(const ReturnStatement& astNode, Function& fun
 			else if (value.Type() == TokenType::T_DOUBLE_L)
 				type = SingleValueType::Double;
 			Constant returnValue{ .Type = type, .Value = value.AsDouble() };
-			ret.Body.emplace_back(ReturnInst{ returnValue });
+			function.AppendInstruction(ReturnInst{ function.MakeConstant(returnValue) });
 		}
 		else
 			println(Colour::Red, "Unknown number type: {;255;255;255}", token_to_string(value.Type()));
 	}
-	else if (astNode.Argument()->class_name() == "BinaryExpression") {
+	else if (astNode.Argument()->Kind() == NodeKind::BinaryExpression) {
 		auto& binExpr = static_cast<BinaryExpression&>(*astNode.Argument());
 		if (binExpr.Constexpr()) {
-			auto value = binExpr.Evaluate();
-			if (isIntegerLiteral(value->Type())) {
-				Constant returnValue{ .Type = IntType{ size_of(value->Type()) }, .Value = value->AsInt() };
-				ret.Body.emplace_back(ReturnInst{ returnValue });
-			}
-			else if (!isIntegerLiteral(value->Type()) && isNumberLiteral(value->Type())) {
-				SingleValueType type;
-				if (value->Type() == TokenType::T_FLOAT_L)
-					type = SingleValueType::Float;
-				else if (value->Type() == TokenType::T_DOUBLE_L)
-					type = SingleValueType::Double;
-
-				Constant returnValue{ .Type = type, .Value = value->AsDouble() };
-				ret.Body.emplace_back(ReturnInst{ returnValue });
-			}
-			else
-				println(Colour::Red, "Unknown number type: {;255;255;255}", token_to_string(value->Type()));
+			const auto& value = binExpr.Evaluate();
+			function.AppendInstruction(ReturnInst{ ConstantToValue(value, size_of(value.Type()), function) });
 		}
 	}
-	else if (astNode.Argument()->class_name() == "Identifier") {
+	else if (astNode.Argument()->Kind() == NodeKind::Identifier) {
 		auto& ident = static_cast<Identifier&>(*astNode.Argument());
-		auto rhsVariable = function.FindVariableByIdentifier(ident.Name());
+		auto rhsVariable = function.FindVariableByIdentifier(ident);
 		MUST(rhsVariable);
-		LoadInst load{ .Type = *(std::get<AllocaInst>(rhsVariable->Allocation).Type),
-					   .Ptr = rhsVariable,
-					   .Alignment = { std::get<AllocaInst>(rhsVariable->Allocation).Size() } };
-		auto temporary = std::make_shared<Variable>(
-			Variable{ .Name = function.GetNewUnnamedTemporary(),
-					  .Attributes = { AlignAttribute{ std::get<AllocaInst>(rhsVariable->Allocation).Size() } },
-					  .Allocation = load,
-					  .IsTemporary = true });
-		ret.Body.emplace_back(*temporary);
-		ret.Body.emplace_back(ReturnInst{ temporary });
+		auto temporary = function.NewLoad(*rhsVariable);
+		function.AppendInstruction(temporary);
+		function.AppendInstruction(ReturnInst{ temporary });
 	}
-	else if (astNode.Argument()->class_name() == "UnaryExpression") {
+	else if (astNode.Argument()->Kind() == NodeKind::UnaryExpression) {
 		auto result = generate_unary_expression(static_cast<UnaryExpression&>(*astNode.Argument()), function);
 		MUST(result.has_value());
-		ret.Body.emplace_back(ReturnInst{ result.value() });
+		function.AppendInstruction(ReturnInst{ result.value() });
 	}
 	else {
 		ASSERT_NOT_IMPLEMENTED_MSG(getFormatted("Unknown return type: {}", astNode.Argument()->class_name()));
 	}
 
-	function.Blocks.back().Body.insert(std::end(function.Blocks.back().Body), std::begin(ret.Body), std::end(ret.Body));
-
 	if (function.Returns)
 		function.MultipleReturns = true;
 	function.Returns = true;
@@ -11,131 +11,125 @@
 namespace alx::ir {
 
 template<typename Func>
-std::optional<std::shared_ptr<Variable>> IR::generate_unary_op(const UnaryExpression& unaryExpression,
-															   Function& function,
-															   Func instruction)
+std::optional<Values> IR::generate_unary_op(const UnaryExpression& unaryExpression,
+											Function& function,
+											Func instruction)
 {
 	auto rhs = unaryExpression.Rhs();
 	// FIXME: this should resolve to a negative variable in the parser (e.g. -(1) -> -1)
-	if (rhs->class_name() == "NumberLiteral") {
+	if (rhs->Kind() == NodeKind::NumberLiteral) {
 		fixme("Unary minus on number literal");
 		auto& numLit = static_cast<NumberLiteral&>(*rhs);
-		auto value = IR::NumberLiteralToValue(numLit, size_of(numLit.Type()));
+		auto value = IR::NumberLiteralToValue(numLit, size_of(numLit.Type()), function);
 		auto temp = instruction(value);
 		return temp;
 	}
-	else if (rhs->class_name() == "Identifier") {
+	else if (rhs->Kind() == NodeKind::Identifier) {
 		auto& ident = static_cast<Identifier&>(*rhs);
-		auto rhsVariable = function.FindVariableByIdentifier(ident.Name());
+		auto rhsVariable = function.FindVariableByIdentifier(ident);
 		MUST(rhsVariable);
-		LoadInst load{ .Type = *(std::get<AllocaInst>(rhsVariable->Allocation).Type),
-					   .Ptr = rhsVariable,
-					   .Alignment = { std::get<AllocaInst>(rhsVariable->Allocation).Size() } };
-		auto loadTemp = std::make_shared<Variable>(
-			Variable{ .Name = function.GetNewUnnamedTemporary(),
-					  .Attributes = { AlignAttribute{ std::get<AllocaInst>(rhsVariable->Allocation).Size() } },
-					  .Allocation = load,
-					  .IsTemporary = true });
-		function.AppendInstruction(*loadTemp);
+		auto loadTemp = function.NewLoad(*rhsVariable);
+		function.AppendInstruction(loadTemp);
 		auto temp = instruction(loadTemp);
 		return temp;
 	}
-	else if (rhs->class_name() == "BinaryExpression") {
+	else if (rhs->Kind() == NodeKind::BinaryExpression) {
 		auto& binExpr = static_cast<BinaryExpression&>(*rhs);
 		if (binExpr.Constexpr()) {
 			fixme("Unary minus on number literal");
-			const auto& rhsExpr = static_cast<const BinaryExpression&>(*rhs);
-			auto eval = rhsExpr.Evaluate();
-			auto value = IR::NumberLiteralToValue(*eval, size_of(eval->Type()));
+			const auto& eval = binExpr.Evaluate();
+			auto value = IR::ConstantToValue(eval, size_of(eval.Type()), function);
 			auto temp = instruction(value);
 			return temp;
 		}
 		else {
-			auto result = generate_binary_expression(binExpr, function);
-			MUST(result.has_value());
-			auto temp = instruction(result.value());
+			auto temp = instruction(take_lowered(binExpr));
 			return temp;
 		}
 	}
-	else if (rhs->class_name() == "UnaryExpression") {
-		auto& unExpr = static_cast<UnaryExpression&>(*rhs);
-		auto result = generate_unary_expression(unExpr, function);
-		MUST(result.has_value());
-		auto temp = instruction(result.value());
+	else if (rhs->Kind() == NodeKind::UnaryExpression) {
+		auto temp = instruction(take_lowered(*rhs));
 		return temp;
 	}
-	else if (rhs->class_name() == "MemberExpression")
+	else if (rhs->Kind() == NodeKind::MemberExpression)
 		ASSERT_NOT_IMPLEMENTED(); // NOLINT(*-branch-clone)
-	else if (rhs->class_name() == "StringLiteral")
+	else if (rhs->Kind() == NodeKind::StringLiteral)
 		ASSERT_NOT_IMPLEMENTED();
 	else // Call expression
 		ASSERT_NOT_IMPLEMENTED();
 }
 
-std::optional<std::shared_ptr<Variable>> IR::generate_unary_expression(
-	const UnaryExpression& unaryExpression, // NOLINT(*-no-recursion)
-	Function& function)
+std::optional<Values> IR::generate_unary_expression(const UnaryExpression& unaryExpression, Function& function)
+{
+	return generate_expression(unaryExpression, function);
+}
+
+std::optional<Values> IR::generate_unary_operator(const UnaryExpression& unaryExpression, Function& function)
 {
 	switch (unaryExpression.Operator()) {
 	case TokenType::T_MINUS:
-		return generate_unary_op(unaryExpression, function, [&function](const Values& value) {
+		return generate_unary_op(unaryExpression, function, [&function](Values value) {
 			SubInst sub{
-				.Lhs = Constant{ .Type = IntType{ 4 }, .Value = 0 },
+				.Lhs = function.MakeConstant(Constant{ .Type = IntType{ 4 }, .Value = 0 }),
 				.Rhs = value,
 			};
-			auto subTemp = std::make_shared<Variable>(
+			auto subTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = sub, .IsTemporary = true });
-			function.AppendInstruction(*subTemp);
+			function.AppendInstruction(subTemp);
 			return subTemp;
 		});
 	case TokenType::T_PLUS:
-		return generate_unary_op(unaryExpression, function, [&function](const Values& value) {
-			if (std::holds_alternative<std::shared_ptr<Variable>>(value))
-				return std::get<std::shared_ptr<Variable>>(value);
+		return generate_unary_op(unaryExpression, function, [&function](Values value) {
+			if (!value.IsConstant())
+				return value;
 			AddInst add{
-				.Lhs = Constant{ .Type = IntType{ 4 }, .Value = 0 },
+				.Lhs = function.MakeConstant(Constant{ .Type = IntType{ 4 }, .Value = 0 }),
 				.Rhs = value,
 			};
-			auto addTemp = std::make_shared<Variable>(
+			auto addTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*addTemp);
+			function.AppendInstruction(addTemp);
 			return addTemp;
 		});
 	case TokenType::T_SUB: {
-		MUST(unaryExpression.Rhs()->class_name() == "Identifier"); // FIXME: allow member expressions
-		return generate_unary_op(unaryExpression, function, [&unaryExpression, &function](const Values& value) {
-			MUST(std::holds_alternative<std::shared_ptr<Variable>>(value));
+		MUST(unaryExpression.Rhs()->Kind() == NodeKind::Identifier); // FIXME: allow member expressions
+		return generate_unary_op(unaryExpression, function, [&unaryExpression, &function](Values value) {
+			MUST(!value.IsConstant());
 			SubInst sub{
 				.Lhs = value,
-				.Rhs = Constant{ .Type = IntType{ 4 }, .Value = 1 },
+				.Rhs = function.MakeConstant(Constant{ .Type = IntType{ 4 }, .Value = 1 }),
 			};
-			auto subTemp = std::make_shared<Variable>(
+			auto subTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = sub, .IsTemporary = true });
-			function.AppendInstruction(*subTemp);
+			function.AppendInstruction(subTemp);
 			auto rhsVariable =
-				function.FindVariableByIdentifier(static_cast<const Identifier&>(*unaryExpression.Rhs()).Name());
+				function.FindVariableByIdentifier(static_cast<const Identifier&>(*unaryExpression.Rhs()));
 			MUST(rhsVariable);
-			StoreInst store{ .Value = subTemp, .Ptr = rhsVariable, .Alignment = { rhsVariable->Size() } };
+			StoreInst store{ .Value = subTemp, .Ptr = *rhsVariable, .Alignment = { function.SizeOf(*rhsVariable) } };
 			function.AppendInstruction(store);
+			if (unaryExpression.Postfix())
+				return value;
 			return subTemp;
 		});
 	}
 	case TokenType::T_ADD: {
-		MUST(unaryExpression.Rhs()->class_name() == "Identifier"); // FIXME: allow member expressions
-		return generate_unary_op(unaryExpression, function, [&unaryExpression, &function](const Values& value) {
-			MUST(std::holds_alternative<std::shared_ptr<Variable>>(value));
+		MUST(unaryExpression.Rhs()->Kind() == NodeKind::Identifier); // FIXME: allow member expressions
+		return generate_unary_op(unaryExpression, function, [&unaryExpression, &function](Values value) {
+			MUST(!value.IsConstant());
 			AddInst add{
 				.Lhs = value,
-				.Rhs = Constant{ .Type = IntType{ 4 }, .Value = 1 },
+				.Rhs = function.MakeConstant(Constant{ .Type = IntType{ 4 }, .Value = 1 }),
 			};
-			auto subTemp = std::make_shared<Variable>(
+			auto subTemp = function.NewVariable(
 				Variable{ .Name = function.GetNewUnnamedTemporary(), .Allocation = add, .IsTemporary = true });
-			function.AppendInstruction(*subTemp);
+			function.AppendInstruction(subTemp);
 			auto rhsVariable =
-				function.FindVariableByIdentifier(static_cast<const Identifier&>(*unaryExpression.Rhs()).Name());
+				function.FindVariableByIdentifier(static_cast<const Identifier&>(*unaryExpression.Rhs()));
 			MUST(rhsVariable);
-			StoreInst store{ .Value = subTemp, .Ptr = rhsVariable, .Alignment = { rhsVariable->Size() } };
+			StoreInst store{ .Value = subTemp, .Ptr = *rhsVariable, .Alignment = { function.SizeOf(*rhsVariable) } };
 			function.AppendInstruction(store);
+			if (unaryExpression.Postfix())
+				return value;
 			return subTemp;
 		});
 	}
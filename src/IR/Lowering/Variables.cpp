@@ -11,28 +11,30 @@
 namespace alx::ir {
 void IR::generate_variable(const VariableDeclaration& variable, Function& function)
 {
-	const auto& name = variable.Name();
+	const std::string name(variable.Name());
 
 	if (std::holds_alternative<TokenType>(variable.Type())) // TokenType
 	{
 		TokenType primitive = variable.TypeAsPrimitive();
 		auto size = size_of(primitive);
-		auto identifier = std::make_shared<Variable>(
+		const auto type = IR::TokenTypeToIRType(primitive);
+		auto identifier = function.NewVariable(
 			Variable{ .Name = name,
-					  .Attributes = { AlignAttribute{ size_of(primitive) } },
-					  .Allocation = AllocaInst{ .Type = std::make_unique<Types>(IR::TokenTypeToIRType(primitive)) } });
+					  .Symbol = variable.Symbol(),
+					  .Alignment = AlignAttribute{ size_of(primitive) },
+					  .Allocation = AllocaInst{ .Type = function.InternType(type), .Size = sizeOfType(type) } });
 		// TODO: make sure this doesn't need to be appended after generating the binary expression value
 		//       https://github.com/aelliixx/alxLang/commit/a7d957e601fe3348b0178a096b1da80b33a1a27a
-		function.AppendInstruction(*identifier);
+		function.AppendInstruction(identifier);
 		
 
 		if (variable.Value()) {
-			if (variable.Value()->class_name() == "NumberLiteral") {
+			if (variable.Value()->Kind() == NodeKind::NumberLiteral) {
 				const auto& numLit = static_cast<NumberLiteral&>(*variable.Value());
 				if (isIntegerLiteral(numLit.Type())) {
 					Constant value{ .Type = IntType{ size }, .Value = numLit.AsInt() };
-					StoreInst store{ .Value = value, .Ptr = identifier, .Alignment = { size } };
-					function.Blocks.back().Body.emplace_back(store);
+					StoreInst store{ .Value = function.MakeConstant(value), .Ptr = identifier, .Alignment = { size } };
+					function.AppendInstruction(store);
 				}
 				else if (!isIntegerLiteral(numLit.Type()) && isNumberLiteral(numLit.Type())) {
 					SingleValueType type;
@@ -42,37 +44,30 @@ void IR::generate_variable(const VariableDeclaration& variable, Function& functi
 						type = SingleValueType::Double;
 
 					Constant value{ .Type = type, .Value = numLit.AsDouble() };
-					StoreInst store{ .Value = value, .Ptr = identifier, .Alignment = { size_of(numLit.Type()) } };
-					function.Blocks.back().Body.emplace_back(store);
+					StoreInst store{ .Value = function.MakeConstant(value),
+									 .Ptr = identifier,
+									 .Alignment = { size_of(numLit.Type()) } };
+					function.AppendInstruction(store);
 				}
 				else
 					println(Colour::Red, "Unknown number primitive: {;255;255;255}", token_to_string(numLit.Type()));
 			}
-			else if (variable.Value()->class_name() == "Identifier") {
+			else if (variable.Value()->Kind() == NodeKind::Identifier) {
 
 				auto& ident = static_cast<Identifier&>(*variable.Value());
-				auto rhsVariable = function.FindVariableByIdentifier(ident.Name());
+				auto rhsVariable = function.FindVariableByIdentifier(ident);
 				MUST(rhsVariable);
-				LoadInst load{ .Type = *(std::get<AllocaInst>(rhsVariable->Allocation).Type),
-							   .Ptr = rhsVariable,
-							   .Alignment = { std::get<AllocaInst>(rhsVariable->Allocation).Size() } };
-				auto temporary = std::make_shared<Variable>(
-					Variable{ .Name = function.GetNewUnnamedTemporary(),
-							  .Attributes = { AlignAttribute{ std::get<AllocaInst>(rhsVariable->Allocation).Size() } },
-							  .Allocation = load,
-							  .IsTemporary = true });
+				auto temporary = function.NewLoad(*rhsVariable);
 				StoreInst store{ .Value = temporary, .Ptr = identifier, .Alignment = { size_of(primitive) } };
-				function.Blocks.back().Body.emplace_back(*temporary);
-				function.Blocks.back().Body.emplace_back(store);
+				function.AppendInstruction(temporary);
+				function.AppendInstruction(store);
 			}
-			else if (variable.Value()->class_name() == "BinaryExpression") {
+			else if (variable.Value()->Kind() == NodeKind::BinaryExpression) {
 				auto& binExpr = static_cast<BinaryExpression&>(*variable.Value());
 				if (binExpr.Constexpr()) {
-					const auto& rhsExpr = static_cast<const BinaryExpression&>(*variable.Value());
-					auto eval = rhsExpr.Evaluate();
-					auto value = NumberLiteralToValue(*eval, identifier->Size());
+					auto value = ConstantToValue(binExpr.Evaluate(), function.SizeOf(identifier), function);
 					StoreInst store{ .Value = value, .Ptr = identifier, .Alignment = { size_of(primitive) } };
-					function.Blocks.back().Body.emplace_back(store);
+					function.AppendInstruction(store);
 				}
 				else {
 					auto result = generate_binary_expression(binExpr, function);
@@ -81,11 +76,11 @@ void IR::generate_variable(const VariableDeclaration& variable, Function& functi
 					function.AppendInstruction(store);
 				}
 			}
-			else if (variable.Value()->class_name() == "UnaryExpression") {
+			else if (variable.Value()->Kind() == NodeKind::UnaryExpression) {
 				auto result = generate_unary_expression(static_cast<UnaryExpression&>(*variable.Value()), function);
 				MUST(result.has_value());
 				StoreInst store{ .Value = result.value(), .Ptr = identifier, .Alignment = { size_of(primitive) } };
-				function.Blocks.back().Body.emplace_back(store);
+				function.AppendInstruction(store);
 			}
 			else
 				ASSERT_NOT_IMPLEMENTED_MSG(
@@ -96,19 +91,19 @@ void IR::generate_variable(const VariableDeclaration& variable, Function& functi
 		ASSERT_NOT_IMPLEMENTED_MSG(
 			getFormatted(Colour::Red, "Immediate assignment of struct members is not supported yet"));
 		auto ident = variable.TypeAsIdentifier();
-		auto structDefinition = std::find_if(m_ast.begin(), m_ast.end(), [&](const std::unique_ptr<ASTNode>& node) {
-			return node->class_name() == "StructDeclaration"
-				&& static_cast<StructDeclaration*>(node.get())->Name() == ident->Name();
+		auto structDefinition = std::find_if(m_ast.begin(), m_ast.end(), [&](const ASTNode* node) {
+			return node->Kind() == NodeKind::StructDeclaration
+				&& static_cast<const StructDeclaration*>(node)->Name() == ident->Name();
 		});
 		if (structDefinition == m_ast.end()) {
 			println(Colour::Red, "Unknown struct type: {;255;255;255}", ident->Name());
 			return;
 		}
 		auto size = static_cast<const StructDeclaration&>(**structDefinition).Size();
-		function.Blocks.back().Body.emplace_back(
-			Variable{ .Name = name,
-					  .Attributes = { AlignAttribute{ size } },
-					  .Allocation = AllocaInst{ .Type = std::make_unique<Types>(StructType{ .Name = name }) } });
+		const auto type = function.InternType(StructType{ .Name = name });
+		function.AppendInstruction(Variable{ .Name = name,
+											 .Alignment = AlignAttribute{ size },
+											 .Allocation = AllocaInst{ .Type = type, .Size = size } });
 	}
 }
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-04.
+//
+
+#include "PassManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include "../libs/Println.h"
+
+namespace alx::ir {
+
+void PassManager::AddFunctionPass(std::string name, std::string changed, FunctionPass pass)
+{
+	m_passes.push_back({ std::move(name), std::move(changed), std::move(pass) });
+}
+
+void PassManager::AddModulePass(std::string name, std::string changed, ModulePass pass)
+{
+	m_passes.push_back({ std::move(name), std::move(changed), std::move(pass) });
+}
+
+std::vector<std::string> PassManager::UnknownDumps() const
+{
+	std::vector<std::string> unknown;
+	for (const auto* names : { &m_dump_before, &m_dump_after }) {
+		for (const auto& name : *names) {
+			if (std::none_of(m_passes.begin(), m_passes.end(), [&name](const Pass& pass) { return pass.Name == name; }))
+				unknown.push_back(name);
+		}
+	}
+	std::sort(unknown.begin(), unknown.end());
+	unknown.erase(std::unique(unknown.begin(), unknown.end()), unknown.end());
+	return unknown;
+}
+
+void PassManager::Run(IR& ir)
+{
+	using SysClock = std::chrono::steady_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	auto& module = ir.GetIR();
+	const auto functionOf = [](IRNodes& node) -> Function& { return *std::get<std::unique_ptr<Function>>(node); };
+	const auto measure = [&module, &functionOf](size_t& instructions, size_t& bytes) {
+		instructions = 0;
+		bytes = 0;
+		for (auto& node : module) {
+			instructions += instructionCount(functionOf(node));
+			bytes += memoryUsage(functionOf(node));
+		}
+	};
+
+	// One for each function, made when a function pass first needs them
+	std::vector<FunctionAnalyses> analyses;
+	m_statistics.clear();
+	for (const auto& pass : m_passes) {
+		if (m_dump_before.contains(pass.Name)) {
+			println();
+			ir.Dump("before " + pass.Name);
+		}
+
+		PassStatistics statistics{ .Name = pass.Name, .Changed = pass.Changed };
+		measure(statistics.InstructionsBefore, statistics.BytesBefore);
+		const auto start = SysClock::now();
+		if (const auto* functionPass = std::get_if<FunctionPass>(&pass.Run)) {
+			if (analyses.empty()) {
+				analyses.reserve(module.size());
+				for (auto& node : module) analyses.emplace_back(functionOf(node));
+			}
+			for (size_t i = 0; i < module.size(); ++i)
+				statistics.Changes += (*functionPass)(functionOf(module[i]), analyses[i]);
+		}
+		else {
+			statistics.Changes = std::get<ModulePass>(pass.Run)(module);
+			analyses.clear();
+		}
+		statistics.Milliseconds = Milliseconds(SysClock::now() - start).count();
+		measure(statistics.InstructionsAfter, statistics.BytesAfter);
+		m_statistics.push_back(std::move(statistics));
+
+		if (m_dump_after_all || m_dump_after.contains(pass.Name)) {
+			println();
+			ir.Dump(pass.Name);
+		}
+	}
+}
+
+size_t instructionCount(const Function& function)
+{
+	size_t count = 0;
+	for (const auto& block : function.Blocks) count += block.Body.size();
+	return count;
+}
+
+size_t memoryUsage(const Function& function)
+{
+	size_t bytes = function.Instructions.capacity() * sizeof(BodyTypes)
+		+ function.Constants.capacity() * sizeof(Constant) + function.TypePool.capacity() * sizeof(Types)
+		+ function.Blocks.capacity() * sizeof(LogicalBlock);
+	for (const auto& block : function.Blocks) bytes += block.Body.capacity() * sizeof(InstructionId);
+	for (const auto& instruction : function.Instructions) {
+		const auto* variable = std::get_if<Variable>(&instruction);
+		if (const auto* phi = variable ? std::get_if<PhiInst>(&variable->Allocation) : nullptr)
+			bytes += phi->Incoming.capacity() * sizeof(PhiIncoming);
+	}
+	return bytes;
+}
+
+} // namespace alx::ir
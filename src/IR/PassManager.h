@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-04.
+//
+
+#pragma once
+
+#include <functional>
+#include <unordered_set>
+#include "Analysis/Analyses.h"
+
+namespace alx::ir {
+
+// What a pass did, summed over every function it ran on
+struct PassStatistics {
+	std::string Name;
+	// What Changes counts, e.g. "allocas promoted"
+	std::string Changed;
+	size_t Changes = 0;
+	double Milliseconds = 0;
+	// Instructions placed in blocks, and the bytes held by the functions' arrays
+	size_t InstructionsBefore = 0;
+	size_t InstructionsAfter = 0;
+	size_t BytesBefore = 0;
+	size_t BytesAfter = 0;
+};
+
+// Runs passes over the IR in the order they were added. Function passes are run on each function in turn and share
+// its analyses, which are worked out again only once a pass has changed what they depend on. A module pass can add
+// or remove functions, so every function's analyses are thrown away after one.
+class PassManager
+{
+public:
+	// Both return how many changes they made
+	using FunctionPass = std::function<size_t(Function&, FunctionAnalyses&)>;
+	using ModulePass = std::function<size_t(std::vector<IRNodes>&)>;
+
+private:
+	struct Pass {
+		std::string Name;
+		std::string Changed;
+		std::variant<FunctionPass, ModulePass> Run;
+	};
+	std::vector<Pass> m_passes;
+	std::vector<PassStatistics> m_statistics;
+	std::unordered_set<std::string> m_dump_before;
+	std::unordered_set<std::string> m_dump_after;
+	bool m_dump_after_all = false;
+
+public:
+	void AddFunctionPass(std::string name, std::string changed, FunctionPass pass);
+	void AddModulePass(std::string name, std::string changed, ModulePass pass);
+
+	// Dumps the IR as it is before or after the named pass
+	void DumpBefore(const std::string& pass) { m_dump_before.insert(pass); }
+	void DumpAfter(const std::string& pass) { m_dump_after.insert(pass); }
+	void DumpAfterAll() { m_dump_after_all = true; }
+	// Dumps asked for of passes that haven't been added, which would otherwise never be printed
+	[[nodiscard]] std::vector<std::string> UnknownDumps() const;
+
+	void Run(IR& ir);
+	// One for each pass, in the order they ran, from the last call to Run
+	[[nodiscard]] const std::vector<PassStatistics>& Statistics() const { return m_statistics; }
+};
+
+// Instructions placed in the function's blocks, which leaves out those a pass has taken out
+size_t instructionCount(const Function& function);
+// Bytes held by the function's arrays, which is most of what it takes up
+size_t memoryUsage(const Function& function);
+
+} // namespace alx::ir
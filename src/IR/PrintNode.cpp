@@ -18,8 +18,8 @@ namespace alx::ir {
 	Colour { 171, 189, 138 }
 
 #if OUTPUT_IR_TO_STRING
-#define print(...) ir.m_ir_string += alx::getFormatted(__VA_ARGS__)
-#define println(...) (ir.m_ir_string += alx::getFormatted(__VA_ARGS__) + "\n")
+#define print(...) alx::formatTo(ir.m_ir_string, __VA_ARGS__)
+#define println(...) (alx::formatTo(ir.m_ir_string, __VA_ARGS__), ir.m_ir_string += '\n')
 #endif
 
 struct ConstantVisitor {
@@ -27,44 +27,78 @@ struct ConstantVisitor {
 	std::string operator()(float constant) { return std::to_string(constant); }
 	std::string operator()(double constant) { return std::to_string(constant); }
 };
-struct ValueVisitor {
+// Prints an operand of one of `Function`'s instructions
+struct ValuePrinter {
+	const Function& function;
 	bool OutputIdentifier = true;
 	bool OutputType = true;
-	std::string operator()(const Constant& constant) const
+	std::string operator()(Values value) const
 	{
-		if (constant.Type.index() == 0 && std::get<SingleValueType>(constant.Type) == SingleValueType::Void)
-			return alx::getFormatted("{;60;197;172}", "void");
-		else if (OutputIdentifier)
-			return alx::getFormatted("{;60;197;172}{;171;189;138}",
-									 OutputType ? constant.TypeToString() + " " : "",
-									 std::visit(ConstantVisitor{}, constant.Value));
-		else
-			return alx::getFormatted("{;60;197;172}", constant.TypeToString());
-	}
-	std::string operator()(const std::shared_ptr<Variable>& variable) const
-	{
-		struct AllocatorVisitor {
-			std::string operator()(const AllocaInst& alloca) { return IR::TypesToString(*alloca.Type); }
-			std::string operator()(const LoadInst& load) { return IR::TypesToString(load.Type); }
-			std::string operator()(const AddInst& add) { return std::visit(ValueVisitor{ false }, add.Rhs); }
-			std::string operator()(const SubInst& sub) { return std::visit(ValueVisitor{ false }, sub.Rhs); }
-			std::string operator()(const MulInst& sub) { return std::visit(ValueVisitor{ false }, sub.Rhs); }
-			std::string operator()(const SDivInst& sub) { return std::visit(ValueVisitor{ false }, sub.Rhs); }
-			std::string operator()(const ICmpInst& cmp) { return std::visit(ValueVisitor{ false }, cmp.Rhs); }
-		};
+		if (value.IsConstant()) {
+			const auto& constant = function.ConstantOf(value);
+			if (constant.Type.index() == 0 && std::get<SingleValueType>(constant.Type) == SingleValueType::Void)
+				return alx::getFormatted("{;60;197;172}", "void");
+			else if (OutputIdentifier)
+				return alx::getFormatted("{;60;197;172}{;171;189;138}",
+										 OutputType ? constant.TypeToString() + " " : "",
+										 std::visit(ConstantVisitor{}, constant.Value));
+			else
+				return alx::getFormatted("{;60;197;172}", constant.TypeToString());
+		}
+		const auto& variable = function.VariableOf(value);
 		if (OutputIdentifier)
 			return alx::getFormatted("{;60;197;172}{;70;160;220}",
-									 OutputType ? std::visit(AllocatorVisitor{}, variable->Allocation) + " " : "",
-									 (variable->Visibility == VisibilityAttribute::Local ? "%" : "@") + variable->Name);
+									 OutputType ? type_of(value) + " " : "",
+									 (variable.Visibility == VisibilityAttribute::Local ? "%" : "@") + variable.Name);
 		else
-			return alx::getFormatted("{;60;197;172}", std::visit(AllocatorVisitor{}, variable->Allocation));
+			return alx::getFormatted("{;60;197;172}", type_of(value));
+	}
+
+private:
+	// Arithmetic is printed with the type of its rhs, which can be the result of more arithmetic. Each one it's
+	// followed through is another layer of colour, the same as printing the rhs would give.
+	[[nodiscard]] std::string type_of(Values value) const
+	{
+		size_t layers = 0;
+		std::string type;
+		while (true) {
+			if (value.IsConstant()) {
+				type = function.ConstantOf(value).TypeToString();
+				break;
+			}
+			const auto& allocation = function.VariableOf(value).Allocation;
+			if (const auto* alloca = std::get_if<AllocaInst>(&allocation)) {
+				type = IR::TypesToString(function.TypeOf(alloca->Type));
+				break;
+			}
+			if (const auto* load = std::get_if<LoadInst>(&allocation)) {
+				type = IR::TypesToString(function.TypeOf(load->Type));
+				break;
+			}
+			if (const auto* phi = std::get_if<PhiInst>(&allocation)) {
+				type = IR::TypesToString(function.TypeOf(phi->Type));
+				break;
+			}
+			value = std::visit(
+				[](const auto& inst) -> Values {
+					if constexpr (requires { inst.Rhs; })
+						return inst.Rhs;
+					else
+						ASSERT_NOT_REACHABLE();
+				},
+				allocation);
+			++layers;
+		}
+		for (size_t layer = 0; layer < layers; ++layer)
+			type = alx::getFormatted("{;60;197;172}", type);
+		return type;
 	}
 };
 
-void IR::Dump()
+void IR::Dump(const std::string& stage)
 {
 #if !OUTPUT_IR_TO_STRING
-	println("Opt-pipeline IR initial:");
+	println("Opt-pipeline IR {}:", stage);
 #endif
 	struct IrVisitor {
 		IR& ir;
@@ -91,7 +125,7 @@ void Function::PrintNode(IR& ir) const
 		print("(");
 		auto separator = "";
 		for (const auto& arg : Arguments) {
-			print(separator);
+			print("{}", separator);
 			arg.PrintNode(ir);
 			separator = ", ";
 		}
@@ -102,20 +136,22 @@ void Function::PrintNode(IR& ir) const
 
 	struct BodyVisitor {
 		IR& ir;
+		const Function& function;
 		void operator()(const LabelType&) {}
 		void operator()(const ReturnInst& ret)
 		{
-			std::string returnType = std::visit(ValueVisitor{}, ret.Value);
+			std::string returnType = ValuePrinter{ function }(ret.Value);
 			println("  ret {}", returnType);
 		}
-		void operator()(const Variable& var) { var.PrintNode(ir); }
+		void operator()(const Variable& var) { var.PrintNode(ir, function); }
 		void operator()(const StoreInst& store)
 		{
-			std::string value = std::visit(ValueVisitor{}, store.Value);
+			std::string value = ValuePrinter{ function }(store.Value);
+			const auto& ptr = function.VariableOf(store.Ptr);
 			print("  store");
 			print(" {}", value);
 			print(", ptr ");
-			print(BLUE, "{}{}", store.Ptr->Visibility == VisibilityAttribute::Local ? "%" : "@", store.Ptr->Name);
+			print(BLUE, "{}{}", ptr.Visibility == VisibilityAttribute::Local ? "%" : "@", ptr.Name);
 			println(", align {}", store.Alignment.Alignment);
 		}
 		void operator()(const BranchInst& branch)
@@ -123,7 +159,7 @@ void Function::PrintNode(IR& ir) const
 			print("  br ");
 			if (branch.Condition.has_value()) {
 				print(GREEN, "{} ", IR::TypesToString(branch.Size));
-				print(std::visit(ValueVisitor{ .OutputType = false }, branch.Condition.value()));
+				print("{}", ValuePrinter{ .function = function, .OutputType = false }(branch.Condition.value()));
 				print(", ");
 			}
 			print(GREEN, "label ");
@@ -139,73 +175,87 @@ void Function::PrintNode(IR& ir) const
 
 	for (const auto& block : Blocks) {
 		println(BLUE, "{}:", block.Label.Name);
-		for (const auto& child : block.Body) std::visit(BodyVisitor{ ir }, child);
+		for (const auto child : block.Body) std::visit(BodyVisitor{ ir, *this }, Instructions[child]);
 		println();
 	}
 	println("}");
 }
 
-void Variable::PrintNode(IR& ir) const
+void Variable::PrintNode(IR& ir, const Function& function) const
 {
 	struct AllocatorVisitor {
 		IR& ir;
+		const Function& function;
 		void operator()(const AllocaInst& alloca)
 		{
 			print(" = alloca ");
-			print(GREEN, "{}", IR::TypesToString(*alloca.Type));
+			print(GREEN, "{}", IR::TypesToString(function.TypeOf(alloca.Type)));
 		}
 		void operator()(const LoadInst& load)
 		{
+			const auto& ptr = function.VariableOf(load.Ptr);
 			print(" = load ");
-			print(GREEN, "{}", IR::TypesToString(load.Type));
+			print(GREEN, "{}", IR::TypesToString(function.TypeOf(load.Type)));
 			print(", ");
 			print("ptr ");
-			print(BLUE, "{}{}", load.Ptr->Visibility == VisibilityAttribute::Local ? "%" : "@", load.Ptr->Name);
+			print(BLUE, "{}{}", ptr.Visibility == VisibilityAttribute::Local ? "%" : "@", ptr.Name);
 		}
 		void operator()(const AddInst& add)
 		{
 			print(" = add ");
-			print(std::visit(ValueVisitor{}, add.Lhs));
+			print("{}", ValuePrinter{ function }(add.Lhs));
 			print(", ");
-			print(std::visit(ValueVisitor{ .OutputType = false }, add.Rhs));
+			print("{}", ValuePrinter{ .function = function, .OutputType = false }(add.Rhs));
 		}
 		void operator()(const SubInst& sub)
 		{
 			print(" = sub ");
-			print(std::visit(ValueVisitor{}, sub.Lhs));
+			print("{}", ValuePrinter{ function }(sub.Lhs));
 			print(", ");
-			print(std::visit(ValueVisitor{ .OutputType = false }, sub.Rhs));
+			print("{}", ValuePrinter{ .function = function, .OutputType = false }(sub.Rhs));
 		}
 		void operator()(const MulInst& sub)
 		{
 			print(" = mul ");
-			print(std::visit(ValueVisitor{}, sub.Lhs));
+			print("{}", ValuePrinter{ function }(sub.Lhs));
 			print(", ");
-			print(std::visit(ValueVisitor{ .OutputType = false }, sub.Rhs));
+			print("{}", ValuePrinter{ .function = function, .OutputType = false }(sub.Rhs));
 		}
 		void operator()(const SDivInst& sub)
 		{
 			print(" = sdiv ");
-			print(std::visit(ValueVisitor{}, sub.Lhs));
+			print("{}", ValuePrinter{ function }(sub.Lhs));
 			print(", ");
-			print(std::visit(ValueVisitor{ .OutputType = false }, sub.Rhs));
+			print("{}", ValuePrinter{ .function = function, .OutputType = false }(sub.Rhs));
 		}
 		void operator()(const ICmpInst& cmp)
 		{
 			print(" = icmp ");
-			print(cmpPredicateToString(cmp.Predicate));
+			print("{}", cmpPredicateToString(cmp.Predicate));
 			print(" ");
-			print(std::visit(ValueVisitor{}, cmp.Lhs));
+			print("{}", ValuePrinter{ function }(cmp.Lhs));
 			print(", ");
-			print(std::visit(ValueVisitor{ .OutputType = false }, cmp.Rhs));
+			print("{}", ValuePrinter{ .function = function, .OutputType = false }(cmp.Rhs));
+		}
+		void operator()(const PhiInst& phi)
+		{
+			print(" = phi ");
+			print(GREEN, "{}", IR::TypesToString(function.TypeOf(phi.Type)));
+			auto separator = " ";
+			for (const auto& incoming : phi.Incoming) {
+				print("{}[ {}, ", separator, ValuePrinter{ .function = function, .OutputType = false }(incoming.Value));
+				print(BLUE, "%{}", incoming.Block.Name);
+				print(" ]");
+				separator = ", ";
+			}
 		}
-	} visitor{ ir };
+	} visitor{ ir, function };
 	print("  ");
 	print(BLUE, "{}{}", Visibility == VisibilityAttribute::Local ? "%" : "@", Name);
 	std::visit(visitor, Allocation);
-	if (!Attributes.empty()) {
+	if (Alignment) {
 		print(",");
-		for (const auto& attribute : Attributes) print(" {}", IR::EnumToString(attribute));
+		print(" {}", IR::EnumToString(ParameterAttributes{ *Alignment }));
 	}
 	println("");
 }
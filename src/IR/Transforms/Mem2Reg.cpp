@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-03.
+//
+
+#include "Mem2Reg.h"
+
+#include <algorithm>
+
+namespace alx::ir {
+
+namespace {
+
+// Index of an alloca among those being promoted
+using Slot = uint32_t;
+constexpr Slot NotPromoted = UINT32_MAX;
+
+bool isScalar(const Types& type)
+{
+	if (const auto* single = std::get_if<SingleValueType>(&type))
+		return *single != SingleValueType::Void;
+	return std::holds_alternative<IntType>(type) || std::holds_alternative<PtrType>(type);
+}
+
+// Whether the alloca is only ever loaded from and stored to whole, so nothing can tell it's been replaced
+bool isPromotable(const Function& function, const UseLists& uses, Values alloca)
+{
+	const auto& allocation = std::get<AllocaInst>(function.VariableOf(alloca).Allocation);
+	for (const auto user : uses.Users(alloca)) {
+		const auto& instruction = function.Instructions[user];
+		if (const auto* store = std::get_if<StoreInst>(&instruction)) {
+			// Storing the alloca's address somewhere lets it be used behind the loads' and stores' backs
+			if (store->Value == alloca || function.SizeOf(store->Value) != allocation.Size)
+				return false;
+			continue;
+		}
+		const auto* variable = std::get_if<Variable>(&instruction);
+		const auto* load = variable ? std::get_if<LoadInst>(&variable->Allocation) : nullptr;
+		if (!load || load->Type != allocation.Type)
+			return false;
+	}
+	return true;
+}
+
+// What a variable reads as before anything has been stored to it
+Values zeroOf(Function& function, const Types& type)
+{
+	if (const auto* integer = std::get_if<IntType>(&type))
+		return function.MakeConstant(Constant{ .Type = *integer, .Value = 0L });
+	if (const auto* single = std::get_if<SingleValueType>(&type))
+		return function.MakeConstant(Constant{ .Type = *single, .Value = 0.0 });
+	return function.MakeConstant(Constant{ .Type = PtrType{}, .Value = 0L });
+}
+
+} // namespace
+
+size_t promoteAllocas(Function& function, FunctionAnalyses& analyses)
+{
+	const auto& graph = analyses.ControlFlow();
+	const auto& dominators = analyses.Dominators();
+	const auto& uses = analyses.Uses();
+
+	std::vector<InstructionId> allocas;
+	std::vector<Slot> slots(function.Instructions.size(), NotPromoted);
+	for (const auto& block : function.Blocks) {
+		for (const auto id : block.Body) {
+			const auto* variable = std::get_if<Variable>(&function.Instructions[id]);
+			const auto* alloca = variable ? std::get_if<AllocaInst>(&variable->Allocation) : nullptr;
+			if (alloca && isScalar(function.TypeOf(alloca->Type))
+				&& isPromotable(function, uses, Values::OfInstruction(id))) {
+				slots[id] = static_cast<Slot>(allocas.size());
+				allocas.push_back(id);
+			}
+		}
+	}
+	if (allocas.empty())
+		return 0;
+	const auto slotOf = [&slots](Values ptr) {
+		return ptr.IsConstant() || ptr.Index() >= slots.size() ? NotPromoted : slots[ptr.Index()];
+	};
+	const auto typeOf = [&function, &allocas](Slot slot) {
+		return std::get<AllocaInst>(function.VariableOf(Values::OfInstruction(allocas[slot])).Allocation).Type;
+	};
+
+	// Each alloca needs a phi wherever the dominance of a block storing to it ends, and the phi is itself a store as
+	// far as the blocks after it are concerned (Cytron et al., "Efficiently Computing Static Single Assignment Form")
+	std::vector<std::pair<Slot, BlockId>> stores;
+	for (BlockId block = 0; block < function.Blocks.size(); ++block) {
+		if (!graph.IsReachable(block))
+			continue;
+		for (const auto id : function.Blocks[block].Body) {
+			const auto& instruction = function.Instructions[id];
+			if (isTerminator(instruction))
+				break;
+			if (const auto* store = std::get_if<StoreInst>(&instruction)) {
+				const auto slot = slotOf(store->Ptr);
+				if (slot != NotPromoted)
+					stores.emplace_back(slot, block);
+			}
+		}
+	}
+	// Grouped by alloca: the blocks storing to alloca i are storedIn[firstStore[i]] up to storedIn[firstStore[i + 1]]
+	std::vector<uint32_t> firstStore(allocas.size() + 1);
+	for (const auto& [slot, block] : stores) ++firstStore[slot + 1];
+	for (size_t i = 1; i < firstStore.size(); ++i) firstStore[i] += firstStore[i - 1];
+	std::vector<BlockId> storedIn(stores.size());
+	auto next = firstStore;
+	for (const auto& [slot, block] : stores) storedIn[next[slot]++] = block;
+
+	std::vector<std::vector<std::pair<Slot, InstructionId>>> phis(function.Blocks.size());
+	std::vector<Slot> hasPhi(function.Blocks.size(), NotPromoted);
+	std::vector<Slot> queued(function.Blocks.size(), NotPromoted);
+	std::vector<BlockId> worklist;
+	for (Slot slot = 0; slot < allocas.size(); ++slot) {
+		for (auto i = firstStore[slot]; i < firstStore[slot + 1]; ++i) {
+			if (queued[storedIn[i]] != slot) {
+				queued[storedIn[i]] = slot;
+				worklist.push_back(storedIn[i]);
+			}
+		}
+		while (!worklist.empty()) {
+			const auto block = worklist.back();
+			worklist.pop_back();
+			for (const auto frontier : dominators.Frontier(block)) {
+				if (hasPhi[frontier] == slot)
+					continue;
+				hasPhi[frontier] = slot;
+				// Named once it's known to be used, so that the ones thrown away don't leave gaps
+				const auto phi = function.NewVariable(
+					Variable{ .Name = {}, .Allocation = PhiInst{ .Type = typeOf(slot) }, .IsTemporary = true });
+				phis[frontier].emplace_back(slot, phi.Index());
+				if (queued[frontier] != slot) {
+					queued[frontier] = slot;
+					worklist.push_back(frontier);
+				}
+			}
+		}
+	}
+
+	// Walking the dominator tree, each alloca's value is whatever was last stored to it in the blocks above. Loads are
+	// replaced by that value, and the loads, stores and allocas themselves are dropped.
+	std::vector<Values> replacements(function.Instructions.size());
+	for (InstructionId id = 0; id < replacements.size(); ++id) replacements[id] = Values::OfInstruction(id);
+	std::vector<std::optional<Values>> zeros(allocas.size());
+	// Each alloca's value so far, and what it was before each store in the blocks being walked
+	std::vector<std::optional<Values>> current(allocas.size());
+	std::vector<std::pair<Slot, std::optional<Values>>> overwritten;
+	const auto assign = [&current, &overwritten](Slot slot, Values value) {
+		overwritten.emplace_back(slot, current[slot]);
+		current[slot] = value;
+	};
+	const auto zero = [&](Slot slot) {
+		if (!zeros[slot])
+			zeros[slot] = zeroOf(function, function.TypeOf(typeOf(slot)));
+		return *zeros[slot];
+	};
+	const auto valueOf = [&](Slot slot) { return current[slot] ? *current[slot] : zero(slot); };
+	const auto resolve = [&replacements](Values value) {
+		return value.IsConstant() || value.Index() >= replacements.size() ? value : replacements[value.Index()];
+	};
+	const auto rewrite = [&](BlockId block) {
+		auto& body = function.Blocks[block].Body;
+		// Nothing after a terminator or in a block that can't be reached runs, so its stores are dropped and its loads
+		// read as though nothing had been stored
+		bool runs = graph.IsReachable(block);
+		size_t kept = 0;
+		for (const auto id : body) {
+			const auto& instruction = function.Instructions[id];
+			if (const auto* store = std::get_if<StoreInst>(&instruction)) {
+				if (const auto slot = slotOf(store->Ptr); slot != NotPromoted) {
+					if (runs)
+						assign(slot, resolve(store->Value));
+					continue;
+				}
+			}
+			else if (const auto* variable = std::get_if<Variable>(&instruction)) {
+				if (slots.size() > id && slots[id] != NotPromoted)
+					continue;
+				if (const auto* load = std::get_if<LoadInst>(&variable->Allocation)) {
+					if (const auto slot = slotOf(load->Ptr); slot != NotPromoted) {
+						replacements[id] = runs ? valueOf(slot) : zero(slot);
+						continue;
+					}
+				}
+			}
+			else if (isTerminator(instruction))
+				runs = false;
+			body[kept++] = id;
+		}
+		body.resize(kept);
+
+		// Unreachable blocks are rewritten after the walk, when there's no value for anything
+		for (const auto successor : graph.Successors(block)) {
+			for (const auto& [slot, phi] : phis[successor]) {
+				auto& incoming = std::get<PhiInst>(std::get<Variable>(function.Instructions[phi]).Allocation).Incoming;
+				incoming.push_back({ valueOf(slot), function.Blocks[block].Label });
+			}
+		}
+	};
+
+	struct Frame {
+		BlockId Block;
+		size_t NextChild;
+		// How many stores had been walked when the block was entered, which are all that are left on leaving it
+		size_t Overwritten;
+	};
+	std::vector<Frame> stack;
+	const auto enter = [&](BlockId block) {
+		stack.push_back({ block, 0, overwritten.size() });
+		for (const auto& [slot, phi] : phis[block]) assign(slot, Values::OfInstruction(phi));
+		rewrite(block);
+	};
+	enter(0);
+	while (!stack.empty()) {
+		auto& frame = stack.back();
+		if (frame.NextChild < dominators.Children(frame.Block).size()) {
+			enter(dominators.Children(frame.Block)[frame.NextChild++]);
+			continue;
+		}
+		while (overwritten.size() > frame.Overwritten) {
+			current[overwritten.back().first] = overwritten.back().second;
+			overwritten.pop_back();
+		}
+		stack.pop_back();
+	}
+	for (BlockId block = 0; block < function.Blocks.size(); ++block)
+		if (!graph.IsReachable(block))
+			rewrite(block);
+
+	// Minimal SSA puts phis where the variable is no longer used too. A phi is kept if anything other than a phi uses
+	// it, or a phi that's kept does.
+	std::vector<bool> isPhi(function.Instructions.size());
+	std::vector<bool> live(function.Instructions.size());
+	for (const auto& blockPhis : phis)
+		for (const auto& [slot, phi] : blockPhis) isPhi[phi] = true;
+	std::vector<InstructionId> marked;
+	const auto markLive = [&](Values value) {
+		if (value.IsConstant() || !isPhi[value.Index()] || live[value.Index()])
+			return;
+		live[value.Index()] = true;
+		marked.push_back(value.Index());
+	};
+	for (const auto& block : function.Blocks) {
+		for (const auto id : block.Body) {
+			forEachOperand(function.Instructions[id], [&](Values& operand) {
+				operand = resolve(operand);
+				markLive(operand);
+			});
+		}
+	}
+	while (!marked.empty()) {
+		const auto phi = marked.back();
+		marked.pop_back();
+		forEachOperand(function.Instructions[phi], markLive);
+	}
+	for (BlockId block = 0; block < function.Blocks.size(); ++block) {
+		std::vector<InstructionId> kept;
+		for (const auto& [slot, phi] : phis[block]) {
+			if (!live[phi])
+				continue;
+			auto& variable = std::get<Variable>(function.Instructions[phi]);
+			variable.Name = function.GetNewUnnamedTemporary();
+			// In the order the blocks are in rather than the order the walk got to them
+			auto& incoming = std::get<PhiInst>(variable.Allocation).Incoming;
+			std::sort(incoming.begin(), incoming.end(), [&function](const auto& lhs, const auto& rhs) {
+				return function.BlockIndices.at(lhs.Block.Name) < function.BlockIndices.at(rhs.Block.Name);
+			});
+			kept.push_back(phi);
+		}
+		auto& body = function.Blocks[block].Body;
+		body.insert(body.begin(), kept.begin(), kept.end());
+	}
+
+	function.InstructionsChanged();
+	return allocas.size();
+}
+
+} // namespace alx::ir
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-03.
+//
+
+#pragma once
+
+#include "../Analysis/Analyses.h"
+
+namespace alx::ir {
+
+// Replaces the function's scalar allocas that are only ever loaded from and stored to with the values stored to them,
+// putting phis where stores along different paths meet. Returns how many allocas were promoted.
+size_t promoteAllocas(Function& function, FunctionAnalyses& analyses);
+
+} // namespace alx::ir
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-03.
+//
+
+#include "PhiElimination.h"
+
+#include <algorithm>
+
+namespace alx::ir {
+
+size_t eliminatePhis(Function& function)
+{
+	std::vector<InstructionId> phis;
+	for (const auto& block : function.Blocks) {
+		for (const auto id : block.Body) {
+			const auto* variable = std::get_if<Variable>(&function.Instructions[id]);
+			if (variable && std::holds_alternative<PhiInst>(variable->Allocation))
+				phis.push_back(id);
+		}
+	}
+	if (phis.empty())
+		return 0;
+
+	std::vector<InstructionId> slots;
+	for (const auto id : phis) {
+		// Copied, as making the slot and the stores to it grows the instructions it's in
+		const auto phi = std::get<PhiInst>(std::get<Variable>(function.Instructions[id]).Allocation);
+		const auto size = sizeOfType(function.TypeOf(phi.Type));
+		const auto slot = function.NewVariable(Variable{ .Name = function.GetNewUnnamedTemporary(),
+														 .Alignment = AlignAttribute{ size },
+														 .Allocation = AllocaInst{ .Type = phi.Type, .Size = size } });
+		slots.push_back(slot.Index());
+
+		// A block that also branches somewhere else stores a value that goes unread on that path, which is cheaper
+		// than splitting the edge. Every phi has a slot of its own and the loads all come before anything else in the
+		// block, so phis that read each other still see the values from before the branch.
+		for (const auto& incoming : phi.Incoming) {
+			function.Instructions.emplace_back(
+				StoreInst{ .Value = incoming.Value, .Ptr = slot, .Alignment = { size } });
+			auto& body = function.GetBlockByLabel(incoming.Block.Name).Body;
+			const auto terminator = std::find_if(body.begin(), body.end(), [&function](InstructionId instruction) {
+				return isTerminator(function.Instructions[instruction]);
+			});
+			body.insert(terminator, static_cast<InstructionId>(function.Instructions.size() - 1));
+		}
+
+		auto& variable = std::get<Variable>(function.Instructions[id]);
+		variable.Alignment = AlignAttribute{ size };
+		variable.Allocation = LoadInst{ .Type = phi.Type, .Ptr = slot, .Alignment = { size } };
+	}
+	auto& entry = function.Blocks.front().Body;
+	entry.insert(entry.begin(), slots.begin(), slots.end());
+
+	function.InstructionsChanged();
+	return phis.size();
+}
+
+} // namespace alx::ir
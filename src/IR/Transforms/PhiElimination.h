@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-12-03.
+//
+
+#pragma once
+
+#include "../Ir.h"
+
+namespace alx::ir {
+
+// Takes the function back out of SSA form for instruction selection, which has no phis. Each phi gets a stack slot
+// of its own that the blocks it has values from store to before branching, and becomes a load from it. Returns how
+// many phis were taken out.
+size_t eliminatePhis(Function& function);
+
+} // namespace alx::ir
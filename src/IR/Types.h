@@ -7,9 +7,15 @@
 //
 
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "Attributes.h"
+#include "../Utils/Utils.h"
 
 namespace alx::ir {
 enum class SingleValueType
@@ -54,4 +60,67 @@ struct StructType
 	VisibilityAttribute Visibility = VisibilityAttribute::Local;
 	std::vector<Types> TypeList{};
 };
+
+// Index of a type in its function's type pool
+using TypeId = uint32_t;
+
+// Sizeof type in bytes
+inline size_t sizeOfType(const Types& type)
+{
+	struct SizeVisitor {
+		size_t operator()(const SingleValueType& value) const
+		{
+			switch (value) {
+			case SingleValueType::Void:
+				return 0;
+			case SingleValueType::Half:
+				return 2;
+			case SingleValueType::Float:
+				return 4;
+			case SingleValueType::Double:
+				return 8;
+			default:
+				ASSERT_NOT_REACHABLE();
+			}
+		}
+
+		size_t operator()(const IntType& type) const { return type.Size; }
+
+		size_t operator()(const PtrType&) const { return sizeof(void*); }
+
+		size_t operator()(const StructType& type) const
+		{
+			size_t size = 0;
+			for (const auto& t : type.TypeList) {
+				size += std::visit(SizeVisitor{}, t);
+			}
+			return size;
+		}
+
+		size_t operator()(const ArrayType& type) const { return type.Size * std::visit(SizeVisitor{}, *type.Type); }
+		size_t operator()(const LabelType&) const { ASSERT_NOT_REACHABLE(); };
+	};
+	return std::visit(SizeVisitor{}, type);
+}
+
+// Whether two types are the same one, which is what lets a function keep only one copy of each type it uses. Structs
+// are the same if they're the same named struct.
+inline bool sameType(const Types& lhs, const Types& rhs)
+{
+	if (lhs.index() != rhs.index())
+		return false;
+	if (const auto* single = std::get_if<SingleValueType>(&lhs))
+		return *single == std::get<SingleValueType>(rhs);
+	if (const auto* integer = std::get_if<IntType>(&lhs))
+		return integer->Size == std::get<IntType>(rhs).Size;
+	if (std::holds_alternative<PtrType>(lhs))
+		return true;
+	if (const auto* label = std::get_if<LabelType>(&lhs))
+		return label->Name == std::get<LabelType>(rhs).Name;
+	if (const auto* structType = std::get_if<StructType>(&lhs))
+		return structType->Name == std::get<StructType>(rhs).Name;
+	const auto& array = std::get<ArrayType>(lhs);
+	const auto& otherArray = std::get<ArrayType>(rhs);
+	return array.Size == otherArray.Size && sameType(*array.Type, *otherArray.Type);
+}
 }
@@ -8,9 +8,9 @@
 
 #pragma once
 
+#include <bit>
 #include <variant>
 #include "Types.h"
-#include "Variables.h"
 namespace alx::ir {
 
 
@@ -42,7 +42,10 @@ struct Constant
 
 		std::pair<size_t, std::string> operator()(const IntType& type) const
 		{
-			return { type.Size, "i" + std::to_string(type.Size * 8) };
+			// Appending rather than `"i" + std::to_string(...)` dodges a GCC 12 -Wrestrict false positive at -O2
+			std::string name = "i";
+			name += std::to_string(type.Size * 8);
+			return { type.Size, name };
 		}
 
 		std::pair<size_t, std::string> operator()(const PtrType&) const
@@ -60,7 +63,54 @@ struct Constant
 	{
 		return std::visit(TypeVisitor{}, Type).second;
 	}
+
+	// Identifies the constant by its type and the bits of its value, so -0.0 and 0.0 are different constants
+	struct Key
+	{
+		uint32_t Kind;
+		uint64_t Bits;
+		bool operator==(const Key&) const = default;
+		struct Hash
+		{
+			size_t operator()(const Key& key) const
+			{
+				return std::hash<uint64_t>{}(key.Bits) ^ (std::hash<uint32_t>{}(key.Kind) * 0x9e3779b97f4a7c15);
+			}
+		};
+	};
+
+	[[nodiscard]] Key KeyOf() const
+	{
+		uint32_t kind = Type.index() << 16 | Value.index() << 12;
+		if (const auto* single = std::get_if<SingleValueType>(&Type))
+			kind |= static_cast<uint32_t>(*single);
+		else if (const auto* integer = std::get_if<IntType>(&Type))
+			kind |= integer->Size;
+		uint64_t bits = 0;
+		if (const auto* integer = std::get_if<long>(&Value))
+			bits = static_cast<uint64_t>(*integer);
+		else if (const auto* single = std::get_if<float>(&Value))
+			bits = std::bit_cast<uint32_t>(*single);
+		else
+			bits = std::bit_cast<uint64_t>(std::get<double>(Value));
+		return { kind, bits };
+	}
+};
+
+// An instruction's operand: either the result of another of its function's instructions, or one of its function's
+// constants. Both are kept by the function, so an operand is only ever an index into one of the two and instructions
+// can be copied and compared without touching what they refer to.
+struct Values
+{
+	static constexpr uint32_t ConstantBit = 1u << 31;
+	uint32_t Id;
+
+	static Values OfInstruction(uint32_t index) { return { index }; }
+	static Values OfConstant(uint32_t index) { return { index | ConstantBit }; }
+
+	[[nodiscard]] bool IsConstant() const { return Id & ConstantBit; }
+	// Index into the function's instructions or constants, depending on which this is
+	[[nodiscard]] uint32_t Index() const { return Id & ~ConstantBit; }
+	bool operator==(const Values&) const = default;
 };
-struct Variable;
-using Values = std::variant<Constant, std::shared_ptr<Variable>>;
 }
\ No newline at end of file
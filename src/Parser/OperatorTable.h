@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "../Utils/Types.h"
+
+namespace alx {
+
+enum class Associativity : uint8_t
+{
+	Left,
+	Right,
+};
+
+// How strongly an operator holds on to the operands either side of it. An operand between two operators goes to the
+// one with the higher power facing it; 0 means the token can't be used that way.
+struct BindingPower {
+	uint8_t PrefixRight;
+	uint8_t InfixLeft;
+	uint8_t InfixRight;
+	uint8_t PostfixLeft;
+};
+
+namespace detail {
+
+// Precedence levels, loosest first
+enum Precedence : uint8_t
+{
+	Assignment = 1, // = += -= *= /= %= ^=
+	Equality,		// == !=
+	Relational,		// < > <= >=
+	Additive,		// + -
+	Multiplicative, // * / %
+	Prefix,			// - + ! ++ --
+	Exponent,		// ^
+	Postfix,		// ++ --
+};
+
+consteval auto makeOperatorTable()
+{
+	std::array<BindingPower, TokenTypeCount> table{};
+	auto infix = [&table](TokenType op, Precedence precedence, Associativity associativity) {
+		// Of two operators at the same level, the one on the left wins for left associative operators
+		const auto bias = associativity == Associativity::Left ? 1 : 0;
+		table[static_cast<size_t>(op)].InfixLeft = static_cast<uint8_t>(precedence * 2 + 1 - bias);
+		table[static_cast<size_t>(op)].InfixRight = static_cast<uint8_t>(precedence * 2 + bias);
+	};
+	auto prefix = [&table](TokenType op) {
+		table[static_cast<size_t>(op)].PrefixRight = Precedence::Prefix * 2;
+	};
+	auto postfix = [&table](TokenType op) {
+		table[static_cast<size_t>(op)].PostfixLeft = Precedence::Postfix * 2;
+	};
+
+	for (auto op : { TokenType::T_EQ,
+					 TokenType::T_ADD_EQ,
+					 TokenType::T_SUB_EQ,
+					 TokenType::T_MULT_EQ,
+					 TokenType::T_DIV_EQ,
+					 TokenType::T_MOD_EQ,
+					 TokenType::T_POW_EQ })
+		infix(op, Assignment, Associativity::Right);
+	for (auto op : { TokenType::T_EQEQ, TokenType::T_NOT_EQ })
+		infix(op, Equality, Associativity::Left);
+	for (auto op : { TokenType::T_LT, TokenType::T_GT, TokenType::T_LTE, TokenType::T_GTE })
+		infix(op, Relational, Associativity::Left);
+	for (auto op : { TokenType::T_PLUS, TokenType::T_MINUS })
+		infix(op, Additive, Associativity::Left);
+	for (auto op : { TokenType::T_STAR, TokenType::T_FWD_SLASH, TokenType::T_MOD })
+		infix(op, Multiplicative, Associativity::Left);
+	infix(TokenType::T_POW, Exponent, Associativity::Right);
+
+	for (auto op : { TokenType::T_MINUS, TokenType::T_PLUS, TokenType::T_NOT, TokenType::T_ADD, TokenType::T_SUB })
+		prefix(op);
+	for (auto op : { TokenType::T_ADD, TokenType::T_SUB })
+		postfix(op);
+	return table;
+}
+
+} // namespace detail
+
+// Binding powers for the expression parser, indexed by TokenType. Member access ('.', '->' and '::') isn't in here:
+// it only ever joins two identifiers, so it's parsed as a single term. ':' has no '?' to pair with yet.
+inline constexpr auto OperatorTable = detail::makeOperatorTable();
+
+constexpr const BindingPower& bindingPower(TokenType type) { return OperatorTable[static_cast<size_t>(type)]; }
+
+static_assert(bindingPower(TokenType::T_STAR).InfixLeft > bindingPower(TokenType::T_PLUS).InfixRight);
+static_assert(bindingPower(TokenType::T_MINUS).InfixRight > bindingPower(TokenType::T_MINUS).InfixLeft);
+static_assert(bindingPower(TokenType::T_EQ).InfixRight < bindingPower(TokenType::T_EQ).InfixLeft);
+static_assert(bindingPower(TokenType::T_SEMI).InfixLeft == 0);
+
+} // namespace alx
@@ -11,28 +11,41 @@
 
 namespace alx {
 
-std::unique_ptr<StructDeclaration> Parser::parse_struct_declaration()
+StructDeclaration* Parser::parse_struct_declaration()
 {
-	auto oldScopeName = m_current_scope_name;
+	auto oldScope = m_current_scope;
+	const auto start = m_index;
+	const auto isGlobal = m_symbols.Depth() == 0;
 	consume(); // Consumes 'struct' or 'class'
 	// TODO: Parse inheritance
 	auto name = must_consume(TokenType::T_IDENTIFIER);
 	must_consume(TokenType::T_CURLY_OPEN);
-	std::vector<std::unique_ptr<ASTNode>> members;
-	std::vector<std::unique_ptr<ASTNode>> methods;
-	m_current_scope_name = name.Value.value();
-	while (peek().has_value() && peek().value().Type != TokenType::T_CURLY_CLOSE)
+	std::vector<ASTNode*> members;
+	std::vector<ASTNode*> methods;
+	m_current_scope = name.Symbol();
+	m_symbols.EnterScope(ScopeKind::Function);
+	while (peek().has_value() && peek().value().Type() != TokenType::T_CURLY_CLOSE)
 	{
-		auto statement = parse_statement();
-		must_consume(TokenType::T_SEMI);
-		if (statement->class_name() == "VariableDeclaration")
-			members.push_back(std::move(statement));
-		else if (statement->class_name() == "FunctionDeclaration")
-			methods.push_back(std::move(statement));
+		auto statement = parse_or_recover([this] {
+			auto member = parse_statement();
+			must_consume(TokenType::T_SEMI);
+			return member;
+		});
+		if (!statement)
+			continue;
+		if (statement->Kind() == NodeKind::VariableDeclaration)
+			members.push_back(statement);
+		else if (statement->Kind() == NodeKind::FunctionDeclaration)
+			methods.push_back(statement);
 	}
 	must_consume(TokenType::T_CURLY_CLOSE);
-	m_current_scope_name = oldScopeName;
-	return std::make_unique<StructDeclaration>(name.Value.value(), std::move(members), std::move(methods));
+	m_symbols.ExitScope();
+	m_current_scope = oldScope;
+	auto declaration = make<StructDeclaration>(
+		name.Value(), m_program->Arena().Copy<ASTNode*>(members), m_program->Arena().Copy<ASTNode*>(methods));
+	if (isGlobal)
+		m_globals->DeclareType(name.Symbol(), start, declaration);
+	return declaration;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-09-07.
+//
+
+#include "../libs/ErrorHandler.h"
+#include "OperatorTable.h"
+#include "Parser.h"
+
+namespace alx {
+
+// Expressions are parsed with the binding powers in OperatorTable, but on explicit operand and operator stacks rather
+// than by recursing, so neither deep nesting nor long chains of right associative operators use any native stack.
+Expression* Parser::parse_expression()
+{
+	const auto operandMark = m_operands.size();
+	const auto operatorMark = m_operators.size();
+
+	while (true) {
+		// Prefix operators and opening parentheses, then the operand they apply to
+		for (auto token = peek(); token.has_value(); token = peek()) {
+			if (token->Type() == TokenType::T_OPEN_PAREN)
+				m_operators.push_back({ .Op = consume(), .RightPower = 0, .Prefix = false });
+			else if (const auto power = bindingPower(token->Type()).PrefixRight)
+				m_operators.push_back({ .Op = consume(), .RightPower = power, .Prefix = true });
+			else
+				break;
+		}
+		m_operands.push_back(parse_term());
+
+		// Then postfix operators and closing parentheses, until there's an infix operator or the expression is over
+		while (true) {
+			const auto token = peek();
+			const auto type = token.has_value() ? token->Type() : TokenType::T_SEMI;
+			const auto& power = bindingPower(type);
+			if (power.PostfixLeft) {
+				while (m_operators.size() > operatorMark && m_operators.back().RightPower > power.PostfixLeft)
+					reduce_operator();
+				m_operands.back() = make_unary_expression(consume(), m_operands.back(), true);
+				continue;
+			}
+			if (type == TokenType::T_CLOSE_PAREN && m_operators.size() > operatorMark) {
+				while (m_operators.size() > operatorMark && m_operators.back().Op.Type() != TokenType::T_OPEN_PAREN)
+					reduce_operator();
+				// Otherwise the ')' belongs to whatever the expression is in, e.g. an if's condition
+				if (m_operators.size() > operatorMark) {
+					m_operators.pop_back();
+					consume();
+					continue;
+				}
+			}
+			if (power.InfixLeft) {
+				while (m_operators.size() > operatorMark && m_operators.back().RightPower > power.InfixLeft)
+					reduce_operator();
+				m_operators.push_back({ .Op = consume(), .RightPower = power.InfixRight, .Prefix = false });
+				break;
+			}
+
+			while (m_operators.size() > operatorMark) {
+				if (m_operators.back().Op.Type() == TokenType::T_OPEN_PAREN)
+					must_consume(TokenType::T_CLOSE_PAREN); // Reports the unclosed parenthesis
+				reduce_operator();
+			}
+			auto* expression = m_operands.back();
+			m_operands.resize(operandMark);
+			return expression;
+		}
+	}
+}
+
+void Parser::reduce_operator()
+{
+	const auto pending = m_operators.back();
+	m_operators.pop_back();
+	auto* rhs = m_operands.back();
+	if (pending.Prefix) {
+		m_operands.back() = make_unary_expression(pending.Op, rhs, false);
+		return;
+	}
+	m_operands.pop_back();
+	m_operands.back() = make_binary_expression(m_operands.back(), pending.Op, rhs);
+}
+
+BinaryExpression* Parser::make_binary_expression(Expression* lhs, const Token& op, Expression* rhs)
+{
+	if (isAssignmentOp(op.Type())) {
+		if (lhs->Kind() == NodeKind::Identifier) {
+			auto ident = static_cast<Identifier*>(lhs);
+			auto* declaration = find_variable(ident->Symbol());
+			if (!ident->Assignable() || (declaration && !declaration->Ident().Assignable()))
+				m_error->Error(op.Line(),
+							   op.Column() + 1,
+							   op.Position() + 1,
+							   "Cannot assign to constant '{}'",
+							   ident->Name());
+		}
+		else if (lhs->Kind() != NodeKind::MemberExpression)
+			m_error->Error(op.Line(), op.Column(), op.Position(), "Expression is not assignable");
+	}
+	return make<BinaryExpression>(lhs, rhs, op.Type());
+}
+
+} // namespace alx
@@ -7,29 +7,41 @@
 //
 
 #include "Parser.h"
+
+#include <algorithm>
+#include <iterator>
+
 #include "../Utils/Types.h"
 #include "../Utils/Utils.h"
 namespace alx {
 
-std::unique_ptr<NumberLiteral> Parser::parse_number_literal()
+NumberLiteral* Parser::parse_number_literal()
 {
-	if ((peek().has_value() && peek().value().Type == TokenType::T_INT_L)
-		|| peek().value().Type == TokenType::T_FLOAT_L || peek().value().Type == TokenType::T_DOUBLE_L ||
-		peek().value().Type == TokenType::T_TRUE || peek().value().Type == TokenType::T_FALSE)
+	if ((peek().has_value() && peek().value().Type() == TokenType::T_INT_L)
+		|| peek().value().Type() == TokenType::T_FLOAT_L || peek().value().Type() == TokenType::T_DOUBLE_L ||
+		peek().value().Type() == TokenType::T_TRUE || peek().value().Type() == TokenType::T_FALSE)
 	{
 		auto valueToken = consume();
-		return std::make_unique<NumberLiteral>(valueToken.Type, valueToken.Value.value());
+		auto value = valueToken.Value();
+		// Grouping commas are dropped from the text that goes into assembly. Most literals have none and keep
+		// pointing into the source.
+		if (value.find(',') != std::string_view::npos) {
+			std::string digits;
+			std::remove_copy(value.begin(), value.end(), std::back_inserter(digits), ',');
+			value = m_program->Arena().CopyString(digits);
+		}
+		return make<NumberLiteral>(valueToken.Type(), value, valueToken.Number());
 	}
 	return nullptr;
 }
 
-std::unique_ptr<StringLiteral> Parser::parse_string_literal()
+StringLiteral* Parser::parse_string_literal()
 {
 	ASSERT_NOT_IMPLEMENTED();
-	if (peek().has_value() && peek().value().Type == TokenType::T_STR_L)
+	if (peek().has_value() && peek().value().Type() == TokenType::T_STR_L)
 	{
 		
-	return std::unique_ptr<StringLiteral>();
+	return nullptr;
 	}
 	return nullptr;
 }
@@ -10,90 +10,73 @@
 
 namespace alx {
 
-std::unique_ptr<MemberExpression> Parser::parse_member_expression()
+MemberExpression* Parser::parse_member_expression()
 {
 	auto identifier = must_consume(TokenType::T_IDENTIFIER);
-	auto identPtr = std::make_unique<Identifier>(identifier.Value.value());
-	auto accessor = consume().Type; // This is always either a '.', '->' or '::' as checked by Parser::parse_term()
+	auto identPtr = make<Identifier>(identifier);
+	auto accessor = consume().Type(); // This is always either a '.', '->' or '::' as checked by Parser::parse_term()
 	auto property = must_consume(TokenType::T_IDENTIFIER);
-	auto memPtr = std::make_unique<Identifier>(property.Value.value());
+	auto memPtr = make<Identifier>(property);
 
 	// Find the identifier in the AST
-	auto object = m_variables.find(Parser::get_fully_qualified_name(identifier.Value.value(), m_current_scope_name));
-	if (object == m_variables.end())
-		m_error->Error(identifier.LineNumber,
-					   identifier.ColumnNumber,
-					   identifier.PosNumber,
+	auto* object = find_variable(identifier.Symbol());
+	if (!object)
+		m_error->Error(identifier.Line(),
+					   identifier.Column(),
+					   identifier.Position(),
 					   "Use of undeclared identifier '{}'",
-					   identPtr.get()->Name());
+					   identPtr->Name());
 
 	// TODO: Need to rethink this when the class or struct definitions get hoisted eventually
 	// TODO: Verify that the access level is not private or protected in this context
-	// Find the initialisation of the struct or class
-	const auto& structDecl =
-		std::find_if(m_program->GetChildren().begin(), m_program->GetChildren().end(), [&object](const auto& child)
-		{
-		  if (child->class_name() == "StructDeclaration")
-		  {
-			  const auto& it = static_cast<StructDeclaration&>(*child);
-			  return it.Name() == (*object).second->TypeName();
-		  }
-		  return false;
-		});
+	// Find the declaration of the struct or class
+	auto* type = object && object->TypeIndex() == 1
+		? m_globals->FindType(object->TypeAsIdentifier()->Symbol(), m_index)
+		: nullptr;
 	// Find the accessed variable in the struct
-	if (structDecl != m_program->GetChildren().end())
+	if (type && type->Kind() == NodeKind::StructDeclaration)
 	{
-		const auto& structDeclaration = static_cast<StructDeclaration&>(**structDecl);
+		const auto& structDeclaration = static_cast<StructDeclaration&>(*type);
 		const auto& member = std::find_if(structDeclaration.Members().begin(),
 										  structDeclaration.Members().end(),
 										  [&property](const auto& var)
 										  {
 											const auto& mem = static_cast<VariableDeclaration&>(*var);
-											return mem.Name() == property.Value.value();
+											return mem.Symbol() == property.Symbol();
 										  });
 		if (member != structDeclaration.Members().end())
-			return std::make_unique<MemberExpression>(accessor, std::move(identPtr), std::move(memPtr),
-													  static_cast<VariableDeclaration&>(**member).TypeAsPrimitive());
+			return make<MemberExpression>(
+				accessor, identPtr, memPtr, static_cast<VariableDeclaration&>(**member).TypeAsPrimitive());
 
-		m_error->Error(property.LineNumber,
-					   property.ColumnNumber,
-					   property.PosNumber,
+		m_error->Error(property.Line(),
+					   property.Column(),
+					   property.Position(),
 					   "No member '{}' in '{}'",
-					   property.Value.value(),
-					   identifier.Value.value());
+					   property.Value(),
+					   identifier.Value());
 	}
 	// If not found in struct, try classes
-	const auto& classDecl =
-		std::find_if(m_program->GetChildren().begin(), m_program->GetChildren().end(), [&object](const auto& child)
-		{
-		  if (child->class_name() == "ClassDeclaration")
-		  {
-			  const auto& it = static_cast<ClassDeclaration&>(*child);
-			  return it.Name() == (*object).second->Name();
-		  }
-		  return false;
-		});
 	// Find the accessed variable in the class
-	if (classDecl != m_program->GetChildren().end())
+	if (type && type->Kind() == NodeKind::ClassDeclaration)
 	{
-		const auto& classDeclaration = static_cast<ClassDeclaration&>(**classDecl);
+		const auto& classDeclaration = static_cast<ClassDeclaration&>(*type);
 		const auto& member = std::find_if(classDeclaration.Members().begin(),
 										  classDeclaration.Members().end(),
 										  [&property](const auto& var)
 										  {
 											const auto& mem = static_cast<VariableDeclaration&>(*var);
-											return mem.Name() == property.Value.value();
+											return mem.Symbol() == property.Symbol();
 										  });
 		if (member != classDeclaration.Members().end())
-			return std::make_unique<MemberExpression>(accessor, std::move(identPtr), std::move(memPtr),
-													  static_cast<VariableDeclaration&>(**member).TypeAsPrimitive());
+			return make<MemberExpression>(
+				accessor, identPtr, memPtr, static_cast<VariableDeclaration&>(**member).TypeAsPrimitive());
 
-		m_error->Error(property.LineNumber,
-					   property.ColumnNumber,
-					   property.PosNumber,
+		m_error->Error(property.Line(),
+					   property.Column(),
+					   property.Position(),
 					   "No member '{}' in '{}'",
-					   property.Value.value(),
-					   identifier.Value.value());
+					   property.Value(),
+					   identifier.Value());
 	}
 	ASSERT_NOT_REACHABLE();
 }
@@ -9,7 +9,7 @@
 #include "Parser.h"
 namespace alx {
 
-std::unique_ptr<ReturnStatement> Parser::parse_return_statement()
+ReturnStatement* Parser::parse_return_statement()
 {
 	auto returnToken = consume(); // Eat 'return'
 
@@ -17,7 +17,7 @@ std::unique_ptr<ReturnStatement> Parser::parse_return_statement()
 //	auto funcIterator = std::find_if(m_program->GetChildren().begin(), m_program->GetChildren().end(),
 //									 [&](const std::unique_ptr<ASTNode>& node)
 //									 {
-//									   if (node->class_name() == "FunctionDeclaration")
+//									   if (node->Kind() == NodeKind::FunctionDeclaration)
 //									   {
 //										   return static_cast<FunctionDeclaration&>(*node).Name()
 //											   == m_current_scope_name;
@@ -34,53 +34,55 @@ std::unique_ptr<ReturnStatement> Parser::parse_return_statement()
 	if (returnType == TokenType::T_VOID)
 	{
 		auto nextToken = peek();
-		if (nextToken.has_value() && nextToken.value().Type != TokenType::T_SEMI)
+		if (nextToken.has_value() && nextToken.value().Type() != TokenType::T_SEMI)
 		{
-			m_error->Error(returnToken.LineNumber,
-						   returnToken.ColumnNumber,
-						   returnToken.PosNumber,
+			m_error->Error(returnToken.Line(),
+						   returnToken.Column(),
+						   returnToken.Position(),
 						   "Void function '{}' should not return a value",
-						   m_current_scope_name);
+						   current_scope_name());
 		}
 	}
 	auto expr = parse_expression();
+	if (!expr)
+		return nullptr;
 
-	if (expr->class_name() == "NumberLiteral")
+	if (expr->Kind() == NodeKind::NumberLiteral)
 	{
 		auto& numLit = static_cast<NumberLiteral&>(*expr);
 		if (literal_to_type(numLit.Type()) != returnType)
-			m_error->Error(returnToken.LineNumber,
-						   returnToken.ColumnNumber,
-						   returnToken.PosNumber,
+			m_error->Error(returnToken.Line(),
+						   returnToken.Column(),
+						   returnToken.Position(),
 						   "Function '{}' must return '{}', returns '{}' instead",
-						   m_current_scope_name,
+						   current_scope_name(),
 						   token_to_string(returnType),
 						   token_to_string(numLit.Type()));
 	}
-	else if (expr->class_name() == "StringLiteral")
+	else if (expr->Kind() == NodeKind::StringLiteral)
 	{
 		if (TokenType::T_STRING != returnType)
-			m_error->Error(returnToken.LineNumber,
-						   returnToken.ColumnNumber,
-						   returnToken.PosNumber,
+			m_error->Error(returnToken.Line(),
+						   returnToken.Column(),
+						   returnToken.Position(),
 						   "Function '{}' must return '{}', returns '{}' instead",
-						   m_current_scope_name,
+						   current_scope_name(),
 						   token_to_string(returnType),
 						   token_to_string(TokenType::T_STRING));
 	}
-	else if (expr->class_name() == "MemberExpression")
+	else if (expr->Kind() == NodeKind::MemberExpression)
 	{
 		ASSERT_NOT_IMPLEMENTED();
 //		auto& memberExpression = static_cast<MemberExpression&>(*expr);
 //		if (TokenType::T_STRING != returnType)
-//			m_error->Error(returnToken.LineNumber,
-//						   returnToken.ColumnNumber,
-//						   returnToken.PosNumber,
+//			m_error->Error(returnToken.Line(),
+//						   returnToken.Column(),
+//						   returnToken.Position(),
 //						   "Function '{}' must return '{}'",
 //						   m_current_scope_name,
 //						   token_to_string(returnType)); // FIXME: Get the type of the member
 	}
 
-	return std::make_unique<ReturnStatement>(std::move(expr));
+	return make<ReturnStatement>(expr);
 }
 };
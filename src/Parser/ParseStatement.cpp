@@ -11,7 +11,7 @@
 #include "Parser.h"
 
 namespace alx {
-std::unique_ptr<ASTNode> Parser::parse_statement()
+ASTNode* Parser::parse_statement()
 {
 	auto token = peek();
 	auto nextToken = peek(1);
@@ -19,21 +19,21 @@ std::unique_ptr<ASTNode> Parser::parse_statement()
 	
 	if (!token.has_value())
 		return nullptr;
-	switch (token.value().Type) {
+	switch (token.value().Type()) {
 	case TokenType::T_DEPRECATED: // FIXME: If we have a deprecated const, parse_variable() will fail
 		[[fallthrough]];
 	case TokenType::T_CONST:
-		if (nextToken.has_value() && isNumberType(nextToken.value().Type)) {
-			if (nextNextToken.has_value() && nextNextToken.value().Type == TokenType::T_IDENTIFIER)
+		if (nextToken.has_value() && isNumberType(nextToken.value().Type())) {
+			if (nextNextToken.has_value() && nextNextToken.value().Type() == TokenType::T_IDENTIFIER)
 				return parse_variable();
-			m_error->FatalError(token.value().LineNumber,
-								token.value().ColumnNumber,
-								token.value().PosNumber,
+			m_error->FatalError(token.value().Line(),
+								token.value().Column(),
+								token.value().Position(),
 								"Expected identifier after type declaration");
 		}
-		m_error->FatalError(token.value().LineNumber,
-							token.value().ColumnNumber,
-							token.value().PosNumber,
+		m_error->FatalError(token.value().Line(),
+							token.value().Column(),
+							token.value().Position(),
 							"Expected type after 'const' keyword");
 		return nullptr;
 	case TokenType::T_INT:
@@ -51,17 +51,24 @@ std::unique_ptr<ASTNode> Parser::parse_statement()
 	case TokenType::T_CHAR:
 		[[fallthrough]];
 	case TokenType::T_BOOL:
-		if (nextToken.has_value() && nextToken.value().Type == TokenType::T_IDENTIFIER) {
-			if (nextNextToken.has_value() && nextNextToken.value().Type == TokenType::T_OPEN_PAREN)
+		if (nextToken.has_value() && nextToken.value().Type() == TokenType::T_IDENTIFIER) {
+			if (nextNextToken.has_value() && nextNextToken.value().Type() == TokenType::T_OPEN_PAREN)
 				return parse_function();
-			else if ((nextNextToken.has_value() && nextNextToken.value().Type == TokenType::T_EQ)
-					 || nextNextToken.value().Type == TokenType::T_SEMI)
+			else if (nextNextToken.has_value()
+					 && (nextNextToken.value().Type() == TokenType::T_EQ
+						 || nextNextToken.value().Type() == TokenType::T_SEMI))
 				return parse_variable();
+			const auto unexpected = nextNextToken.value_or(nextToken.value());
+			m_error->FatalError(unexpected.Line(),
+								unexpected.Column(),
+								unexpected.Position(),
+								"Expected '=', ';' or '(' after '{}'",
+								nextToken.value().Value());
 		}
 		else
-			m_error->FatalError(token.value().LineNumber,
-								token.value().ColumnNumber,
-								token.value().PosNumber,
+			m_error->FatalError(token.value().Line(),
+								token.value().Column(),
+								token.value().Position(),
 								"Expected identifier after type declaration");
 		return nullptr;
 	case TokenType::T_VOID:
@@ -71,9 +78,9 @@ std::unique_ptr<ASTNode> Parser::parse_statement()
 	case TokenType::T_IF:
 		return parse_if_statement();
 	case TokenType::T_ELSE:
-		m_error->Error(token.value().LineNumber,
-					   token.value().ColumnNumber,
-					   token.value().PosNumber,
+		m_error->Error(token.value().Line(),
+					   token.value().Column(),
+					   token.value().Position(),
 					   "An 'else' statement must succeed an 'if' statement");
 		return nullptr; // TODO: verify that this is appropriate
 	case TokenType::T_FOR:
@@ -83,7 +90,7 @@ std::unique_ptr<ASTNode> Parser::parse_statement()
 	case TokenType::T_STRUCT:
 		return parse_struct_declaration();
 	case TokenType::T_IDENTIFIER:
-		if (nextToken.value().Type == TokenType::T_IDENTIFIER)
+		if (nextToken.has_value() && nextToken.value().Type() == TokenType::T_IDENTIFIER)
 			return parse_variable();
 		[[fallthrough]];
 	default:
@@ -91,4 +98,43 @@ std::unique_ptr<ASTNode> Parser::parse_statement()
 	}
 }
 
+ASTNode* Parser::parse_terminated_statement()
+{
+	auto statement = parse_statement();
+	if (statement)
+		consume_semicolon(statement);
+	return statement;
+}
+
+std::span<ASTNode*> Parser::parse_body()
+{
+	const auto mark = m_pending.size();
+	if (!peek().has_value()) {
+		const auto previous = peek(-1).value();
+		m_error->FatalError(previous.Line(), previous.Column(), previous.Position(), "Expected statement");
+	}
+	if (m_block_depth == MaxBlockDepth) {
+		const auto token = peek().value();
+		m_error->FatalError(token.Line(),
+							token.Column(),
+							token.Position(),
+							"Blocks can't be nested more than {} deep",
+							MaxBlockDepth);
+	}
+	++m_block_depth;
+	m_symbols.EnterScope(ScopeKind::Block);
+	if (try_consume(TokenType::T_CURLY_OPEN)) {
+		while (peek().has_value() && peek().value().Type() != TokenType::T_CURLY_CLOSE) {
+			if (auto statement = parse_or_recover([this] { return parse_terminated_statement(); }))
+				m_pending.push_back(statement);
+		}
+		must_consume(TokenType::T_CURLY_CLOSE);
+	}
+	else if (auto statement = parse_or_recover([this] { return parse_terminated_statement(); }))
+		m_pending.push_back(statement);
+	m_symbols.ExitScope();
+	--m_block_depth;
+	return take_pending(mark);
+}
+
 }
@@ -9,33 +9,23 @@
 #include "Parser.h"
 
 namespace alx {
-std::unique_ptr<UnaryExpression> Parser::parse_unary_expression()
+UnaryExpression* Parser::make_unary_expression(const Token& op, Expression* operand, bool postfix)
 {
-	auto op = consume();
-	auto rhs = parse_term();
-	
-	if (op.Type == TokenType::T_SUB || op.Type == TokenType::T_ADD)
+	if (op.Type() == TokenType::T_SUB || op.Type() == TokenType::T_ADD)
 	{
-		if (!rhs || rhs->class_name() != "Identifier") // FIXME: allow member expressions
-		{
-			// TODO: get variable from m_variables and check if it's const
-			m_error->Error(op.LineNumber, op.ColumnNumber + 1, op.PosNumber + 1, "Expression is not assignable");
-			return nullptr;
-		}
-		else if (rhs->class_name() == "Identifier") {
-			auto ident = static_cast<Identifier*>(rhs.get());
-			if (!ident->Assignable()) {
-				m_error->Error(op.LineNumber,
-							   op.ColumnNumber + 1,
-							   op.PosNumber + 1,
+		if (operand->Kind() != NodeKind::Identifier) // FIXME: allow member expressions
+			m_error->Error(op.Line(), op.Column() + 1, op.Position() + 1, "Expression is not assignable");
+		else {
+			auto ident = static_cast<Identifier*>(operand);
+			auto* declaration = find_variable(ident->Symbol());
+			if (!ident->Assignable() || (declaration && !declaration->Ident().Assignable()))
+				m_error->Error(op.Line(),
+							   op.Column() + 1,
+							   op.Position() + 1,
 							   "Cannot assign to constant '{}'",
 							   ident->Name());
-				return nullptr;
-			}
 		}
 	}
-	if (!rhs)
-		return nullptr;
-	return std::make_unique<UnaryExpression>(std::move(rhs), op.Type);
+	return make<UnaryExpression>(operand, op.Type(), postfix);
+}
 }
-}
\ No newline at end of file
@@ -16,6 +16,9 @@
 
 #include "Parser.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <utility>
 
 #include "../Utils/Utils.h"
@@ -23,59 +26,281 @@
 
 namespace alx {
 
-Parser::Parser(std::vector<Token> tokens, const std::shared_ptr<ErrorHandler>& errorHandler)
-  : m_tokens(std::move(tokens)),
-	m_error(errorHandler)
+Parser::Parser(TokenBuffer tokens,
+			   const std::shared_ptr<ErrorHandler>& errorHandler,
+			   const std::shared_ptr<Interner>& interner)
+  : m_tokens(std::make_shared<const TokenBuffer>(std::move(tokens))),
+	m_end(m_tokens->Size()),
+	m_globals(std::make_shared<GlobalScope>()),
+	m_error(errorHandler),
+	m_interner(interner)
 {
-	m_binary_op_precedence[TokenType::T_LT] = 10;
-	m_binary_op_precedence[TokenType::T_GT] = 10;
-	m_binary_op_precedence[TokenType::T_PLUS] = 20;
-	m_binary_op_precedence[TokenType::T_MINUS] = 20;
-	m_binary_op_precedence[TokenType::T_STAR] = 30;
-	m_binary_op_precedence[TokenType::T_FWD_SLASH] = 30;
+	m_program = std::make_unique<Program>();
+}
 
+Parser::Parser(const Parser& parent, const std::shared_ptr<ErrorHandler>& errorHandler)
+  : m_tokens(parent.m_tokens),
+	m_end(parent.m_end),
+	m_globals(parent.m_globals),
+	m_error(errorHandler),
+	m_interner(parent.m_interner)
+{
 	m_program = std::make_unique<Program>();
 }
 
-int Parser::get_binary_op_precedence(const Token& token) { return m_binary_op_precedence.find(token.Type)->second; }
+std::unique_ptr<Program> Parser::Parse(size_t threads)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads > 1) {
+		if (auto regions = find_top_level_regions(); regions && regions->size() > 1)
+			return parse_in_parallel(*regions, threads);
+	}
+	RegionResult result;
+	result.Errors = m_error;
+	parse_region({ .Begin = 0, .End = m_tokens->Size(), .IsType = false }, result);
+	return merge_regions({ &result, 1 });
+}
+
+namespace {
 
-std::unique_ptr<Program> Parser::Parse()
+void addFunctions(const Program* program, std::unordered_set<SymbolId>& functions)
 {
+	if (!program)
+		return;
+	for (const auto* statement : program->GetChildren()) {
+		if (statement->Kind() == NodeKind::FunctionDeclaration)
+			functions.insert(static_cast<const FunctionDeclaration*>(statement)->Symbol());
+	}
+}
+
+} // namespace
+
+IncrementalParse Parser::Reparse(std::unique_ptr<Program> previous, std::span<const SourceEdit> edits)
+{
+	IncrementalParse parse;
+	const auto regions = find_top_level_regions();
+	const auto fullParse = [&] {
+		parse.Ast = Parse();
+		addFunctions(previous.get(), parse.ChangedFunctions);
+		addFunctions(parse.Ast.get(), parse.ChangedFunctions);
+		return std::move(parse);
+	};
+	if (!previous || !regions)
+		return fullParse();
+
+	// Match every declaration the edits didn't touch with the one it was before them. Declarations, edits and the
+	// previous statements are all in source order, so one pass over each will do.
+	const auto previousStatements = previous->GetChildren();
+	const auto previousSpans = previous->Spans();
+	std::vector<SourceSpan> spans;
+	for (const auto& region : *regions)
+		spans.push_back(
+			{ .Begin = m_tokens->At(region.Begin).Offset(), .End = m_tokens->At(region.End - 1).Position() + 1 });
+	std::vector<ASTNode*> reused(regions->size());
+	std::vector<bool> kept(previousStatements.size());
+	size_t edit = 0;
+	size_t statement = 0;
+	ptrdiff_t shift = 0; // How far the edits before the declaration moved it
+	for (size_t i = 0; i < regions->size(); ++i) {
+		const auto& span = spans[i];
+		// An edit right up against a declaration may have joined onto it, so that counts as touching it too
+		for (; edit < edits.size(); ++edit) {
+			const auto editBegin = static_cast<size_t>(static_cast<ptrdiff_t>(edits[edit].Begin) + shift);
+			if (editBegin + edits[edit].Length >= span.Begin)
+				break;
+			shift += edits[edit].Shift();
+		}
+		if (edit < edits.size()
+			&& static_cast<size_t>(static_cast<ptrdiff_t>(edits[edit].Begin) + shift) <= span.End)
+			continue;
+
+		const SourceSpan before{ .Begin = static_cast<size_t>(static_cast<ptrdiff_t>(span.Begin) - shift),
+								 .End = static_cast<size_t>(static_cast<ptrdiff_t>(span.End) - shift) };
+		while (statement < previousSpans.size() && previousSpans[statement].Begin < before.Begin)
+			++statement;
+		if (statement < previousSpans.size() && previousSpans[statement] == before) {
+			reused[i] = previousStatements[statement];
+			kept[statement] = true;
+		}
+	}
+	for (size_t i = 0; i < regions->size(); ++i) {
+		if ((*regions)[i].IsType && !reused[i])
+			return fullParse();
+	}
+	for (size_t i = 0; i < previousStatements.size(); ++i) {
+		if (previousStatements[i]->Kind() == NodeKind::StructDeclaration && !kept[i])
+			return fullParse();
+	}
+
+	// Structs are parsed again even when unchanged, which puts them in the global scope at their new position
+	std::vector<RegionResult> results(regions->size());
+	for (size_t i = 0; i < regions->size(); ++i) {
+		auto& result = results[i];
+		result.Errors = m_error;
+		if (reused[i] && reused[i]->Kind() == NodeKind::FunctionDeclaration) {
+			result.Begin = (*regions)[i].Begin;
+			result.Statements.push_back(reused[i]);
+			result.Spans.push_back(spans[i]);
+			continue;
+		}
+		parse_region((*regions)[i], result);
+		for (const auto* parsed : result.Statements) {
+			if (parsed->Kind() == NodeKind::FunctionDeclaration)
+				parse.ChangedFunctions.insert(static_cast<const FunctionDeclaration*>(parsed)->Symbol());
+		}
+	}
+	for (size_t i = 0; i < previousStatements.size(); ++i) {
+		if (!kept[i] && previousStatements[i]->Kind() == NodeKind::FunctionDeclaration)
+			parse.ChangedFunctions.insert(static_cast<const FunctionDeclaration*>(previousStatements[i])->Symbol());
+	}
+
+	m_program->Absorb(*previous);
+	parse.Ast = merge_regions(results);
+	return parse;
+}
+
+void Parser::parse_region(const Region& region, RegionResult& result)
+{
+	m_index = region.Begin;
+	m_end = region.End;
+	m_error = result.Errors;
+	m_skipped_statements = false;
+	result.Begin = region.Begin;
 	try {
 		while (peek().has_value()) {
-			m_program->Append(parse_statement());
+			const auto begin = m_tokens->At(m_index).Offset();
+			if (auto statement = parse_or_recover([this] { return parse_statement(); })) {
+				result.Statements.push_back(statement);
+				result.Spans.push_back({ .Begin = begin, .End = m_tokens->At(m_index - 1).Position() + 1 });
+			}
 		}
 	}
-	catch (CompilerError& err) {
-		m_error->EmitErrorCount();
-		exit(1);
+	catch (CompilerError&) {
+		m_skipped_statements = true;
+		result.Stopped = m_error->ErrorLimitReached();
 	}
 	catch (std::runtime_error& err) {
-		println(Colour::LightRed, "Something went wrong when building AST: {}", err.what());
-		println(Colour::LightRed, "Current AST:");
-		m_program->PrintNode(0);
-		m_error->EmitErrorCount();
-		exit(1);
+		result.Stopped = true;
+		result.Failure = err.what();
 	}
-	return std::move(m_program);
+	result.Skipped = m_skipped_statements;
+	result.StoppedAt = std::min(m_index, m_tokens->Size() - 1);
 }
 
-std::unique_ptr<Expression> Parser::parse_expression()
+std::optional<std::vector<Parser::Region>> Parser::find_top_level_regions() const
 {
-	auto lhs = parse_term();
-	if (!lhs)
-		return nullptr;
+	const auto& tokens = *m_tokens;
+	std::vector<Region> regions;
+	size_t depth = 0;
+	size_t begin = 0;
+	for (size_t i = 0; i < tokens.Size(); ++i) {
+		const auto type = tokens.At(i).Type();
+		if (type == TokenType::T_CURLY_OPEN)
+			++depth;
+		else if (type == TokenType::T_CURLY_CLOSE) {
+			if (depth == 0)
+				return {};
+			if (--depth == 0) {
+				regions.push_back({ .Begin = begin, .End = i + 1, .IsType = false });
+				begin = i + 1;
+			}
+		}
+	}
+	if (depth != 0 || begin != tokens.Size())
+		return {};
+
+	// Only function and struct declarations are known not to depend on anything but the structs before them
+	for (auto& region : regions) {
+		const auto first = tokens.At(region.Begin).Type();
+		region.IsType = first == TokenType::T_STRUCT;
+		const auto isFunction = (first == TokenType::T_VOID || first == TokenType::T_STRING || isNumberType(first))
+			&& region.Begin + 2 < region.End && tokens.At(region.Begin + 1).Type() == TokenType::T_IDENTIFIER
+			&& tokens.At(region.Begin + 2).Type() == TokenType::T_OPEN_PAREN;
+		if (!region.IsType && !isFunction)
+			return {};
+	}
+	return regions;
+}
+
+std::unique_ptr<Program> Parser::parse_in_parallel(const std::vector<Region>& regions, size_t threads)
+{
+	std::vector<RegionResult> results(regions.size());
+	for (auto& result : results)
+		result.Errors = m_error->Fork();
+
+	// Each parser has its own arena and scratch stacks, and takes the next unparsed function whenever it's done
+	threads = std::min(threads, regions.size());
+	std::vector<std::unique_ptr<Parser>> parsers;
+	for (size_t i = 0; i < threads; ++i)
+		parsers.push_back(std::unique_ptr<Parser>(new Parser(*this, m_error)));
 
-	auto bin = parse_binary_operation(std::move(lhs), 0);
-	return bin;
+	// Types go first and in order, so that they're all in the global scope before any function looks them up
+	for (size_t i = 0; i < regions.size(); ++i) {
+		if (regions[i].IsType)
+			parsers.front()->parse_region(regions[i], results[i]);
+	}
+
+	std::atomic<size_t> next{};
+	auto work = [&regions, &results, &next](Parser& parser) {
+		for (auto i = next++; i < regions.size(); i = next++) {
+			if (!regions[i].IsType)
+				parser.parse_region(regions[i], results[i]);
+		}
+	};
+	{
+		std::vector<std::jthread> pool;
+		for (size_t i = 1; i < threads; ++i)
+			pool.emplace_back(work, std::ref(*parsers[i]));
+		work(*parsers.front());
+	}
+
+	for (auto& parser : parsers)
+		m_program->Absorb(*parser->m_program);
+	return merge_regions(results);
 }
 
-std::unique_ptr<Expression> Parser::parse_term()
+std::unique_ptr<Program> Parser::merge_regions(std::span<RegionResult> results)
+{
+	bool complete = true;
+	for (auto& result : results) {
+		if (result.Errors != m_error) {
+			// The limit is per region while they're parsed, so it's applied again to the whole file here
+			if (result.Errors->ErrorCount() && m_error->ErrorLimitReached()) {
+				result.Stopped = true;
+				result.StoppedAt = result.Begin;
+			}
+			else
+				m_error->Join(*result.Errors);
+		}
+		for (size_t i = 0; i < result.Statements.size(); ++i)
+			m_program->Append(result.Statements[i], result.Spans[i]);
+		complete = complete && !result.Skipped;
+
+		if (!result.Failure.empty()) {
+			m_error->Flush();
+			println(Colour::LightRed, "Something went wrong when building AST: {}", result.Failure);
+			println(Colour::LightRed, "Current AST:");
+			m_program->PrintNode(0);
+			return nullptr;
+		}
+		if (result.Stopped) {
+			const auto last = m_tokens->At(result.StoppedAt);
+			m_error->NoteErrorLimit(last.Line(), last.Column(), last.Position());
+			return nullptr;
+		}
+	}
+	if (!complete)
+		return nullptr;
+	return std::move(m_program);
+}
+
+Expression* Parser::parse_term()
 {
 	auto token = peek();
 	if (!token.has_value())
-		return nullptr;
-	switch (token.value().Type) {
+		consume(); // Reports the unexpected end of file
+	switch (token.value().Type()) {
 	case TokenType::T_INT_L:
 		[[fallthrough]];
 	case TokenType::T_FLOAT_L:
@@ -92,63 +317,51 @@ std::unique_ptr<Expression> Parser::parse_term()
 		return parse_string_literal();
 	case TokenType::T_IDENTIFIER: {
 		if (peek(1).has_value()
-			&& (peek(1).value().Type == TokenType::T_DOT || peek(1).value().Type == TokenType::T_ARROW
-				|| peek(1).value().Type == TokenType::T_COLON_COLON))
+			&& (peek(1).value().Type() == TokenType::T_DOT || peek(1).value().Type() == TokenType::T_ARROW
+				|| peek(1).value().Type() == TokenType::T_COLON_COLON))
 			return parse_member_expression();
 
 		auto identifier = must_consume(TokenType::T_IDENTIFIER);
-		if (!find_variable_by_name(get_fully_qualified_name(identifier.Value.value(), m_current_scope_name)))
-			m_error->Error(identifier.LineNumber,
-						   identifier.ColumnNumber,
-						   identifier.PosNumber,
+		if (!find_variable(identifier.Symbol()))
+			m_error->Error(identifier.Line(),
+						   identifier.Column(),
+						   identifier.Position(),
 						   "Use of undeclared identifier '{}'",
-						   identifier.Value.value());
+						   identifier.Value());
 
-		return std::make_unique<Identifier>(identifier.Value.value());
+		return make<Identifier>(identifier);
 	}
-	case TokenType::T_OPEN_PAREN: {
-		consume();
-		auto expr = parse_expression();
-		must_consume(TokenType::T_CLOSE_PAREN);
-		return expr;
-	}
-	case TokenType::T_MINUS:
-		[[fallthrough]];
-	case TokenType::T_PLUS:
-		[[fallthrough]];
-	case TokenType::T_ADD:
-		[[fallthrough]];
-	case TokenType::T_SUB:
-		[[fallthrough]];
-	case TokenType::T_NOT:
-		return parse_unary_expression();
 	default:
-		m_error->Error(token->LineNumber,
-					   token->ColumnNumber,
-					   token->PosNumber,
-					   "Unexpected token '{}'",
-					   token_to_string(token->Type));
+		m_error->FatalError(token->Line(),
+							token->Column(),
+							token->Position(),
+							"Unexpected token '{}'",
+							token_to_string(token->Type()));
 	}
 	ASSERT_NOT_REACHABLE();
 }
 
 std::optional<Token> Parser::peek(int ahead)
 {
-	if (m_index + ahead < m_tokens.size())
-		return m_tokens.at(m_index + ahead);
+	if (m_index + ahead < m_end)
+		return m_tokens->At(m_index + ahead);
 	return {};
 }
 
 Token Parser::consume()
 {
-	auto token = m_tokens.at(m_index);
+	if (m_index >= m_end) {
+		const auto last = m_tokens->At(m_end - 1);
+		m_error->FatalError(last.Line(), last.Column(), last.Position(), "Unexpected end of file");
+	}
+	auto token = m_tokens->At(m_index);
 	++m_index;
 	return token;
 }
 
 std::optional<Token> Parser::try_consume(TokenType type)
 {
-	if (peek().has_value() && peek().value().Type == type)
+	if (peek().has_value() && peek().value().Type() == type)
 		return consume();
 	return {};
 }
@@ -158,34 +371,49 @@ Token Parser::must_consume(TokenType token)
 	if (auto tok = try_consume(token)) {
 		return tok.value();
 	}
-	m_error->Error(peek(-1).value().LineNumber,
-				   peek(-1).value().ColumnNumber,
-				   peek(-1).value().PosNumber,
-				   "Expected token '{}' after '{}'",
-				   token_to_string(token),
-				   token_to_string(peek(-1).value().Type));
-	exit(EXIT_FAILURE);
+	const auto previous = m_tokens->At(m_index > 0 ? m_index - 1 : 0);
+	m_error->FatalError(previous.Line(),
+						previous.Column(),
+						previous.Position(),
+						"Expected token '{}' after '{}'",
+						token_to_string(token),
+						token_to_string(previous.Type()));
+	ASSERT_NOT_REACHABLE();
 }
 
-void Parser::consume_semicolon(const std::unique_ptr<ASTNode>& statement)
+void Parser::consume_semicolon(const ASTNode* statement)
 {
-	if (statement->class_name() != "IfStatement" && statement->class_name() != "WhileStatement"
-		&& statement->class_name() != "StructDeclaration")
+	if (statement->Kind() != NodeKind::IfStatement && statement->Kind() != NodeKind::WhileStatement
+		&& statement->Kind() != NodeKind::StructDeclaration)
 		must_consume(TokenType::T_SEMI);
 }
 
-void Parser::add_variable(VariableDeclaration* var) { m_variables[var->FullyQualifiedName()] = var; }
-
-std::string Parser::get_fully_qualified_name(const std::string& name, const std::string& scope)
+std::span<ASTNode*> Parser::take_pending(size_t mark)
 {
-	if (scope.empty())
-		return name;
-	return scope + "::" + name;
+	auto children = m_program->Arena().Copy<ASTNode*>(std::span(m_pending).subspan(mark));
+	m_pending.resize(mark);
+	return children;
 }
 
-bool Parser::find_variable_by_name(const std::string& qualifiedName)
+void Parser::synchronise(size_t statementStart)
 {
-	return m_variables.find(qualifiedName) != m_variables.end();
+	// Skip to the end of the statement: past its ';', or past its block if it had one. A '}' closing the enclosing
+	// block is left for the enclosing block, unless the statement never got past it, in which case it's stray.
+	int depth = 0;
+	while (auto token = peek()) {
+		const auto type = token->Type();
+		if (type == TokenType::T_CURLY_CLOSE && depth == 0 && m_index > statementStart)
+			return;
+		consume();
+		if (type == TokenType::T_CURLY_OPEN)
+			++depth;
+		else if (type == TokenType::T_CURLY_CLOSE && (depth == 0 || --depth == 0))
+			return;
+		else if (type == TokenType::T_SEMI && depth == 0)
+			return;
+	}
 }
 
+void Parser::add_variable(VariableDeclaration* var) { m_symbols.Declare(var); }
+
 } // namespace alx
\ No newline at end of file
@@ -7,64 +7,169 @@
 //
 
 #pragma once
-#include <map>
 #include <list>
-#include <unordered_map>
+#include <span>
+#include <unordered_set>
 #include "../AST/Ast.h"
+#include "SymbolTable.h"
 #include "../libs/Println.h"
 #include "../Tokeniser/Tokeniser.h"
 
 namespace alx {
 
+// A file parsed again after an edit. The functions whose text the edit didn't touch are the previous Program's own
+// nodes; the rest were parsed from scratch.
+struct IncrementalParse {
+	std::unique_ptr<Program> Ast; // Null if there were syntax errors
+	// Functions that were edited, added or removed, which are the only ones later stages need to look at again
+	std::unordered_set<SymbolId> ChangedFunctions;
+};
+
 class Parser
 {
-	std::map<TokenType, int> m_binary_op_precedence;
-	std::vector<Token> m_tokens;
+	// An operator waiting for its right operand. A '(' sits on the stack too, with no binding power so that nothing
+	// reduces past it until its ')' turns up.
+	struct PendingOperator {
+		Token Op;
+		uint8_t RightPower;
+		bool Prefix;
+	};
+
+	// A top-level declaration's tokens, found by matching braces before any parsing starts
+	struct Region {
+		size_t Begin;
+		size_t End;
+		bool IsType; // Struct declarations are parsed before any function so the functions can look them up
+	};
+	struct RegionResult {
+		std::vector<ASTNode*> Statements;
+		std::vector<SourceSpan> Spans;
+		std::shared_ptr<ErrorHandler> Errors;
+		size_t Begin{};
+		bool Skipped{};	  // Same as m_skipped_statements
+		bool Stopped{};	  // Parsing gave up: the error limit was reached, or there was an internal error if Failure is set
+		size_t StoppedAt{}; // Token the parser stopped at
+		std::string Failure;
+	};
+
+	std::shared_ptr<const TokenBuffer> m_tokens; // Shared with the parsers working on other regions
 	std::unique_ptr<Program> m_program;
 	size_t m_index{};
-	std::string m_current_scope_name;
-	std::variant<TokenType, std::unique_ptr<Identifier>> m_current_return_type;
-	
-	// FIXME: It is not unreasonable that a project may contain tens of thousands of variables.
-	//     	  Therefore we might want to split this hashmap by scope e.g. 
-	//     	  std::unordered_map<std::string, std::unordered_map<std::string, VariableDeclaration*>> m_variables;
-	//                                ^ scope name                        	^ variable name
-	std::unordered_map<std::string, VariableDeclaration*> m_variables;
-
-	int get_binary_op_precedence(const Token& token);
+	size_t m_end{}; // Parsing stops here as if it was the end of the file
+	std::shared_ptr<GlobalScope> m_globals;
+	SymbolId m_current_scope{ NoSymbol };
+	std::variant<TokenType, Identifier*> m_current_return_type;
+	// Statements of the scopes currently being parsed, used as a stack. Each scope copies its own
+	// range into the arena once it's complete, so child arrays end up contiguous without a vector per node.
+	std::vector<ASTNode*> m_pending;
+	SymbolTable m_symbols;
+	// The parser and the stages after it walk blocks by recursing, so how deeply they nest is limited to what's sure to
+	// fit on a thread's stack, as C compilers limit the nesting of brackets
+	static constexpr size_t MaxBlockDepth = 256;
+	size_t m_block_depth{}; // How many if, else and while bodies the statement being parsed is inside
+	bool m_skipped_statements{}; // Set once a syntax error has been recovered from
+	// Operand and operator stacks of the expressions being parsed
+	std::vector<Expression*> m_operands;
+	std::vector<PendingOperator> m_operators;
 
 	std::optional<Token> peek(int ahead = 0);
 	Token consume();
 	std::optional<Token> try_consume(TokenType);
 	Token must_consume(TokenType token);
 	std::shared_ptr<ErrorHandler> m_error;
+	std::shared_ptr<Interner> m_interner;
 	
+	// A parser for regions of the same file as `parent`, with an arena of its own
+	Parser(const Parser& parent, const std::shared_ptr<ErrorHandler>& errorHandler);
+
 public:
-	Parser(std::vector<Token> tokens, const std::shared_ptr<ErrorHandler>& errorHandler);
+	Parser(TokenBuffer tokens,
+		   const std::shared_ptr<ErrorHandler>& errorHandler,
+		   const std::shared_ptr<Interner>& interner);
 
-	[[nodiscard]] std::unique_ptr<Program> Parse();
+	// With more than one thread, a file made up of only function and struct declarations is split into those
+	// declarations and the functions are parsed in parallel. 0 uses a thread per core.
+	[[nodiscard]] std::unique_ptr<Program> Parse(size_t threads = 1);
+	// Parses the tokens of an edited file, taking over `previous`, which was parsed from the file before `edits`.
+	// Only the top-level declarations the edits touched are parsed again, so the rest keep the diagnostics they were
+	// given the first time. An edited struct can change how any function after it parses, so it means a full parse.
+	// Reused nodes still point into the source they were parsed from, which must outlive the new Program.
+	[[nodiscard]] IncrementalParse Reparse(std::unique_ptr<Program> previous, std::span<const SourceEdit> edits);
 	[[nodiscard]] const Program& GetAst() { return *m_program;}
 
 private:
-	std::unique_ptr<FunctionDeclaration> parse_function();
-	std::unique_ptr<VariableDeclaration> parse_variable();
-	std::unique_ptr<ASTNode> parse_statement();
-	std::unique_ptr<NumberLiteral> parse_number_literal();
-	std::unique_ptr<StringLiteral> parse_string_literal();
-	std::unique_ptr<Expression> parse_binary_operation(std::unique_ptr<Expression> lhs, int precedence);
-	std::unique_ptr<Expression> parse_expression();
-	std::unique_ptr<Expression> parse_term();
-	std::unique_ptr<ReturnStatement> parse_return_statement();
-	std::unique_ptr<IfStatement> parse_if_statement();
-	std::unique_ptr<WhileStatement> parse_while_statement();
-	std::unique_ptr<BlockStatement> parse_else_statement();
-	std::unique_ptr<UnaryExpression> parse_unary_expression();
-	std::unique_ptr<StructDeclaration> parse_struct_declaration();
-	std::unique_ptr<MemberExpression> parse_member_expression();
-	void consume_semicolon(const std::unique_ptr<ASTNode>& statement);
+	template<typename T, typename... Args>
+	T* make(Args&&... args)
+	{
+		return m_program->Arena().Make<T>(std::forward<Args>(args)...);
+	}
+	// Moves m_pending[mark..] into the arena and pops it off the stack
+	std::span<ASTNode*> take_pending(size_t mark);
+
+	[[nodiscard]] std::optional<std::vector<Region>> find_top_level_regions() const;
+	std::unique_ptr<Program> parse_in_parallel(const std::vector<Region>& regions, size_t threads);
+	void parse_region(const Region& region, RegionResult& result);
+	// Puts the statements and diagnostics of the regions together in source order
+	std::unique_ptr<Program> merge_regions(std::span<RegionResult> results);
+
+	// Runs `parse` and, if it hits a syntax error, unwinds whatever it left half done and skips past the broken
+	// statement so that parsing can carry on and report the rest of the file's errors too. Returns nullptr for a
+	// skipped statement. Once the error limit or the end of the file is reached the error is passed on and parsing
+	// stops.
+	template<typename Callback>
+	ASTNode* parse_or_recover(Callback parse)
+	{
+		const auto start = m_index;
+		const auto mark = m_pending.size();
+		const auto depth = m_symbols.Depth();
+		const auto scope = m_current_scope;
+		const auto blockDepth = m_block_depth;
+		try {
+			if (auto* statement = parse())
+				return statement;
+		}
+		catch (CompilerError&) {
+			// At the end of the file every enclosing scope would only report itself unterminated
+			if (m_error->ErrorLimitReached() || !peek().has_value())
+				throw;
+		}
+		m_pending.resize(mark);
+		// Statements never nest inside expressions, so any expression left half built is this statement's
+		m_operands.clear();
+		m_operators.clear();
+		m_symbols.ExitScopesTo(depth);
+		m_block_depth = blockDepth;
+		m_current_scope = scope;
+		m_skipped_statements = true;
+		synchronise(start);
+		return nullptr;
+	}
+	void synchronise(size_t statementStart);
+
+	FunctionDeclaration* parse_function();
+	VariableDeclaration* parse_variable();
+	ASTNode* parse_statement();
+	// A statement inside a block, along with its ';'
+	ASTNode* parse_terminated_statement();
+	// The body of an if, else or while: either a block or a single statement
+	std::span<ASTNode*> parse_body();
+	NumberLiteral* parse_number_literal();
+	StringLiteral* parse_string_literal();
+	Expression* parse_expression();
+	Expression* parse_term();
+	// Pops the top operator along with its operands and pushes the expression they make
+	void reduce_operator();
+	BinaryExpression* make_binary_expression(Expression* lhs, const Token& op, Expression* rhs);
+	UnaryExpression* make_unary_expression(const Token& op, Expression* operand, bool postfix);
+	ReturnStatement* parse_return_statement();
+	IfStatement* parse_if_statement();
+	WhileStatement* parse_while_statement();
+	BlockStatement* parse_else_statement();
+	StructDeclaration* parse_struct_declaration();
+	MemberExpression* parse_member_expression();
+	void consume_semicolon(const ASTNode* statement);
 	void add_variable(VariableDeclaration*);
-	
-	bool find_variable_by_name(const std::string& qualifiedName);
-	static std::string get_fully_qualified_name(const std::string& name, const std::string& scope);
+	[[nodiscard]] VariableDeclaration* find_variable(SymbolId symbol) const { return m_symbols.Find(symbol); }
+	[[nodiscard]] std::string_view current_scope_name() const { return m_interner->Name(m_current_scope); }
 };
 }
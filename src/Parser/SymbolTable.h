@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-25.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../AST/Ast.h"
+#include "../Utils/Interner.h"
+
+namespace alx {
+
+enum class ScopeKind
+{
+	Function, // Functions and structs only see what is declared inside them
+	Block,	  // Blocks also see their enclosing scopes
+};
+
+// The variables visible at the current point of the parse, as a stack of scope frames. Every declaration is pushed
+// on a single stack and the innermost one for each symbol is found through a table indexed by SymbolId, so a lookup
+// costs the same whether there are ten declarations or a million. Leaving a scope only touches what was declared in
+// it.
+//
+// A name may not be declared again while it is visible: a block can't shadow a variable of its function. Once the
+// block is closed its variables are gone and the names are free again. Function and struct scopes start from a
+// clean slate.
+class SymbolTable
+{
+	struct Binding {
+		SymbolId Symbol;
+		uint32_t Hidden; // The binding this one hides, 0 if none
+		VariableDeclaration* Declaration;
+	};
+	struct Frame {
+		uint32_t Start;		  // First binding declared in the frame
+		uint32_t VisibleFrom; // Value of m_visible_from to restore when the frame is exited
+	};
+
+	std::vector<Binding> m_bindings{ Binding{} }; // Index 0 is the "not declared" sentinel
+	std::vector<uint32_t> m_innermost;			   // Indexed by SymbolId
+	std::vector<Frame> m_frames;
+	uint32_t m_visible_from{ 1 }; // Bindings below this belong to a function or struct we're not in
+
+public:
+	void EnterScope(ScopeKind kind)
+	{
+		const auto top = static_cast<uint32_t>(m_bindings.size());
+		m_frames.push_back({ .Start = top, .VisibleFrom = m_visible_from });
+		if (kind == ScopeKind::Function)
+			m_visible_from = top;
+	}
+
+	void ExitScope()
+	{
+		const auto frame = m_frames.back();
+		m_frames.pop_back();
+		for (auto i = m_bindings.size() - 1; i >= frame.Start; --i)
+			m_innermost[m_bindings[i].Symbol] = m_bindings[i].Hidden;
+		m_bindings.resize(frame.Start);
+		m_visible_from = frame.VisibleFrom;
+	}
+
+	[[nodiscard]] size_t Depth() const { return m_frames.size(); }
+
+	// Leaves every scope entered since the table was `depth` frames deep
+	void ExitScopesTo(size_t depth)
+	{
+		while (m_frames.size() > depth)
+			ExitScope();
+	}
+
+	void Declare(VariableDeclaration* declaration)
+	{
+		const auto symbol = declaration->Symbol();
+		if (symbol >= m_innermost.size())
+			m_innermost.resize(symbol + 1);
+		m_bindings.push_back({ .Symbol = symbol, .Hidden = m_innermost[symbol], .Declaration = declaration });
+		m_innermost[symbol] = static_cast<uint32_t>(m_bindings.size() - 1);
+	}
+
+	[[nodiscard]] VariableDeclaration* Find(SymbolId symbol) const
+	{
+		if (symbol >= m_innermost.size() || m_innermost[symbol] < m_visible_from)
+			return nullptr;
+		return m_bindings[m_innermost[symbol]].Declaration;
+	}
+};
+
+// Types declared at file scope, shared by every parser working on the file. When parsing in parallel it's filled in
+// before any function is parsed and only read from after that, so lookups need no locking. A type is only visible
+// after its declaration, as if the file had been parsed from top to bottom.
+class GlobalScope
+{
+	struct Type {
+		size_t Position; // Index of the token the declaration starts at
+		ASTNode* Declaration;
+	};
+
+	std::vector<Type> m_types; // Indexed by SymbolId
+
+public:
+	void DeclareType(SymbolId name, size_t position, ASTNode* declaration)
+	{
+		if (name >= m_types.size())
+			m_types.resize(name + 1);
+		// The first declaration wins, as it always has for a type declared twice
+		if (!m_types[name].Declaration)
+			m_types[name] = { .Position = position, .Declaration = declaration };
+	}
+
+	[[nodiscard]] ASTNode* FindType(SymbolId name, size_t before) const
+	{
+		if (name >= m_types.size() || m_types[name].Position >= before)
+			return nullptr;
+		return m_types[name].Declaration;
+	}
+};
+
+} // namespace alx
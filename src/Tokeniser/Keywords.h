@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-19.
+//
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include "../Utils/Types.h"
+
+namespace alx {
+
+// Classifies an identifier-shaped lexeme as a keyword. The switch on length and first character narrows every word
+// down to at most two candidates, so lookup is a single string compare and needs no table built at runtime.
+constexpr std::optional<TokenType> keyword_type(std::string_view word)
+{
+	if (word.empty())
+		return {};
+	const auto is = [word](std::string_view keyword, TokenType type) -> std::optional<TokenType>
+	{
+		if (word == keyword)
+			return type;
+		return {};
+	};
+	switch (word.length())
+	{
+	case 2:
+		return is("if", TokenType::T_IF);
+	case 3:
+		switch (word[0])
+		{
+		case 'i': return is("int", TokenType::T_INT);
+		case 'f': return is("for", TokenType::T_FOR);
+		case 'm': return is("mut", TokenType::T_MUT);
+		default: return {};
+		}
+	case 4:
+		switch (word[0])
+		{
+		case 'l': return is("long", TokenType::T_LONG);
+		case 'v': return is("void", TokenType::T_VOID);
+		case 'c': return is("char", TokenType::T_CHAR);
+		case 'b': return is("bool", TokenType::T_BOOL);
+		case 't': return is("true", TokenType::T_TRUE);
+		case 'e': return word[1] == 'n' ? is("enum", TokenType::T_ENUM) : is("else", TokenType::T_ELSE);
+		default: return {};
+		}
+	case 5:
+		switch (word[0])
+		{
+		case 's': return is("short", TokenType::T_SHORT);
+		case 'f': return word[1] == 'l' ? is("float", TokenType::T_FLOAT) : is("false", TokenType::T_FALSE);
+		case 'c': return word[1] == 'l' ? is("class", TokenType::T_CLASS) : is("const", TokenType::T_CONST);
+		case 'w': return is("while", TokenType::T_WHILE);
+		default: return {};
+		}
+	case 6:
+		switch (word[0])
+		{
+		case 'd': return is("double", TokenType::T_DOUBLE);
+		case 's': return word[3] == 'i' ? is("string", TokenType::T_STRING) : is("struct", TokenType::T_STRUCT);
+		case 'r': return is("return", TokenType::T_RET);
+		case 'e': return is("extern", TokenType::T_EXTERN);
+		default: return {};
+		}
+	case 10:
+		return is("deprecated", TokenType::T_DEPRECATED);
+	default:
+		return {};
+	}
+}
+
+static_assert(keyword_type("string") == TokenType::T_STRING);
+static_assert(keyword_type("struct") == TokenType::T_STRUCT);
+static_assert(keyword_type("else") == TokenType::T_ELSE);
+static_assert(keyword_type("enum") == TokenType::T_ENUM);
+static_assert(keyword_type("deprecated") == TokenType::T_DEPRECATED);
+static_assert(!keyword_type("strung").has_value());
+static_assert(!keyword_type("AAA").has_value());
+static_assert(!keyword_type("").has_value());
+
+} // namespace alx
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-20.
+//
+
+#include "Scanner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALX_SCANNER_X86 1
+#else
+#define ALX_SCANNER_X86 0
+#endif
+
+namespace alx {
+
+namespace {
+
+bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
+bool is_identifier(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Scalar versions, also used for the tails shorter than a vector
+size_t skip_whitespace_scalar(std::string_view source, size_t pos)
+{
+	while (pos < source.length() && is_whitespace(source[pos])) ++pos;
+	return pos;
+}
+
+size_t skip_identifier_scalar(std::string_view source, size_t pos)
+{
+	while (pos < source.length() && is_identifier(source[pos])) ++pos;
+	return pos;
+}
+
+size_t find_line_end_scalar(std::string_view source, size_t pos)
+{
+	while (pos < source.length() && source[pos] != '\n') ++pos;
+	return pos;
+}
+
+size_t find_newlines_scalar(std::string_view source, size_t begin, size_t end, std::vector<uint32_t>& lineStarts)
+{
+	size_t count = 0;
+	for (size_t i = begin; i < end; ++i) {
+		if (source[i] == '\n') {
+			++count;
+			lineStarts.push_back(static_cast<uint32_t>(i + 1));
+		}
+	}
+	return count;
+}
+
+// Appends a line start for every set bit of a newline mask
+void push_line_starts(uint32_t mask, size_t base, std::vector<uint32_t>& lineStarts)
+{
+	for (; mask; mask &= mask - 1)
+		lineStarts.push_back(static_cast<uint32_t>(base + std::countr_zero(mask) + 1));
+}
+
+#if ALX_SCANNER_X86
+// Each mask function sets bit i if byte i of the vector belongs to the run being scanned. The range checks rely on
+// signed compares: bytes >= 0x80 are negative and so never fall inside an ASCII range.
+
+uint32_t whitespace_mask_sse2(const char* p)
+{
+	const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	const auto match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+												 _mm_cmpeq_epi8(c, _mm_set1_epi8('\t'))),
+									_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')));
+	return static_cast<uint32_t>(_mm_movemask_epi8(match));
+}
+
+uint32_t identifier_mask_sse2(const char* p)
+{
+	const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	const auto lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	const auto letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+									  _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+	const auto digit =
+		_mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+	const auto underscore = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+	return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore)));
+}
+
+uint32_t newline_mask_sse2(const char* p)
+{
+	const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))));
+}
+
+size_t skip_whitespace_sse2(std::string_view source, size_t pos)
+{
+	for (; pos + 16 <= source.length(); pos += 16)
+		if (const auto mask = whitespace_mask_sse2(source.data() + pos); mask != 0xFFFF)
+			return pos + std::countr_one(mask);
+	return skip_whitespace_scalar(source, pos);
+}
+
+size_t skip_identifier_sse2(std::string_view source, size_t pos)
+{
+	for (; pos + 16 <= source.length(); pos += 16)
+		if (const auto mask = identifier_mask_sse2(source.data() + pos); mask != 0xFFFF)
+			return pos + std::countr_one(mask);
+	return skip_identifier_scalar(source, pos);
+}
+
+size_t find_line_end_sse2(std::string_view source, size_t pos)
+{
+	for (; pos + 16 <= source.length(); pos += 16)
+		if (const auto mask = newline_mask_sse2(source.data() + pos))
+			return pos + std::countr_zero(mask);
+	return find_line_end_scalar(source, pos);
+}
+
+size_t find_newlines_sse2(std::string_view source, size_t begin, size_t end, std::vector<uint32_t>& lineStarts)
+{
+	size_t count = 0;
+	for (; begin + 16 <= end; begin += 16) {
+		if (const auto mask = newline_mask_sse2(source.data() + begin)) {
+			count += std::popcount(mask);
+			push_line_starts(mask, begin, lineStarts);
+		}
+	}
+	return count + find_newlines_scalar(source, begin, end, lineStarts);
+}
+
+[[gnu::target("avx2")]] uint32_t whitespace_mask_avx2(const char* p)
+{
+	const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	const auto match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+													   _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'))),
+									   _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')));
+	return static_cast<uint32_t>(_mm256_movemask_epi8(match));
+}
+
+[[gnu::target("avx2")]] uint32_t identifier_mask_avx2(const char* p)
+{
+	const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	const auto lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+	const auto letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+										 _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+	const auto digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+										_mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+	const auto underscore = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+	return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore)));
+}
+
+[[gnu::target("avx2")]] uint32_t newline_mask_avx2(const char* p)
+{
+	const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))));
+}
+
+[[gnu::target("avx2")]] size_t skip_whitespace_avx2(std::string_view source, size_t pos)
+{
+	for (; pos + 32 <= source.length(); pos += 32)
+		if (const auto mask = whitespace_mask_avx2(source.data() + pos); mask != 0xFFFFFFFF)
+			return pos + std::countr_one(mask);
+	return skip_whitespace_sse2(source, pos);
+}
+
+[[gnu::target("avx2")]] size_t skip_identifier_avx2(std::string_view source, size_t pos)
+{
+	for (; pos + 32 <= source.length(); pos += 32)
+		if (const auto mask = identifier_mask_avx2(source.data() + pos); mask != 0xFFFFFFFF)
+			return pos + std::countr_one(mask);
+	return skip_identifier_sse2(source, pos);
+}
+
+[[gnu::target("avx2")]] size_t find_line_end_avx2(std::string_view source, size_t pos)
+{
+	for (; pos + 32 <= source.length(); pos += 32)
+		if (const auto mask = newline_mask_avx2(source.data() + pos))
+			return pos + std::countr_zero(mask);
+	return find_line_end_sse2(source, pos);
+}
+
+[[gnu::target("avx2")]] size_t
+find_newlines_avx2(std::string_view source, size_t begin, size_t end, std::vector<uint32_t>& lineStarts)
+{
+	size_t count = 0;
+	for (; begin + 32 <= end; begin += 32) {
+		if (const auto mask = newline_mask_avx2(source.data() + begin)) {
+			count += std::popcount(mask);
+			push_line_starts(mask, begin, lineStarts);
+		}
+	}
+	return count + find_newlines_sse2(source, begin, end, lineStarts);
+}
+#endif
+
+struct ScanFunctions {
+	size_t (*SkipWhitespace)(std::string_view, size_t);
+	size_t (*SkipIdentifier)(std::string_view, size_t);
+	size_t (*FindLineEnd)(std::string_view, size_t);
+	size_t (*FindNewlines)(std::string_view, size_t, size_t, std::vector<uint32_t>&);
+};
+
+ScanWidth widest_supported()
+{
+#if ALX_SCANNER_X86
+	static const auto width = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? ScanWidth::Avx2 : ScanWidth::Sse2;
+	}();
+	return width;
+#else
+	return ScanWidth::Scalar;
+#endif
+}
+
+ScanFunctions functions_for(ScanWidth width)
+{
+	switch (width) {
+#if ALX_SCANNER_X86
+	case ScanWidth::Avx2:
+		return { skip_whitespace_avx2, skip_identifier_avx2, find_line_end_avx2, find_newlines_avx2 };
+	case ScanWidth::Sse2:
+		return { skip_whitespace_sse2, skip_identifier_sse2, find_line_end_sse2, find_newlines_sse2 };
+#endif
+	default:
+		return { skip_whitespace_scalar, skip_identifier_scalar, find_line_end_scalar, find_newlines_scalar };
+	}
+}
+
+// Starts out as the widest implementation the CPU supports, picked once per process
+ScanFunctions& scan_functions()
+{
+	static ScanFunctions functions = functions_for(widest_supported());
+	return functions;
+}
+
+} // namespace
+
+size_t skip_whitespace(std::string_view source, size_t pos) { return scan_functions().SkipWhitespace(source, pos); }
+
+size_t skip_identifier(std::string_view source, size_t pos) { return scan_functions().SkipIdentifier(source, pos); }
+
+size_t find_line_end(std::string_view source, size_t pos) { return scan_functions().FindLineEnd(source, pos); }
+
+size_t find_newlines(std::string_view source, size_t begin, size_t end, std::vector<uint32_t>& lineStarts)
+{
+	return scan_functions().FindNewlines(source, begin, end, lineStarts);
+}
+
+ScanWidth limit_scan_width(ScanWidth width)
+{
+	width = std::min(width, widest_supported());
+	scan_functions() = functions_for(width);
+	return width;
+}
+
+} // namespace alx
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-20.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace alx {
+
+// Vectorised scanning primitives for the tokeniser's hot loops. On x86 they process 32 bytes at a time with AVX2 when
+// the CPU supports it and 16 bytes with SSE2 otherwise; other targets use the scalar versions. Each skip/find
+// function returns the index of the first byte at or after `pos` that ends the run, or source.length().
+
+// Skips ' ', '\t' and '\n'
+size_t skip_whitespace(std::string_view source, size_t pos);
+// Skips [A-Za-z0-9_]
+size_t skip_identifier(std::string_view source, size_t pos);
+// Finds the next '\n'
+size_t find_line_end(std::string_view source, size_t pos);
+// Appends the offset just past every '\n' in [begin, end) to lineStarts and returns how many there were
+size_t find_newlines(std::string_view source, size_t begin, size_t end, std::vector<uint32_t>& lineStarts);
+
+enum class ScanWidth
+{
+	Scalar,
+	Sse2,
+	Avx2,
+};
+
+// Makes the functions above use nothing wider than `width`, which lets the narrower paths be tested on a CPU that
+// supports the wider ones. Returns the width now in use. Not safe to call while another thread is scanning.
+ScanWidth limit_scan_width(ScanWidth width);
+
+} // namespace alx
@@ -6,78 +6,112 @@
 // Created by aelliixx on 2023-09-06.
 //
 
-#include <regex>
+#include <algorithm>
+#include <charconv>
+#include <limits>
 #include <utility>
 #include "Tokeniser.h"
-#include "../libs/ctre.hpp"
+#include "Keywords.h"
+#include "Scanner.h"
 
 namespace alx {
-Tokeniser::Tokeniser(std::string source, const std::shared_ptr<ErrorHandler>& errorHandler)
+Tokeniser::Tokeniser(std::string_view source,
+					 const std::shared_ptr<ErrorHandler>& errorHandler,
+					 const std::shared_ptr<Interner>& interner)
   : m_error_handler(errorHandler),
-	m_source(std::move(source))
+	m_interner(interner),
+	m_source(source),
+	m_tokens(source, errorHandler->Lines())
+{}
+
+TokenBuffer Tokeniser::Tokenise()
 {
-	// Types
-	m_keywords["int"] = TokenType::T_INT;
-	m_keywords["long"] = TokenType::T_LONG;
-	m_keywords["short"] = TokenType::T_SHORT;
-	m_keywords["float"] = TokenType::T_FLOAT;
-	m_keywords["double"] = TokenType::T_DOUBLE;
-	m_keywords["void"] = TokenType::T_VOID;
-	m_keywords["string"] = TokenType::T_STRING;
-	m_keywords["char"] = TokenType::T_CHAR;
-	m_keywords["bool"] = TokenType::T_BOOL;
-	// Structures
-	m_keywords["class"] = TokenType::T_CLASS;
-	m_keywords["struct"] = TokenType::T_STRUCT;
-	m_keywords["enum"] = TokenType::T_ENUM;
-	// Other
-	m_keywords["return"] = TokenType::T_RET;
-	m_keywords["extern"] = TokenType::T_EXTERN;
-	// Values
-	m_keywords["true"] = TokenType::T_TRUE;
-	m_keywords["false"] = TokenType::T_FALSE;
-	// Branching
-	m_keywords["if"] = TokenType::T_IF;
-	m_keywords["else"] = TokenType::T_ELSE;
-	m_keywords["while"] = TokenType::T_WHILE;
-	m_keywords["for"] = TokenType::T_FOR;
-	// Qualifiers
-	m_keywords["const"] = TokenType::T_CONST;
-	m_keywords["mut"] = TokenType::T_MUT;
-	m_keywords["deprecated"] = TokenType::T_DEPRECATED;
+	lex(m_source.length());
+	// If the tokens suddenly end, it doesn't necessarily mean we have an invalid token stream.
+	// If we do, we'll catch that in the parsing stage anyway.
+	return std::move(m_tokens);
 }
 
-std::vector<Token> Tokeniser::Tokenise()
+TokenBuffer Tokeniser::Tokenise(const TokenBuffer& previous, std::span<const SourceEdit> edits)
 {
-#define ADD_TOKEN_BUF(token, buff) m_tokens.emplace_back(token, buff, m_line_index, m_column_index, m_index)
-#define ADD_TOKEN(token) m_tokens.emplace_back(token, m_line_index, m_column_index, m_index)
+	const auto& lines = previous.Lines();
+	const auto& previousStarts = lines.Starts();
+	auto& lineStarts = m_tokens.m_lines->Starts();
+	lineStarts.clear();
+	size_t token = 0; // Next token of `previous` to copy over
+	size_t line = 0;  // Next line start of `previous` to copy over
+	ptrdiff_t shift = 0;
+	const auto moved = [&shift](size_t offset) { return static_cast<size_t>(static_cast<ptrdiff_t>(offset) + shift); };
+	// Copies the tokens of `previous` that start before `end`, and the line starts up to it
+	const auto copyUntil = [&](size_t end) {
+		for (; token < previous.Size() && previous.m_offsets[token] < end; ++token) {
+			const auto kind = previous.m_kinds[token];
+			const auto offset = moved(previous.m_offsets[token]);
+			if (isNumberLiteral(kind))
+				m_tokens.AddNumber(
+					kind, offset, previous.m_lengths[token], previous.m_numbers[previous.m_payloads[token]]);
+			else
+				m_tokens.Add(kind, offset, previous.m_lengths[token], previous.m_payloads[token]);
+		}
+		for (; line < previousStarts.size() && previousStarts[line] <= end; ++line)
+			lineStarts.push_back(static_cast<uint32_t>(moved(previousStarts[line])));
+	};
+
+	for (size_t i = 0; i < edits.size();) {
+		// Tokens never span lines, so the edited lines can be lexed again on their own. Edits sharing a line are
+		// lexed together.
+		const auto begin = lines.LineStart(lines.Line(edits[i].Begin));
+		size_t end;
+		ptrdiff_t editShift = 0;
+		do {
+			const auto lastLine = lines.Line(edits[i].End);
+			end = lastLine < lines.LineCount() ? lines.LineStart(lastLine + 1) - 1 : previous.m_source.length();
+			editShift += edits[i].Shift();
+			++i;
+		} while (i < edits.size() && edits[i].Begin <= end);
+
+		copyUntil(begin);
+		while (token < previous.Size() && previous.m_offsets[token] < end)
+			++token;
+		while (line < previousStarts.size() && previousStarts[line] <= end)
+			++line;
+		m_index = moved(begin);
+		m_line_index = lineStarts.size();
+		m_column_index = 0;
+		shift += editShift;
+		lex(moved(end));
+	}
+	copyUntil(previous.m_source.length() + 1);
+	return std::move(m_tokens);
+}
+
+void Tokeniser::lex(size_t end)
+{
+#define ADD_TOKEN(token) m_tokens.Add(token, tokenStart, m_index - tokenStart)
 	try {
-		while (peek().has_value()) {
-			std::string buffer{};
+		// Past the error limit nothing more would be reported, so there's no point lexing the rest
+		while (m_index < end && !m_error_handler->ErrorLimitReached()) {
+			std::string_view buffer{};
 			// Is whitespace
-			while (peek().has_value() && (is_space(peek().value()) || peek().value() == '\n')) {
-				if (peek().value() == '\n') {
-					++m_line_index;
-					m_column_index = 0;
-				}
-				consume();
-			}
+			advance_to(std::min(skip_whitespace(m_source, m_index), end));
+			if (m_index == end)
+				break;
+			const auto tokenStart = m_index;
 			// Is a keyword or an identifier
 			if (is_alpha(peek().value())) {
-				buffer += consume();
-				while (peek().has_value() && is_alpha_numeric(peek().value())) buffer += consume();
+				advance_to(skip_identifier(m_source, m_index + 1));
+				buffer = m_source.substr(tokenStart, m_index - tokenStart);
 
-				if (m_keywords.contains(buffer)) {
-					std::string value = buffer;
-					if (buffer == "true")
-						value = "1";
-					else if (buffer == "false")
-						value = "0";
-					m_tokens.emplace_back(
-						m_keywords.find(buffer)->second, value, m_line_index, m_column_index, m_index);
+				if (const auto keyword = keyword_type(buffer)) {
+					if (keyword == TokenType::T_TRUE || keyword == TokenType::T_FALSE) {
+						const long value = keyword == TokenType::T_TRUE ? 1 : 0;
+						m_tokens.AddNumber(keyword.value(), tokenStart, buffer.length(), value);
+					}
+					else
+						ADD_TOKEN(keyword.value());
 					continue;
 				}
-				ADD_TOKEN_BUF(TokenType::T_IDENTIFIER, buffer);
+				m_tokens.Add(TokenType::T_IDENTIFIER, tokenStart, buffer.length(), m_interner->Intern(buffer));
 				continue;
 			}
 			// Is a number
@@ -85,35 +119,22 @@ std::vector<Token> Tokeniser::Tokenise()
 					 || (peek(1).has_value() && isdigit(peek(1).value())
 						 && (peek().value() == '+' || peek().value() == '-')))
 			{
-				buffer += consume();
-				while (peek().has_value()
-					   && (is_digit(peek().value()) || peek().value() == '.' || peek().value() == ','
-						   || peek().value() == 'f'))
-					buffer += consume();
+				const auto number = scan_number();
+				buffer = m_source.substr(tokenStart, m_index - tokenStart);
 
-				if (!is_number(buffer)) {
-					if (buffer == ".") {
-						ADD_TOKEN_BUF(TokenType::T_DOT, buffer);
-						continue;
-					}
-					println(Colour::Red,
-							"Unexpected token in '{}', at line: {}, position: {}",
-							buffer,
-							m_line_index,
-							m_column_index);
-				}
-				if (is_integer(buffer)) {
-					ADD_TOKEN_BUF(TokenType::T_INT_L, buffer);
+				if (number) {
+					m_tokens.AddNumber(number->first, tokenStart, buffer.length(), number->second);
 					continue;
 				}
-				else if (is_float(buffer)) {
-					ADD_TOKEN_BUF(TokenType::T_FLOAT_L, buffer);
-					continue;
-				}
-				else if (is_double(buffer)) {
-					ADD_TOKEN_BUF(TokenType::T_DOUBLE_L, buffer);
+				if (buffer == ".") {
+					ADD_TOKEN(TokenType::T_DOT);
 					continue;
 				}
+				println(Colour::Red,
+						"Unexpected token in '{}', at line: {}, position: {}",
+						buffer,
+						m_line_index,
+						m_column_index);
 			}
 			else if (peek().value() == ',') {
 				consume();
@@ -222,14 +243,34 @@ std::vector<Token> Tokeniser::Tokenise()
 			}
 			else if (peek().value() == '*') {
 				consume();
+				if (peek().value() == '=') {
+					consume();
+					ADD_TOKEN(TokenType::T_MULT_EQ);
+					continue;
+				}
 				ADD_TOKEN(TokenType::T_STAR);
 				continue;
 			}
 			else if (peek().value() == '^') {
 				consume();
+				if (peek().value() == '=') {
+					consume();
+					ADD_TOKEN(TokenType::T_POW_EQ);
+					continue;
+				}
 				ADD_TOKEN(TokenType::T_POW);
 				continue;
 			}
+			else if (peek().value() == '%') {
+				consume();
+				if (peek().value() == '=') {
+					consume();
+					ADD_TOKEN(TokenType::T_MOD_EQ);
+					continue;
+				}
+				ADD_TOKEN(TokenType::T_MOD);
+				continue;
+			}
 			else if (peek().value() == ':') {
 				consume();
 				if (peek().value() == ':') {
@@ -243,17 +284,21 @@ std::vector<Token> Tokeniser::Tokenise()
 			else if (peek().value() == '.') {
 				consume();
 				ADD_TOKEN(TokenType::T_DOT);
-				m_tokens.emplace_back(TokenType::T_DOT, m_line_index, m_column_index, m_index);
 				continue;
 			}
 			else if (peek().value() == '/') {
 				if (peek(1).value() == '/') // Comment
 				{
-					while (consume() != '\n')
-						;
+					// Stop at the newline so the whitespace skip counts it
+					advance_to(find_line_end(m_source, m_index));
 					continue;
 				}
 				consume();
+				if (peek().value() == '=') {
+					consume();
+					ADD_TOKEN(TokenType::T_DIV_EQ);
+					continue;
+				}
 				ADD_TOKEN(TokenType::T_FWD_SLASH);
 				continue;
 			}
@@ -263,54 +308,148 @@ std::vector<Token> Tokeniser::Tokenise()
 	}
 	catch (const std::bad_optional_access&) {
 	}
-	// If the tokens suddenly end, it doesn't necessarily mean we have an invalid token stream.
-	// If we do, we'll catch that in the parsing stage anyway.
-	return m_tokens;
 }
 
-bool Tokeniser::is_space(char character) { return character == ' ' || character == '\t'; }
-
 bool Tokeniser::is_alpha(char character)
 {
 	return ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_');
 }
 
-bool Tokeniser::is_alpha_numeric(char character)
-{
-	return ((character >= '0' && character <= '9') || (character >= 'a' && character <= 'z')
-			|| (character >= 'A' && character <= 'Z') || character == '_');
-}
-
-bool Tokeniser::is_double(const std::string& number)
-{
-	return ctre::match<R"(^-?(\d*|\d{1,3}(,\d{3})*)(\.\d+)?\b$)">(number);
-}
-
 bool Tokeniser::is_digit(char character)
 {
 	return (character >= '0' && character <= '9');
 }
-bool Tokeniser::is_integer(const std::string& number)
-{
-	// Benchmarks show that converting this to string_view saves us a few % of performance (???)
-	std::string_view num = number;
-	return ctre::match<R"(^-?(\d*|\d{1,3}(,\d{3})*)\b$)">(num);
-}
-bool Tokeniser::is_float(const std::string& number)
-{
-	return ctre::match<R"(^-?(\d*|\d{1,3}(,\d{3})*)(\.\d+)?[f]\b$)">(number);
-	//	return std::regex_match(number, m_float);
-}
-bool Tokeniser::is_number(const std::string& number)
+
+// Consumes a numeric lexeme, classifying it and computing its value in the same pass. A number is an optional '-',
+// digits that are either ungrouped or grouped in threes by ',', an optional fraction and an optional 'f' suffix.
+// Returns an empty optional if the lexeme does not form a valid number.
+std::optional<std::pair<TokenType, NumberValue>> Tokeniser::scan_number()
 {
-	return is_integer(number) || is_double(number) || is_float(number);
+	enum class State
+	{
+		Start,
+		Sign,
+		Integer,
+		Point,
+		Fraction,
+		Suffix,
+		Invalid,
+	};
+	const auto start = m_index;
+	auto state = State::Start;
+	size_t groupDigits = 0; // Digits since the start of the number or the last ','
+	bool grouped = false;
+	bool negative = false;
+	unsigned long integer = 0;
+	bool overflowed = false; // The integer part doesn't fit in a long, so `integer` stopped being added to
+	const auto groupComplete = [&] { return grouped ? groupDigits == 3 : true; };
+
+	do {
+		const auto c = consume();
+		switch (state) {
+		case State::Start:
+			if (c == '-') {
+				negative = true;
+				state = State::Sign;
+				break;
+			}
+			[[fallthrough]];
+		case State::Sign:
+		case State::Integer:
+			if (is_digit(c)) {
+				// A '-' can only come first, so the limit is known by the first digit; a long's most negative value
+				// has one more in its magnitude than its most positive
+				const auto limit = static_cast<unsigned long>(std::numeric_limits<long>::max()) + negative;
+				const auto digit = static_cast<unsigned long>(c - '0');
+				if (overflowed || integer > (limit - digit) / 10)
+					overflowed = true;
+				else
+					integer = integer * 10 + digit;
+				++groupDigits;
+				state = grouped && groupDigits > 3 ? State::Invalid : State::Integer;
+			}
+			else if (c == ',') {
+				if (state != State::Integer || groupDigits > 3 || !groupComplete())
+					state = State::Invalid;
+				grouped = true;
+				groupDigits = 0;
+			}
+			else if (c == '.')
+				state = groupComplete() ? State::Point : State::Invalid;
+			else if (c == 'f')
+				state = state == State::Integer && groupComplete() ? State::Suffix : State::Invalid;
+			else
+				state = State::Invalid;
+			break;
+		case State::Point:
+			state = is_digit(c) ? State::Fraction : State::Invalid;
+			break;
+		case State::Fraction:
+			if (c == 'f')
+				state = State::Suffix;
+			else if (!is_digit(c))
+				state = State::Invalid;
+			break;
+		case State::Suffix:
+		case State::Invalid:
+			state = State::Invalid;
+			break;
+		}
+	} while (peek().has_value()
+			 && (is_digit(peek().value()) || peek().value() == '.' || peek().value() == ',' || peek().value() == 'f'));
+
+	if (state == State::Integer && groupComplete()) {
+		if (overflowed) {
+			// Numbers never span lines, so the literal starts its length back from here
+			const auto length = m_index - start;
+			m_error_handler->Error(m_line_index,
+								   m_column_index - length,
+								   start,
+								   "Integer literal '{}' out of range",
+								   m_source.substr(start, length));
+		}
+		// Negated before the conversion, as negating the most negative long afterwards would overflow
+		return std::make_pair(TokenType::T_INT_L, static_cast<long>(negative ? -integer : integer));
+	}
+	if (state != State::Fraction && state != State::Suffix)
+		return {};
+
+	// Only the integer part may contain ',', so the fraction never needs re-scanning
+	auto text = m_source.substr(start, m_index - start);
+	if (state == State::Suffix)
+		text.remove_suffix(1);
+	std::string stripped;
+	if (grouped) {
+		stripped.reserve(text.length());
+		for (auto c : text)
+			if (c != ',')
+				stripped += c;
+		text = stripped;
+	}
+	double value{};
+	std::from_chars(text.data(), text.data() + text.length(), value);
+	return std::make_pair(state == State::Suffix ? TokenType::T_FLOAT_L : TokenType::T_DOUBLE_L, value);
 }
+
 std::optional<char> Tokeniser::peek(int ahead) const
 {
 	if (m_index + ahead < m_source.length())
-		return m_source.at(m_index + ahead);
+		return m_source[m_index + ahead];
 	return {};
 }
+// Moves to `end`, updating the line and column from the newlines skipped over
+void Tokeniser::advance_to(size_t end)
+{
+	auto& lineStarts = m_tokens.m_lines->Starts();
+	if (const auto newlines = find_newlines(m_source, m_index, end, lineStarts)) {
+		m_line_index += newlines;
+		m_column_index = end - lineStarts.back() + 1;
+	}
+	else
+		m_column_index += end - m_index;
+	m_index = end;
+}
+
 char Tokeniser::consume()
 {
 	auto c = m_source.at(m_index);
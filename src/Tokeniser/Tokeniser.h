@@ -8,64 +8,155 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
-#include <map>
-#include <regex>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../Utils/Interner.h"
+#include "../Utils/LineIndex.h"
+#include "../Utils/SourceEdit.h"
 #include "../Utils/Types.h"
 #include "../libs/ErrorHandler.h"
 
 namespace alx {
 
-struct Token
+class TokenBuffer;
+
+// A lightweight handle to a token stored in a TokenBuffer. It is cheap to copy and resolves everything on demand;
+// like the buffer's source, it must not outlive the Compiler.
+class Token
+{
+	const TokenBuffer* m_buffer;
+	uint32_t m_index;
+
+public:
+	Token(const TokenBuffer& buffer, uint32_t index) : m_buffer(&buffer), m_index(index) {}
+
+	[[nodiscard]] TokenType Type() const;
+	// The token's text in the source; true and false read as "1" and "0"
+	[[nodiscard]] std::string_view Value() const;
+	[[nodiscard]] SymbolId Symbol() const;	   // Only set for identifiers
+	[[nodiscard]] NumberValue Number() const; // Only set for number literals, true and false
+	// Offset of the token's first character
+	[[nodiscard]] size_t Offset() const;
+	// Offset of the token's last character
+	[[nodiscard]] size_t Position() const;
+	[[nodiscard]] size_t Line() const;
+	[[nodiscard]] size_t Column() const;
+};
+
+// Tokens stored as parallel arrays: 13 bytes per token instead of a struct with an owning value and three size_t
+// positions. Line and column are not stored at all; they are resolved from the line index when a diagnostic asks.
+class TokenBuffer
 {
-	Token(TokenType type, size_t lineNum, size_t colNum, size_t posNum)
-		: Type(type),
-		  LineNumber(lineNum),
-		  ColumnNumber(colNum),
-		  PosNumber(posNum - 1) {}
-	Token(TokenType type, std::optional<std::string> value, size_t lineNum, size_t colNum, size_t posNum)
-		: Type(type),
-		  Value(std::move(value)),
-		  LineNumber(lineNum),
-		  ColumnNumber(colNum),
-		  PosNumber(posNum - 1) {}
-	TokenType Type;
-	std::optional<std::string> Value;
-	size_t LineNumber;
-	size_t ColumnNumber;
-	size_t PosNumber;
+	std::string_view m_source;
+	std::vector<TokenType> m_kinds;
+	std::vector<uint32_t> m_offsets;
+	std::vector<uint32_t> m_lengths;
+	std::vector<uint32_t> m_payloads; // SymbolId for identifiers, index into m_numbers for literals
+	std::vector<NumberValue> m_numbers;
+	std::shared_ptr<LineIndex> m_lines; // Shared with the ErrorHandler, which resolves diagnostics against it
+
+	friend class Token;
+	friend class Tokeniser;
+
+public:
+	TokenBuffer() = default;
+	TokenBuffer(std::string_view source, std::shared_ptr<LineIndex> lines) : m_source(source), m_lines(std::move(lines))
+	{}
+
+	void Add(TokenType kind, size_t offset, size_t length, uint32_t payload = 0)
+	{
+		m_kinds.push_back(kind);
+		m_offsets.push_back(static_cast<uint32_t>(offset));
+		m_lengths.push_back(static_cast<uint32_t>(length));
+		m_payloads.push_back(payload);
+	}
+	void AddNumber(TokenType kind, size_t offset, size_t length, NumberValue number)
+	{
+		Add(kind, offset, length, static_cast<uint32_t>(m_numbers.size()));
+		m_numbers.push_back(number);
+	}
+
+	[[nodiscard]] size_t Size() const { return m_kinds.size(); }
+	[[nodiscard]] bool Empty() const { return m_kinds.empty(); }
+	[[nodiscard]] Token At(size_t index) const { return { *this, static_cast<uint32_t>(index) }; }
+	[[nodiscard]] const LineIndex& Lines() const { return *m_lines; }
 };
 
+inline TokenType Token::Type() const { return m_buffer->m_kinds[m_index]; }
+
+inline std::string_view Token::Value() const
+{
+	if (Type() == TokenType::T_TRUE)
+		return "1";
+	if (Type() == TokenType::T_FALSE)
+		return "0";
+	return m_buffer->m_source.substr(m_buffer->m_offsets[m_index], m_buffer->m_lengths[m_index]);
+}
+
+inline SymbolId Token::Symbol() const
+{
+	return Type() == TokenType::T_IDENTIFIER ? m_buffer->m_payloads[m_index] : NoSymbol;
+}
+
+inline NumberValue Token::Number() const
+{
+	if (!isNumberLiteral(Type()))
+		return {};
+	return m_buffer->m_numbers[m_buffer->m_payloads[m_index]];
+}
+
+inline size_t Token::Offset() const { return m_buffer->m_offsets[m_index]; }
+
+inline size_t Token::Position() const { return m_buffer->m_offsets[m_index] + m_buffer->m_lengths[m_index] - 1; }
+
+inline size_t Token::Line() const { return m_buffer->m_lines->Line(Position()); }
+
+inline size_t Token::Column() const
+{
+	// Columns count up to the end of the token, and past the first line they include the preceding newline. This
+	// keeps the positions diagnostics have always reported.
+	const auto line = Line();
+	return Position() + 1 - m_buffer->m_lines->LineStart(line) + (line > 1 ? 1 : 0);
+}
+
 class Tokeniser
 {
 private:
 	std::string m_temp_char;
 	std::shared_ptr<ErrorHandler> m_error_handler;
+	std::shared_ptr<Interner> m_interner;
 
 public:
-	Tokeniser(std::string source, const std::shared_ptr<ErrorHandler>& errorHandler);
-	[[nodiscard]] std::vector<Token> Tokenise();
+	Tokeniser(std::string_view source,
+			  const std::shared_ptr<ErrorHandler>& errorHandler,
+			  const std::shared_ptr<Interner>& interner);
+	[[nodiscard]] TokenBuffer Tokenise();
+	// Lexes the source again after `edits` were made to the text `previous` was lexed from. Only the lines the edits
+	// touched are lexed; the rest of the tokens are copied over from `previous`, moved along by the edits before them.
+	// `previous` must have been lexed with the same interner, and its source must still be alive.
+	[[nodiscard]] TokenBuffer Tokenise(const TokenBuffer& previous, std::span<const SourceEdit> edits);
 
 private:
 
-	std::string m_source;
+	std::string_view m_source;
 	size_t m_index{};
 	size_t m_line_index{ 1 };
 	size_t m_column_index{ 0 };
-	std::vector<Token> m_tokens{};
-	std::map<std::string, TokenType> m_keywords;
+	TokenBuffer m_tokens;
 
-	static bool is_space(char);
+	// Lexes from m_index up to `end`, which must be the end of a line or of the source
+	void lex(size_t end);
 	bool is_alpha(char);
-	bool is_alpha_numeric(char);
-	bool is_number(const std::string&);
-	bool is_double(const std::string&);
-	bool is_float(const std::string&);
-	bool is_integer(const std::string&);
 	bool is_digit(char);
+	std::optional<std::pair<TokenType, NumberValue>> scan_number();
 
 	[[nodiscard]] std::optional<char> peek(int ahead = 0) const;
 	char consume();
+	void advance_to(size_t end);
 
 };
 }
\ No newline at end of file
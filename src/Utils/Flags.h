@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "../libs/ErrorHandler.h"
 #include "../libs/argparse.hpp"
 #include "File.h"
 
@@ -23,6 +24,9 @@ struct DebugFlags {
 	bool dump_ir_all{};
 	bool dump_ir_initial{};
 	bool dump_ir_isel{};
+	// IR passes to dump the IR before or after, by name
+	std::vector<std::string> dump_ir_before{};
+	std::vector<std::string> dump_ir_after{};
 };
 
 struct Flags {
@@ -30,6 +34,10 @@ struct Flags {
 	bool mno_red_zone{};
 	bool fdiagnostics_colour{};
 	bool werror{};
+	DiagnosticsFormat diagnostics_format{};
+	size_t error_limit{};
+	size_t parse_threads{ 1 };
+	std::string ast_cache_dir{}; // Empty for no cache
 };
 
 inline DebugFlags resolveDebugFlags(const argparse::ArgumentParser& argParser)
@@ -49,6 +57,17 @@ inline DebugFlags resolveDebugFlags(const argparse::ArgumentParser& argParser)
 			return str == flag;
 		}) != irPipelineFlags.end();
 	};
+	// Anything other than the stages above names a pass, and "before-" a pass dumps the IR before it rather than after
+	std::vector<std::string> dumpBefore;
+	std::vector<std::string> dumpAfter;
+	for (const auto& flag : irPipelineFlags) {
+		if (flag == "all" || flag == "initial" || flag == "isel")
+			continue;
+		if (flag.starts_with("before-"))
+			dumpBefore.push_back(flag.substr(7));
+		else
+			dumpAfter.push_back(flag);
+	}
 
 	return {
 		.show_timing = argParser.get<bool>("-t") && !argParser.get<bool>("-q"),
@@ -59,7 +78,10 @@ inline DebugFlags resolveDebugFlags(const argparse::ArgumentParser& argParser)
 		.no_assemble = argParser.get<bool>("-S"),
 		.dump_ir_all = findFlagString("all"),
 		.dump_ir_initial = findFlagString("initial") || findFlagString("all"),
-		.dump_ir_isel = findFlagString("isel") || findFlagString("all"),
+		// "all" dumps after every pass, and the last of them is what instruction selection gets
+		.dump_ir_isel = findFlagString("isel"),
+		.dump_ir_before = std::move(dumpBefore),
+		.dump_ir_after = std::move(dumpAfter),
 	};
 }
 
@@ -69,7 +91,13 @@ inline Flags resolveFlags(const argparse::ArgumentParser& argParser)
 	return { .output_file = outputFilePath,
 			 .mno_red_zone = argParser.get<bool>("-mno-red-zone"),
 			 .fdiagnostics_colour = argParser.get<bool>("-fdiagnostics-colour"),
-			 .werror = argParser.get<bool>("-Werror") };
+			 .werror = argParser.get<bool>("-Werror"),
+			 .diagnostics_format = argParser.get<std::string>("--diagnostics-format") == "json"
+									   ? DiagnosticsFormat::Json
+									   : DiagnosticsFormat::Text,
+			 .error_limit = argParser.get<size_t>("-ferror-limit"),
+			 .parse_threads = argParser.get<size_t>("-fparse-threads"),
+			 .ast_cache_dir = argParser.get<std::string>("--ast-cache") };
 }
 
 }
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-18.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alx {
+
+using SymbolId = uint32_t;
+// Two symbols packed into one key, e.g. a variable within its function or a member within its object
+using QualifiedSymbol = uint64_t;
+
+constexpr SymbolId NoSymbol = 0;
+
+constexpr QualifiedSymbol qualify(SymbolId scope, SymbolId name)
+{
+	return (static_cast<QualifiedSymbol>(scope) << 32) | name;
+}
+
+// Maps every distinct identifier to a dense 32-bit id so that later stages hash and compare integers instead of
+// strings. The interner does not copy names: they must be slices of the source buffer or string literals.
+class Interner
+{
+	std::unordered_map<std::string_view, SymbolId> m_symbols;
+	std::vector<std::string_view> m_names{ "" }; // NoSymbol
+
+public:
+	Interner() = default;
+	Interner(const Interner&) = delete;
+	Interner& operator=(const Interner&) = delete;
+
+	SymbolId Intern(std::string_view name)
+	{
+		auto [it, inserted] = m_symbols.try_emplace(name, static_cast<SymbolId>(m_names.size()));
+		if (inserted)
+			m_names.push_back(name);
+		return it->second;
+	}
+
+	[[nodiscard]] SymbolId Lookup(std::string_view name) const
+	{
+		auto it = m_symbols.find(name);
+		return it == m_symbols.end() ? NoSymbol : it->second;
+	}
+
+	[[nodiscard]] std::string_view Name(SymbolId symbol) const { return m_names.at(symbol); }
+	[[nodiscard]] size_t Size() const { return m_names.size() - 1; }
+};
+
+} // namespace alx
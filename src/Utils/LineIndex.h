@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-22.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace alx {
+
+// Byte offsets at which each source line starts, filled in by the tokeniser as it skips newlines. Lines and columns
+// are only ever needed for diagnostics, so they are resolved from a byte position on demand instead of being tracked
+// per token.
+class LineIndex
+{
+	std::vector<uint32_t> m_starts{ 0 };
+
+public:
+	// The scanner appends to this directly while lexing
+	[[nodiscard]] std::vector<uint32_t>& Starts() { return m_starts; }
+	[[nodiscard]] const std::vector<uint32_t>& Starts() const { return m_starts; }
+
+	// 1-based line containing `pos`
+	[[nodiscard]] size_t Line(size_t pos) const
+	{
+		return static_cast<size_t>(std::upper_bound(m_starts.begin(), m_starts.end(), pos) - m_starts.begin());
+	}
+	[[nodiscard]] size_t LineStart(size_t line) const { return m_starts.at(line - 1); }
+	[[nodiscard]] size_t LineCount() const { return m_starts.size(); }
+};
+
+} // namespace alx
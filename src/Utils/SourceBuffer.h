@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-21.
+//
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace alx {
+
+// Read-only source text for a compilation. Regular files are mmap'd so the tokeniser reads the page cache directly;
+// pipes and stdin, or files that cannot be mapped, are read once into an exactly sized buffer. Everything downstream
+// holds views into View(), so the buffer must outlive the Compiler that owns it.
+class SourceBuffer
+{
+	std::string m_owned;
+	void* m_mapping{ nullptr };
+	size_t m_mapped_size{};
+	std::string_view m_view;
+
+	SourceBuffer() = default;
+
+public:
+	SourceBuffer(const SourceBuffer&) = delete;
+	SourceBuffer& operator=(const SourceBuffer&) = delete;
+	SourceBuffer(SourceBuffer&& other) noexcept { *this = std::move(other); }
+	SourceBuffer& operator=(SourceBuffer&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+		unmap();
+		const bool owned = other.m_mapping == nullptr;
+		m_owned = std::move(other.m_owned);
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+		m_mapped_size = std::exchange(other.m_mapped_size, 0);
+		// A moved std::string may have kept its characters in the small string buffer, so re-point the view
+		m_view = owned ? std::string_view(m_owned) : other.m_view;
+		other.m_view = {};
+		return *this;
+	}
+	~SourceBuffer() { unmap(); }
+
+	static SourceBuffer FromString(std::string code)
+	{
+		SourceBuffer buffer;
+		buffer.m_owned = std::move(code);
+		buffer.m_view = buffer.m_owned;
+		return buffer;
+	}
+
+	// Opens `path` for reading, or stdin if it is "-"
+	static std::optional<SourceBuffer> Open(const std::string& path)
+	{
+		const bool isStdin = path == "-";
+		const int fd = isStdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return {};
+		auto buffer = read_fd(fd);
+		if (!isStdin)
+			::close(fd);
+		return buffer;
+	}
+
+	[[nodiscard]] std::string_view View() const { return m_view; }
+	[[nodiscard]] bool Empty() const { return m_view.empty(); }
+	[[nodiscard]] bool Mapped() const { return m_mapping != nullptr; }
+
+private:
+	static std::optional<SourceBuffer> read_fd(int fd)
+	{
+		struct stat status
+		{};
+		if (::fstat(fd, &status) != 0)
+			return {};
+		SourceBuffer buffer;
+		const auto size = static_cast<size_t>(status.st_size);
+		if (S_ISREG(status.st_mode)) {
+			if (size == 0)
+				return buffer;
+			if (void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); mapping != MAP_FAILED) {
+				// The source is read front to back exactly once
+				::madvise(mapping, size, MADV_SEQUENTIAL);
+				buffer.m_mapping = mapping;
+				buffer.m_mapped_size = size;
+				buffer.m_view = std::string_view(static_cast<const char*>(mapping), size);
+				return buffer;
+			}
+			buffer.m_owned.resize(size);
+			const auto length = read_into(fd, buffer.m_owned, 0);
+			if (!length)
+				return {};
+			buffer.m_owned.resize(length.value());
+			buffer.m_view = buffer.m_owned;
+			return buffer;
+		}
+		// Pipes don't know their size up front, so grow geometrically and trim once at the end
+		size_t length = 0;
+		do {
+			buffer.m_owned.resize(std::max<size_t>(4096, buffer.m_owned.size() * 2));
+			const auto filled = read_into(fd, buffer.m_owned, length);
+			if (!filled)
+				return {};
+			length = filled.value();
+		} while (length == buffer.m_owned.size());
+		buffer.m_owned.resize(length);
+		buffer.m_owned.shrink_to_fit();
+		buffer.m_view = buffer.m_owned;
+		return buffer;
+	}
+
+	// Fills `into` from `offset` until it is full or the input ends, returning the total length read
+	static std::optional<size_t> read_into(int fd, std::string& into, size_t offset)
+	{
+		while (offset < into.size()) {
+			const auto count = ::read(fd, into.data() + offset, into.size() - offset);
+			// A signal arriving before anything was read isn't a failure, so read again
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count < 0)
+				return {};
+			if (count == 0)
+				break;
+			offset += static_cast<size_t>(count);
+		}
+		return offset;
+	}
+
+	void unmap()
+	{
+		if (m_mapping)
+			::munmap(m_mapping, m_mapped_size);
+		m_mapping = nullptr;
+		m_mapped_size = 0;
+	}
+};
+
+} // namespace alx
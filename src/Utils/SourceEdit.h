@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2023 Donatas Mockus.
+ */
+
+//
+// Created by aelliixx on 2023-11-27.
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace alx {
+
+// A change made to the source since it was last compiled: the bytes [Begin, End) of the old text were replaced by
+// Length bytes, which start at Begin in the new text. A list of edits is sorted by Begin, the edits don't overlap and
+// all their offsets are in the old text.
+struct SourceEdit {
+	size_t Begin;
+	size_t End;
+	size_t Length;
+
+	// How far the edit moves the text after it
+	[[nodiscard]] ptrdiff_t Shift() const
+	{
+		return static_cast<ptrdiff_t>(Length) - static_cast<ptrdiff_t>(End - Begin);
+	}
+};
+
+// Bytes a statement takes up in the source, from the start of its first token to the end of its last
+struct SourceSpan {
+	size_t Begin;
+	size_t End;
+
+	bool operator==(const SourceSpan&) const = default;
+};
+
+} // namespace alx
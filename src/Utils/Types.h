@@ -8,11 +8,16 @@
 
 #pragma once
 #include <cassert>
+#include <cstdint>
+#include <variant>
 #include "Utils.h"
 
 namespace alx {
 
-enum class TokenType
+// Binary value of a numeric literal, produced once by the tokeniser
+using NumberValue = std::variant<long, double>;
+
+enum class TokenType : uint8_t
 {
 	// Literals
 	T_INT_L, T_FLOAT_L, T_DOUBLE_L, T_CHAR_L, T_STR_L, T_TRUE, T_FALSE,
@@ -33,6 +38,8 @@ enum class TokenType
 	T_CONST, T_MUT,
 	T_DEPRECATED,
 };
+// For tables indexed by TokenType; T_DEPRECATED must stay the last token
+inline constexpr size_t TokenTypeCount = static_cast<size_t>(TokenType::T_DEPRECATED) + 1;
 
 inline size_t size_of(TokenType token)
 {
@@ -65,6 +72,24 @@ inline size_t size_of(TokenType token)
 	}
 }
 
+// The signed integer type that's `size` bytes wide
+inline TokenType integer_type_of(size_t size)
+{
+	switch (size)
+	{
+	case 1:
+		return TokenType::T_CHAR;
+	case 2:
+		return TokenType::T_SHORT;
+	case 4:
+		return TokenType::T_INT;
+	case 8:
+		return TokenType::T_LONG;
+	default:
+		ASSERT_NOT_REACHABLE();
+	}
+}
+
 inline TokenType literal_to_type(TokenType literal)
 {
 	switch (literal)
@@ -98,8 +123,16 @@ inline bool isBinaryOp(TokenType type)
 		type == TokenType::T_FWD_SLASH || type == TokenType::T_POW || type == TokenType::T_LT ||
 		type == TokenType::T_GT || type == TokenType::T_LTE || type == TokenType::T_GTE ||
 		type == TokenType::T_EQ || type == TokenType::T_MOD || type == TokenType::T_COLON ||
-		type == TokenType::T_EQEQ || type == TokenType::T_NOT_EQ || type == TokenType::T_SUB_EQ
-		|| type == TokenType::T_ADD_EQ;
+		type == TokenType::T_EQEQ || type == TokenType::T_NOT_EQ || type == TokenType::T_SUB_EQ ||
+		type == TokenType::T_ADD_EQ || type == TokenType::T_MULT_EQ || type == TokenType::T_DIV_EQ ||
+		type == TokenType::T_MOD_EQ || type == TokenType::T_POW_EQ;
+}
+
+inline bool isAssignmentOp(TokenType type)
+{
+	return type == TokenType::T_EQ || type == TokenType::T_ADD_EQ || type == TokenType::T_SUB_EQ ||
+		type == TokenType::T_MULT_EQ || type == TokenType::T_DIV_EQ || type == TokenType::T_MOD_EQ ||
+		type == TokenType::T_POW_EQ;
 }
 
 inline bool isUnaryOp(TokenType type)
@@ -10,6 +10,7 @@
 #include <string>
 #include <assert.h>
 #include <source_location>
+#include <stdexcept>
 
 
 #define OUTPUT_IR_TO_STRING 0 // For facilitating IR tests by redirecting output to a string
@@ -8,7 +8,14 @@
 #pragma once
 #include <algorithm>
 #include <list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
+#include "../Utils/LineIndex.h"
 #include "Println.h"
 
 namespace alx {
@@ -42,6 +49,27 @@ enum class ErrorCode
 	W500  // Uninitialised variable
 };
 
+enum class DiagnosticsFormat
+{
+	Text, // Coloured, with the offending line quoted
+	Json, // One object per line, no colour
+};
+
+enum class Severity
+{
+	Error,
+	Warning,
+	Note,
+};
+
+struct Diagnostic {
+	Severity Kind;
+	size_t Line;
+	size_t Column;
+	size_t Position;
+	std::string Message;
+};
+
 class ErrorHandler
 {
 private:
@@ -49,118 +77,237 @@ private:
 	size_t m_error_count{};
 	size_t m_warning_count{};
 	size_t m_note_count{};
-	std::string m_code;
+	std::string_view m_code; // Owned by the Compiler, which outlives every diagnostic
+	// Line starts recorded by the tokeniser as it lexes, so a diagnostic never has to rescan the source
+	std::shared_ptr<LineIndex> m_lines{ std::make_shared<LineIndex>() };
 	std::string m_file_name;
 	bool m_werror{};
+	DiagnosticsFormat m_format;
+	size_t m_error_limit; // 0 for no limit
+	// Diagnostics are held until Flush() so that each stage's output goes out in a single write
+	std::vector<Diagnostic> m_diagnostics;
+	// Where diagnostics are written: wherever stdout was going when the handler was made, so that it can be pointed
+	// elsewhere afterwards without taking the diagnostics with it
+	std::streambuf* m_output{ std::cout.rdbuf() };
+	bool m_limit_noted{}; // Whether the note saying errors past the limit are dropped has been written
 
 public:
-	ErrorHandler(std::string code, std::string fileName,
-				 bool werror) : m_code(std::move(code)), m_file_name(std::move(fileName)), m_werror(werror) {}
+	ErrorHandler(std::string_view code,
+				 std::string fileName,
+				 bool werror,
+				 DiagnosticsFormat format = DiagnosticsFormat::Text,
+				 size_t errorLimit = 0)
+	  : m_code(code),
+		m_file_name(std::move(fileName)),
+		m_werror(werror),
+		m_format(format),
+		m_error_limit(errorLimit)
+	{}
 
 	[[nodiscard]] size_t ErrorCount() const { return m_error_count; }
+	[[nodiscard]] size_t DiagnosticCount() const { return m_error_count + m_warning_count + m_note_count; }
+	// Whether enough errors have been reported that the parser should stop recovering and give up
+	[[nodiscard]] bool ErrorLimitReached() const { return m_error_limit && m_error_count >= m_error_limit; }
+	[[nodiscard]] const std::shared_ptr<LineIndex>& Lines() const { return m_lines; }
+
+	// A handler for part of the file parsed on another thread. It holds on to its diagnostics until they're handed
+	// back with Join(), so that they can be put in source order.
+	[[nodiscard]] std::shared_ptr<ErrorHandler> Fork() const
+	{
+		auto fork = std::make_shared<ErrorHandler>(m_code, m_file_name, m_werror, m_format, m_error_limit);
+		fork->m_lines = m_lines;
+		fork->m_output = m_output;
+		return fork;
+	}
 
-	void EmitErrorCount() const
+	void Join(ErrorHandler& fork)
 	{
-		println("\nBuild {}. Found: ", (m_error_count > 0 ? "failed" : "finished"));
-		println("{} {255;}. {} {255;165;}. {} {0;100;200}",
-				m_error_count,
-				(m_error_count != 1 ? "errors" : "error"),
-				m_warning_count,
-				(m_warning_count != 1 ? "warnings" : "warning"),
-				m_note_count,
-				(m_note_count != 1 ? "notes" : "note"));
+		m_error_count += fork.m_error_count;
+		m_warning_count += fork.m_warning_count;
+		m_note_count += fork.m_note_count;
+		m_limit_noted = m_limit_noted || fork.m_limit_noted;
+		m_diagnostics.insert(m_diagnostics.end(),
+							 std::make_move_iterator(fork.m_diagnostics.begin()),
+							 std::make_move_iterator(fork.m_diagnostics.end()));
+		fork.m_diagnostics.clear();
+	}
+
+	// Writes out every diagnostic reported since the last flush
+	void Flush()
+	{
+		if (m_diagnostics.empty())
+			return;
+		std::string out;
+		for (const auto& diagnostic : m_diagnostics) {
+			if (m_format == DiagnosticsFormat::Json)
+				render_json(diagnostic, out);
+			else
+				render_text(diagnostic, out);
+		}
+		m_diagnostics.clear();
+		write(out);
+	}
+
+	void EmitErrorCount()
+	{
+		Flush();
+		std::string out;
+		if (m_format == DiagnosticsFormat::Json) {
+			out = R"({"errors":)" + std::to_string(m_error_count) + R"(,"warnings":)" + std::to_string(m_warning_count)
+				+ R"(,"notes":)" + std::to_string(m_note_count) + "}\n";
+			write(out);
+			return;
+		}
+		formatTo(out, "\nBuild {}. Found: \n", (m_error_count > 0 ? "failed" : "finished"));
+		formatTo(out,
+				 "{} {255;}. {} {255;165;}. {} {0;100;200}\n",
+				 m_error_count,
+				 (m_error_count != 1 ? "errors" : "error"),
+				 m_warning_count,
+				 (m_warning_count != 1 ? "warnings" : "warning"),
+				 m_note_count,
+				 (m_note_count != 1 ? "notes" : "note"));
+		write(out);
+	}
+
+	// Notes where compilation stopped because of the error limit, unless that's already been noted
+	void NoteErrorLimit(size_t lineNum, size_t colNum, size_t posNum)
+	{
+		if (!std::exchange(m_limit_noted, true))
+			Note(lineNum, colNum, posNum, "Too many errors, stopping now");
 	}
 
 	template<typename... Param>
-	void Warning(size_t lineNum, size_t colNum, size_t posNum, const std::string& format, const Param&... arguments)
+	void Warning(size_t lineNum, size_t colNum, size_t posNum, FormatString<Param...> format, const Param&... arguments)
 	{
+		if (past_limit(lineNum, colNum, posNum))
+			return;
 		if (m_werror) {
 			Error(lineNum, colNum, posNum, format, arguments...);
 			return;
 		}
 		++m_warning_count;
-		const auto text = getFormatted(format, arguments...);
-		give_context(lineNum, colNum, posNum);
-		auto colour = Colour::Orange;
-		println(" | \033[38;2;{};{};{}m{}\033[0m\n | At line: {}, position: {}\n",
-				colour.r,
-				colour.g,
-				colour.b,
-				text,
-				lineNum,
-				colNum);
+		m_diagnostics.push_back({ Severity::Warning, lineNum, colNum, posNum, getFormatted(format, arguments...) });
 	}
 
 	template<typename... Param>
-	void Error(size_t lineNum, size_t colNum, size_t posNum, const std::string& format, const Param&... arguments)
+	void Error(size_t lineNum, size_t colNum, size_t posNum, FormatString<Param...> format, const Param&... arguments)
 	{
+		if (past_limit(lineNum, colNum, posNum))
+			return;
 		++m_error_count;
-		const auto text = getFormatted(format, arguments...);
-		auto colour = Colour::LightRed;
-
-		give_context(lineNum, colNum, posNum);
-
-		println(" | \033[38;2;{};{};{}m{}\033[0m\n | At line: {}, position: {}\n",
-				colour.r,
-				colour.g,
-				colour.b,
-				text,
-				lineNum,
-				colNum);
+		m_diagnostics.push_back({ Severity::Error, lineNum, colNum, posNum, getFormatted(format, arguments...) });
 	}
 
 	template<typename... Param>
-	void Note(size_t lineNum, size_t colNum, size_t posNum, const std::string& format, const Param&... arguments)
+	void Note(size_t lineNum, size_t colNum, size_t posNum, FormatString<Param...> format, const Param&... arguments)
 	{
 		++m_note_count;
-		const auto text = getFormatted(format, arguments...);
-		Colour colour{ 0, 100, 200 };
-
-		give_context(lineNum, colNum, posNum);
-
-		println(" | \033[38;2;{};{};{}m{}\033[0m\n | At line: {}, position: {}\n",
-				colour.r,
-				colour.g,
-				colour.b,
-				text,
-				lineNum,
-				colNum);
+		m_diagnostics.push_back({ Severity::Note, lineNum, colNum, posNum, getFormatted(format, arguments...) });
 	}
 
 	template<typename... Param>
-	void FatalError(size_t lineNum, size_t colNum, size_t posNum, const std::string& format, const Param&... arguments)
+	void FatalError(size_t lineNum,
+					size_t colNum,
+					size_t posNum,
+					FormatString<Param...> format,
+					const Param&... arguments)
 	{
 		const auto text = getFormatted(format, arguments...);
-		Error(lineNum, colNum, posNum, text);
+		Error(lineNum, colNum, posNum, "{}", text);
 		throw CompilerError(text);
 	}
 
 private:
-	void give_context(size_t lineNum, size_t colNum, size_t posNum)
+	// Past the error limit nothing more is recorded, however many errors a stage goes on to find, so that a file full
+	// of them can't fill memory with diagnostics
+	bool past_limit(size_t lineNum, size_t colNum, size_t posNum)
 	{
-		std::string lineBuffer;
-		size_t lineStartIndex{ 0 };
-		size_t errorIndexInLine{ 0 };
-		for (auto i = posNum; m_code[i] != '\n'; --i) {
-			if (!m_code.at(i))
-				break;
-			lineStartIndex = i;
-		}
-		for (int i = 0; m_code[lineStartIndex] != '\n'; ++lineStartIndex) {
-			lineBuffer += m_code[lineStartIndex];
-			++i;
-			if (lineStartIndex == posNum)
-				errorIndexInLine = i;
-		}
+		if (!ErrorLimitReached())
+			return false;
+		NoteErrorLimit(lineNum, colNum, posNum);
+		return true;
+	}
+
+	void write(const std::string& text) const
+	{
+		std::ostream output(m_output);
+		output.write(text.data(), static_cast<std::streamsize>(text.size()));
+		output.flush();
+	}
 
-		println("--> {}:{}:{}", m_file_name, lineNum, colNum);
-		println(" | {}", lineBuffer);
-		println(" | {}{}", std::string(errorIndexInLine ? errorIndexInLine - 1 : 0, ' '), '^');
+	// The source line containing `posNum` and the offset of its first character
+	std::pair<std::string_view, size_t> line_at(size_t posNum) const
+	{
+		posNum = std::min(posNum, m_code.empty() ? 0 : m_code.size() - 1);
+		const auto line = m_lines->Line(posNum);
+		const auto lineStart = m_lines->LineStart(line);
+		// The last line's end hasn't necessarily been recorded, e.g. for an error raised mid-lex
+		const auto lineEnd =
+			line < m_lines->LineCount() ? m_lines->LineStart(line + 1) - 1 : m_code.find('\n', lineStart);
+		return { m_code.substr(lineStart, lineEnd - lineStart), lineStart };
+	}
+
+	void render_text(const Diagnostic& diagnostic, std::string& out) const
+	{
+		const auto [lineText, lineStart] = line_at(diagnostic.Position);
+		const auto caret = std::min(diagnostic.Position, m_code.empty() ? 0 : m_code.size() - 1) - lineStart;
+		Colour colour{ 0, 100, 200 };
+		if (diagnostic.Kind == Severity::Error)
+			colour = Colour::LightRed;
+		else if (diagnostic.Kind == Severity::Warning)
+			colour = Colour::Orange;
+
+		formatTo(out, "--> {}:{}:{}\n", m_file_name, diagnostic.Line, diagnostic.Column);
+		formatTo(out, " | {}\n", lineText);
+		formatTo(out, " | {>}^\n", caret);
+		formatTo(out,
+				 " | \033[38;2;{};{};{}m{}\033[0m\n | At line: {}, position: {}\n\n",
+				 colour.r,
+				 colour.g,
+				 colour.b,
+				 diagnostic.Message,
+				 diagnostic.Line,
+				 diagnostic.Column);
+	}
+
+	void render_json(const Diagnostic& diagnostic, std::string& out) const
+	{
+		static constexpr std::string_view severities[] = { "error", "warning", "note" };
+		out += R"({"file":)";
+		append_json_string(m_file_name, out);
+		out += R"(,"line":)" + std::to_string(diagnostic.Line);
+		out += R"(,"column":)" + std::to_string(diagnostic.Column);
+		out += R"(,"severity":")";
+		out += severities[static_cast<size_t>(diagnostic.Kind)];
+		out += R"(","message":)";
+		append_json_string(diagnostic.Message, out);
+		out += "}\n";
+	}
+
+	static void append_json_string(std::string_view text, std::string& out)
+	{
+		static constexpr char hex[] = "0123456789abcdef";
+		out += '"';
+		for (const char c : text) {
+			if (c == '"' || c == '\\') {
+				out += '\\';
+				out += c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20) {
+				out += "\\u00";
+				out += hex[(c >> 4) & 0xF];
+				out += hex[c & 0xF];
+			}
+			else
+				out += c;
+		}
+		out += '"';
 	}
 };
 
 template<typename... Param>
-void error(const std::string& format, const Param&... arguments)
+void error(FormatString<Param...> format, const Param&... arguments)
 {
 	const auto text = getFormatted(format, arguments...);
 	auto colour = Colour::LightRed;
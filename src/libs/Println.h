@@ -1,12 +1,17 @@
 #pragma once
 #include <assert.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
 #include <type_traits>
 #include <utility>
@@ -22,208 +27,266 @@ namespace alx {
 
 namespace __alx {
 
-template<typename T>
-concept Stringable = std::convertible_to<T, std::string>;
-
-template<typename T>
-concept Char = std::is_same_v<T, char>;
-
-template<typename T>
-concept Number = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
-
-template<typename T>
-concept Boolean = std::is_same_v<T, bool>;
-
-template<__alx::Stringable T>
-std::string string_cast(T from)
-{
-	return from;
-}
-
-template<Boolean T>
-std::string string_cast(T from)
+enum class SpecKind : uint8_t
 {
-	return from ? "true" : "false";
-}
+	Value,	// {}
+	Colour, // {r;g;b}, missing components are 0
+	Vector, // {v}, each element in its own colour
+	Indent, // {>}, the argument is a number of spaces
+};
 
-template<__alx::Number T>
-std::string string_cast(T from)
-{
-	return std::to_string(from);
-}
+struct FormatSpec {
+	size_t Begin; // Offset of the '{'
+	size_t End;	  // Offset of the '}'
+	SpecKind Kind;
+	uint8_t R, G, B;
+};
 
-template<__alx::Char T>
-std::string string_cast(T from)
-{
-	return std::string(1, from);
-}
-
-template<typename T>
-std::string string_cast(std::vector<T> from)
-{
-	std::string out = "{";
-	auto delim = "";
-	for (const auto& item : from)
-	{
-		out += delim + string_cast(item);
-		delim = ", ";	
-	}
-	out += "}";
-	return out;
-}
+// Never constexpr, so reaching it during constant evaluation fails the build with `reason` in the diagnostic
+inline void invalid_format_string(const char* reason) { throw std::logic_error(reason); }
 
+// A format string parsed and checked against its arguments at compile time. A placeholder runs from the last '{' to
+// the next '}'; braces outside a placeholder are copied as is.
 template<typename... Param>
-class VariadicArgParser
+class BasicFormatString
 {
+	std::string_view m_text;
+	std::array<FormatSpec, sizeof...(Param)> m_specs{};
 
-	std::string _text{};
-	std::string _format{};
-	std::vector<std::string> _args{};
-
-	template<typename T, typename... Rest>
-	void set_args(T& first, Rest&... rest)
+public:
+	template<typename T>
+		requires std::convertible_to<const T&, std::string_view>
+	consteval BasicFormatString(const T& text) : m_text(text)
 	{
-		_args.push_back(string_cast(first));
-		set_args(rest...);
+		size_t count = 0;
+		auto open = std::string_view::npos;
+		for (size_t i = 0; i < m_text.length(); ++i) {
+			if (m_text[i] == '{')
+				open = i;
+			else if (m_text[i] == '}' && open != std::string_view::npos) {
+				if (count == sizeof...(Param))
+					invalid_format_string("More placeholders than arguments");
+				else
+					m_specs[count++] = parse_spec(open, i);
+				open = std::string_view::npos;
+			}
+		}
+		if (count != sizeof...(Param))
+			invalid_format_string("Fewer placeholders than arguments");
 	}
 
-	void set_args() {}
+	[[nodiscard]] constexpr std::string_view Text() const { return m_text; }
+	[[nodiscard]] constexpr const FormatSpec& Spec(size_t index) const { return m_specs[index]; }
 
-	std::string parse_colour_sequence(const std::string& str)
+private:
+	consteval FormatSpec parse_spec(size_t open, size_t close) const
 	{
-		std::stringstream stream(str);
-		std::string item;
-		std::string out = "\033[38;2";
-		int matches = 0;
-		while (std::getline(stream, item, ';'))
-			if (item.length() > 0) {
-				++matches;
-				out += ";" + item;
+		FormatSpec spec{ open, close, SpecKind::Value, 0, 0, 0 };
+		const auto body = m_text.substr(open + 1, close - open - 1);
+		if (body.empty())
+			return spec;
+		if (body == "v" || body == ">") {
+			spec.Kind = body == "v" ? SpecKind::Vector : SpecKind::Indent;
+			return spec;
+		}
+		spec.Kind = SpecKind::Colour;
+		uint8_t* components[] = { &spec.R, &spec.G, &spec.B };
+		size_t component = 0;
+		for (size_t i = 0; i < body.length();) {
+			if (body[i] == ';') {
+				++i;
+				continue;
 			}
-		for (int i = matches; i < 3; ++i) out += ";0";
-		return out + "m";
+			unsigned value = 0;
+			for (; i < body.length() && body[i] != ';'; ++i) {
+				if (body[i] < '0' || body[i] > '9')
+					invalid_format_string("Unknown placeholder, expected {}, {v}, {>} or {r;g;b}");
+				value = value * 10 + (body[i] - '0');
+				if (value > 255)
+					invalid_format_string("Colour component out of range");
+			}
+			if (component == 3)
+				invalid_format_string("A colour takes at most three components");
+			else
+				*components[component++] = static_cast<uint8_t>(value);
+		}
+		return spec;
 	}
+};
 
-	std::string parse_vector(const std::string& str)
-	{
-		static std::string componentColours[] = { ";200;0;0m", ";0;200;0m", ";0;0;200m", ";200;200;0m" };
-		std::stringstream base(str);
-		std::stringstream stream(str);
-		std::string item;
-		std::string out = "{";
-		int matches = 0;
-		int maxMatches = 0;
-		while (std::getline(base, item, ',')) ++maxMatches;
-
-		while (std::getline(stream, item, ',')) {
-			out +=
-				"\033[38;2" + componentColours[matches % 4] + item + "\033[0m" + (matches != maxMatches - 1 ? "," : "");
-			++matches;
-		}
+static_assert(BasicFormatString<int>("a {} b").Spec(0).Begin == 2);
+static_assert(BasicFormatString<int>("{ {} }").Spec(0).Begin == 2);
+static_assert(BasicFormatString<int>("{255;}").Spec(0).R == 255);
+static_assert(BasicFormatString<int>("{;60;197;172}").Spec(0).B == 172);
+static_assert(BasicFormatString<int>("{>}").Spec(0).Kind == SpecKind::Indent);
 
-		out += "}";
-		return out;
-	}
+template<typename T>
+struct IsVector : std::false_type {};
 
-	void parse_params()
-	{
-		std::string parsed = _format;
-		auto length = parsed.length();
-		size_t bodyArgs = 0;
-		const size_t argCount = _args.size();
-
-		bool paramSequence = false;
-		uint seqStartIndex{};
-
-		for (uint i = 0; i < length; ++i) {
-			if (parsed[i] == '{') {
-				paramSequence = true;
-				seqStartIndex = i;
-				continue;
-			}
-			if (paramSequence && parsed[i] == 'v') {
-				paramSequence = false;
-				const auto vector = _args.at(bodyArgs);
-				auto span = parse_vector(vector.substr(1, vector.length() - 2));
-				parsed.replace(seqStartIndex, 3, span);
-				++bodyArgs;
-				continue;
-			}
-			if (paramSequence && parsed[i] == '>') {
-				paramSequence = false;
-				const auto indentLength = std::stoi(_args.at(bodyArgs));
-				std::string padding(indentLength, ' ');
-				parsed.replace(seqStartIndex, 3, padding);
-				++bodyArgs;
-				continue;
-			}
+template<typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template<typename T>
+void append_number(std::string& out, T value)
+{
+	// Large enough for any double printed in fixed notation
+	char buffer[512];
+	std::to_chars_result result;
+	if constexpr (std::is_floating_point_v<T>)
+		result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6);
+	else
+		result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, result.ptr);
+}
 
-			if (parsed[i] == '}' && paramSequence) {
-				paramSequence = false;
-				const auto n = i - seqStartIndex + 1;
-				if (n > 2) {
-					const auto colourSequence = parsed.substr(seqStartIndex + 1, i - seqStartIndex - 1);
+inline void append_colour(std::string& out, uint8_t r, uint8_t g, uint8_t b)
+{
+	out += "\033[38;2;";
+	append_number(out, r);
+	out += ';';
+	append_number(out, g);
+	out += ';';
+	append_number(out, b);
+	out += 'm';
+}
+
+template<typename T>
+void append_value(std::string& out, const T& value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+		out += value ? "true" : "false";
+	else if constexpr (std::is_same_v<T, char>)
+		out += value;
+	else if constexpr (std::is_arithmetic_v<T>)
+		append_number(out, value);
+	else if constexpr (std::convertible_to<const T&, std::string_view>)
+		out += std::string_view(value);
+	else if constexpr (std::convertible_to<const T&, std::string>)
+		out += static_cast<std::string>(value);
+	else if constexpr (IsVector<T>::value) {
+		out += '{';
+		for (size_t i = 0; i < value.size(); ++i) {
+			if (i)
+				out += ", ";
+			append_value(out, value[i]);
+		}
+		out += '}';
+	}
+	else
+		static_assert(IsVector<T>::value, "Type cannot be formatted");
+}
+
+template<typename T>
+void append_argument(std::string& out, const FormatSpec& spec, const T& value)
+{
+	switch (spec.Kind) {
+	case SpecKind::Value:
+		append_value(out, value);
+		return;
+	case SpecKind::Colour:
 #ifndef DISABLE_COLOURS
-					auto span = parse_colour_sequence(colourSequence);
-					span += _args.at(bodyArgs) + "\033[0m";
+		append_colour(out, spec.R, spec.G, spec.B);
+		append_value(out, value);
+		out += "\033[0m";
 #else
-					auto span = _args.at(bodyArgs);
-					i = -1;
+		append_value(out, value);
 #endif
-					parsed.replace(seqStartIndex, n, span);
-				}
-				else {
-					// FIXME: Fix bodyArgs being incremented by an argument string which itself contains '{}'
-					//        e.g. println("{}", "foo {}"), crashes the program
-					parsed.replace(seqStartIndex, i - seqStartIndex + 1, _args.at(bodyArgs));
-					if (_args.at(bodyArgs).empty())
-						--i;
-					--i;
-				}
-
-				++bodyArgs;
-				MUST(bodyArgs <= argCount && "Error: body argument count cannot exceed argument count.");
-				length = parsed.length();
+		return;
+	case SpecKind::Vector:
+		if constexpr (IsVector<T>::value) {
+			static constexpr std::string_view componentColours[] = {
+				";200;0;0m", ";0;200;0m", ";0;0;200m", ";200;200;0m"
+			};
+			out += '{';
+			for (size_t i = 0; i < value.size(); ++i) {
+				out += "\033[38;2";
+				out += componentColours[i % 4];
+				if (i)
+					out += ' ';
+				append_value(out, value[i]);
+				out += "\033[0m";
+				if (i + 1 != value.size())
+					out += ',';
 			}
-			length = parsed.length();
+			out += '}';
 		}
-		MUST(argCount == bodyArgs && "Error: argument count cannot exceed body argument count.");
-		_text = parsed;
+		else
+			append_value(out, value);
+		return;
+	case SpecKind::Indent:
+		if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+			out.append(static_cast<size_t>(std::max<T>(value, 0)), ' ');
+		else
+			append_value(out, value);
+		return;
 	}
+}
 
-public:
-	VariadicArgParser() = delete;
-
-	explicit VariadicArgParser(std::string format, const Param&... args) : _format(std::move(format))
-	{
-		set_args(args...);
-		parse_params();
-	}
+// Reused by print and println so writing a line doesn't allocate once the buffer has grown
+inline std::string& line_buffer()
+{
+	thread_local std::string buffer;
+	buffer.clear();
+	return buffer;
+}
 
-	operator std::string() const { return _text; }
-};
+inline void write(const std::string& text) { std::cout.write(text.data(), static_cast<std::streamsize>(text.size())); }
 
 } // namespace __alx
 
+// Like std::format_string: only the arguments take part in deduction, and the format is checked against them
+template<typename... Param>
+using FormatString = __alx::BasicFormatString<std::type_identity_t<Param>...>;
+
+// Appends the formatted text to `out` without any intermediate strings
+template<typename... Param>
+void formatTo(std::string& out, FormatString<Param...> format, const Param&... arguments)
+{
+	const auto text = format.Text();
+	size_t literalStart = 0;
+	size_t index = 0;
+	[[maybe_unused]] const auto appendNext = [&](const auto& argument) {
+		const auto& spec = format.Spec(index++);
+		out.append(text, literalStart, spec.Begin - literalStart);
+		__alx::append_argument(out, spec, argument);
+		literalStart = spec.End + 1;
+	};
+	(appendNext(arguments), ...);
+	out.append(text, literalStart);
+}
+
+template<typename... Param>
+void formatTo(std::string& out,
+			  [[maybe_unused]] Colour colour,
+			  FormatString<Param...> format,
+			  const Param&... arguments)
+{
+	formatTo(out, format, arguments...);
+}
+
 template<typename... Param>
-std::string getFormatted([[maybe_unused]] Colour colour, const std::string& format, const Param&... arguments)
+std::string getFormatted([[maybe_unused]] Colour colour, FormatString<Param...> format, const Param&... arguments)
 {
-	const __alx::VariadicArgParser<Param...> parser{ format, arguments... };
-	return parser;
+	std::string text;
+	formatTo(text, format, arguments...);
+	return text;
 }
 
 template<typename... Param>
-std::string getFormatted(const std::string& format, const Param&... arguments)
+std::string getFormatted(FormatString<Param...> format, const Param&... arguments)
 {
-	const __alx::VariadicArgParser<Param...> parser{ format, arguments... };
-	return parser;
+	std::string text;
+	formatTo(text, format, arguments...);
+	return text;
 }
 
 template<typename... Param>
-void println(const std::string& format, const Param&... arguments)
+void println(FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
-	std::cout << text << '\n';
+	auto& buffer = __alx::line_buffer();
+	formatTo(buffer, format, arguments...);
+	buffer += '\n';
+	__alx::write(buffer);
 }
 
 template<typename...>
@@ -233,46 +296,52 @@ void println()
 }
 
 template<typename... Param>
-void println(Colour colour, const std::string& format, const Param&... arguments)
+void println(Colour colour, FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
+	auto& buffer = __alx::line_buffer();
 #ifndef DISABLE_COLOURS
-	println("\033[38;2;{};{};{}m{}\033[0m", colour.r, colour.g, colour.b, text);
+	__alx::append_colour(buffer, colour.r, colour.g, colour.b);
+	formatTo(buffer, format, arguments...);
+	buffer += "\033[0m\n";
 #else
-	println(text);
+	formatTo(buffer, format, arguments...);
+	buffer += '\n';
 #endif
+	__alx::write(buffer);
 }
 
 template<typename... Param>
-void print(const std::string& format, const Param&... arguments)
+void print(FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
-	std::cout << text;
+	auto& buffer = __alx::line_buffer();
+	formatTo(buffer, format, arguments...);
+	__alx::write(buffer);
 }
 
 template<typename... Param>
-void print(Colour colour, const std::string& format, const Param&... arguments)
+void print(Colour colour, FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
+	auto& buffer = __alx::line_buffer();
 #ifndef DISABLE_COLOURS
-	print("\033[38;2;{};{};{}m{}\033[0m", colour.r, colour.g, colour.b, text);
+	__alx::append_colour(buffer, colour.r, colour.g, colour.b);
+	formatTo(buffer, format, arguments...);
+	buffer += "\033[0m";
 #else
-	print(text);
+	formatTo(buffer, format, arguments...);
 #endif
+	__alx::write(buffer);
 }
 
 template<typename... Param>
-void todo(const std::string& format, const Param&... arguments)
+void todo(FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
-	println(Colour::Yellow, "TODO: {}", text);
+	println(Colour::Yellow, "TODO: {}", getFormatted(format, arguments...));
 }
 
 template<typename... Param>
-void fixme(const std::string& format, const Param&... arguments)
+void fixme(FormatString<Param...> format, const Param&... arguments)
 {
-	const auto text = getFormatted(format, arguments...);
-	println(Colour::Orange, "FIXME: {}", text);
+	println(Colour::Orange, "FIXME: {}", getFormatted(format, arguments...));
 }
 
 inline std::string token_to_string(TokenType token)
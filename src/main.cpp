@@ -2,7 +2,6 @@
  * Copyright (c) 2023 Donatas Mockus.
  */
 #include <iostream>
-#include <fstream>
 #include <libs/Println.h>
 #include <Utils/Flags.h>
 #include "libs/argparse.hpp"
@@ -34,7 +33,9 @@ int main(int argc, const char** argv)
 	program.add_argument("--dump-ir")
 		.default_value<std::string>("")
 		.nargs(1)
-		.help("Output intermediate representation to the console.");
+		.help("Output intermediate representation to the console at each of the comma separated stages: initial, isel, "
+			  "the name of a pass to dump after it, before-<pass> to dump before it, or all. The IR passes only run "
+			  "when one of these other than initial asks for their output.");
 
 	program.add_argument("-q", "--quiet")
 		.default_value(false)
@@ -60,6 +61,29 @@ int main(int argc, const char** argv)
 		.implicit_value(true)
 		.help("Enable colours in diagnostic output.");
 
+	program.add_argument("--diagnostics-format")
+		.default_value<std::string>("text")
+		.action([](const std::string& value) {
+			if (value != "text" && value != "json")
+				throw std::runtime_error("--diagnostics-format must be either 'text' or 'json'");
+			return value;
+		})
+		.help("Diagnostic output format: 'text' or 'json'.");
+
+	program.add_argument("-ferror-limit")
+		.default_value<size_t>(20)
+		.scan<'u', size_t>()
+		.help("Stop parsing after this many errors, 0 for no limit.");
+
+	program.add_argument("-fparse-threads")
+		.default_value<size_t>(1)
+		.scan<'u', size_t>()
+		.help("Parse function declarations on this many threads, 0 for one per core.");
+
+	program.add_argument("--ast-cache")
+		.default_value<std::string>("")
+		.help("Cache parsed ASTs in this directory, so an unchanged file isn't parsed again.");
+
 	program.add_argument("-Werror").default_value(false).implicit_value(true).help("Treat all warnings as errors.");
 
 	program.add_argument("filename");
@@ -72,24 +96,22 @@ int main(int argc, const char** argv)
 		return EXIT_FAILURE;
 	}
 	auto programName = program.get<std::string>("filename");
-	std::string sourceBuffer;
-	{
-		auto ss = std::ostringstream{};
-		std::ifstream input(programName);
-		if (!input.is_open()) {
-			if (!program.get<bool>("-q"))
-				alx::println(alx::Colour::LightRed, "File '{}' not found!", programName);
-			return EXIT_FAILURE;
-		}
+	// "-" reads the source from stdin
+	auto sourceBuffer = alx::SourceBuffer::Open(programName);
+	if (!sourceBuffer) {
 		if (!program.get<bool>("-q"))
-			alx::println("Parsing {}", programName);
-		ss << input.rdbuf();
-		sourceBuffer = ss.str();
-		input.close();
+			alx::println(alx::Colour::LightRed, "File '{}' not found!", programName);
+		return EXIT_FAILURE;
 	}
-	if (sourceBuffer.length() <= 0)
+	// JSON diagnostics are meant to be read by another program, so stdout has nothing else on it
+	if (!program.get<bool>("-q") && program.get<std::string>("--diagnostics-format") != "json")
+		alx::println("Parsing {}", programName);
+	if (sourceBuffer->Empty())
 		return 0;
 
-	alx::Compiler compiler{ sourceBuffer, programName, alx::resolveFlags(program), alx::resolveDebugFlags(program) };
+	alx::Compiler compiler{
+		std::move(sourceBuffer.value()), programName, alx::resolveFlags(program), alx::resolveDebugFlags(program)
+	};
 	compiler.Compile();
+	return compiler.ErrorCount() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
\ No newline at end of file
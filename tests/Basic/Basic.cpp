@@ -6,7 +6,157 @@
 // Created by aelliixx on 2023-09-19.
 //
 
+#include <pthread.h>
+#include <sys/time.h>
+#include <climits>
+#include <csignal>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include "../../src/AST/Serialise.h"
 #include "../../src/Compiler.h"
+#include "../../src/Tokeniser/Scanner.h"
+
+// Parses `code` on its own, without the stages after it
+static std::unique_ptr<alx::Program> parse(std::string_view code, size_t& errors, size_t threads = 1)
+{
+	auto errorHandler = std::make_shared<alx::ErrorHandler>(code, "Parse", false, alx::DiagnosticsFormat::Json);
+	auto interner = std::make_shared<alx::Interner>();
+	alx::Tokeniser tokeniser(code, errorHandler, interner);
+	alx::Parser parser(tokeniser.Tokenise(), errorHandler, interner);
+	auto program = parser.Parse(threads);
+	errors = errorHandler->ErrorCount();
+	errorHandler->Flush();
+	return program;
+}
+
+// Everything parsing `code` prints: its diagnostics, then its AST if there were no syntax errors
+static std::string parseOutput(std::string_view code, size_t threads)
+{
+	std::ostringstream output;
+	auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+	size_t errors;
+	if (auto program = parse(code, errors, threads))
+		program->PrintNode(0);
+	std::cout.rdbuf(stdoutBuffer);
+	return output.str();
+}
+
+static std::string printed(const alx::Program& program)
+{
+	std::ostringstream output;
+	auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+	program.PrintNode(0);
+	std::cout.rdbuf(stdoutBuffer);
+	return output.str();
+}
+
+// Replaces the first occurrence of each pair's first string in `before` with its second, going from left to right,
+// then lexes and parses the result incrementally. Returns the functions the reparse says changed, or "mismatch" if
+// the tokens or the AST differ from those of a parse from scratch, or the unchanged functions weren't reused.
+static std::set<std::string> reparseEdited(std::string_view before,
+										   std::initializer_list<std::pair<std::string_view, std::string_view>> changes)
+{
+	std::vector<alx::SourceEdit> edits;
+	std::string after;
+	size_t copied = 0;
+	for (const auto& [from, to] : changes) {
+		const auto begin = before.find(from, copied);
+		after.append(before.substr(copied, begin - copied)).append(to);
+		edits.push_back({ .Begin = begin, .End = begin + from.length(), .Length = to.length() });
+		copied = begin + from.length();
+	}
+	after.append(before.substr(copied));
+	const std::set<std::string> mismatch{ "mismatch" };
+
+	auto interner = std::make_shared<alx::Interner>();
+	auto beforeErrors = std::make_shared<alx::ErrorHandler>(before, "Before", false);
+	alx::Tokeniser beforeTokeniser(before, beforeErrors, interner);
+	const auto beforeTokens = beforeTokeniser.Tokenise();
+	auto previous = alx::Parser(beforeTokens, beforeErrors, interner).Parse();
+	std::map<alx::SymbolId, const alx::ASTNode*> previousFunctions;
+	for (const auto* statement : previous->GetChildren())
+		if (statement->Kind() == alx::NodeKind::FunctionDeclaration)
+			previousFunctions[static_cast<const alx::FunctionDeclaration*>(statement)->Symbol()] = statement;
+
+	auto freshErrors = std::make_shared<alx::ErrorHandler>(after, "Fresh", false);
+	alx::Tokeniser freshTokeniser(after, freshErrors, interner);
+	const auto freshTokens = freshTokeniser.Tokenise();
+	auto afterErrors = std::make_shared<alx::ErrorHandler>(after, "After", false);
+	alx::Tokeniser afterTokeniser(after, afterErrors, interner);
+	const auto tokens = afterTokeniser.Tokenise(beforeTokens, edits);
+	if (tokens.Size() != freshTokens.Size() || afterErrors->Lines()->Starts() != freshErrors->Lines()->Starts())
+		return mismatch;
+	for (size_t i = 0; i < tokens.Size(); ++i) {
+		const auto token = tokens.At(i);
+		const auto fresh = freshTokens.At(i);
+		if (token.Type() != fresh.Type() || token.Offset() != fresh.Offset() || token.Value() != fresh.Value()
+			|| token.Line() != fresh.Line() || token.Column() != fresh.Column())
+			return mismatch;
+	}
+
+	auto [ast, changed] = alx::Parser(tokens, afterErrors, interner).Reparse(std::move(previous), edits);
+	const auto freshAst = alx::Parser(freshTokens, freshErrors, interner).Parse();
+	if (!ast || printed(*ast) != printed(*freshAst))
+		return mismatch;
+	for (const auto* statement : ast->GetChildren()) {
+		if (statement->Kind() != alx::NodeKind::FunctionDeclaration)
+			continue;
+		const auto symbol = static_cast<const alx::FunctionDeclaration*>(statement)->Symbol();
+		if (changed.contains(symbol) == (previousFunctions[symbol] == statement))
+			return mismatch;
+	}
+	std::set<std::string> names;
+	for (const auto symbol : changed)
+		names.emplace(interner->Name(symbol));
+	return names;
+}
+
+// Runs `work` on a thread of its own whose stack is only `size` bytes
+static void runWithStack(size_t size, std::function<void()> work)
+{
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, size);
+	pthread_t thread;
+	pthread_create(
+		&thread,
+		&attributes,
+		[](void* argument) -> void* {
+			(*static_cast<std::function<void()>*>(argument))();
+			return nullptr;
+		},
+		&work);
+	pthread_join(thread, nullptr);
+	pthread_attr_destroy(&attributes);
+}
+
+// Writes an expression out with every operation bracketed, e.g. "(a+(b*c))"
+static std::string bracketed(const alx::Expression* expression)
+{
+	switch (expression->Kind()) {
+	case alx::NodeKind::Identifier:
+		return std::string(static_cast<const alx::Identifier*>(expression)->Name());
+	case alx::NodeKind::NumberLiteral:
+		return std::string(static_cast<const alx::NumberLiteral*>(expression)->Value());
+	case alx::NodeKind::UnaryExpression: {
+		auto unary = static_cast<const alx::UnaryExpression*>(expression);
+		auto op = alx::token_to_string(unary->Operator());
+		if (unary->Postfix())
+			return "(" + bracketed(unary->Rhs()) + op + ")";
+		return "(" + op + bracketed(unary->Rhs()) + ")";
+	}
+	case alx::NodeKind::BinaryExpression: {
+		auto binary = static_cast<const alx::BinaryExpression*>(expression);
+		return "(" + bracketed(binary->Lhs()) + alx::token_to_string(binary->Operator()) + bracketed(binary->Rhs()) + ")";
+	}
+	default:
+		return "?";
+	}
+}
 
 int main(int, char* argv[])
 {
@@ -45,4 +195,566 @@ int main(int, char* argv[])
 			"ret\n";
 		return expected != compiler.GetAsm();
 	}
+	if (arg == "literals")
+	{
+		auto code = "int main() {\n"
+					"	int a = 1,000;\n"
+					"	long b = -12,345,678;\n"
+					"	bool c = true;\n"
+					"}";
+		alx::Compiler compiler{ code, "Literals", {}, df };
+		compiler.Compile();
+		std::string expected =
+			"global _start\n"
+			"section .bss\n"
+			"section .data\n"
+			"section .text\n"
+			"\n"
+			"_start:\n"
+			"xor ebp, ebp\n"
+			"call main\n"
+			"mov rdi, rax\n"
+			"mov rax, 60\n"
+			"syscall\n"
+			"\n"
+			"main:\n"
+			"push rbp\n"
+			"mov rbp, rsp\n"
+			"mov DWORD [rbp-4], 1000\n"
+			"mov QWORD [rbp-16], -12345678\n"
+			"mov BYTE [rbp-17], 1\n"
+			"xor eax, eax\n"
+			"pop rbp\n"
+			"ret\n";
+		return expected != compiler.GetAsm();
+	}
+	if (arg == "integer_literal_range")
+	{
+		// Both ends of a long lex as they are, and anything past them is an error rather than a wrapped value
+		auto code = "long a = 9,223,372,036,854,775,807;\n"
+					"long b = -9223372036854775808;\n"
+					"long c = 99999999999999999999;\n"
+					"long d = -9223372036854775809;\n"
+					"double e = 99999999999999999999.5;";
+		std::ostringstream output;
+		auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+		auto errorHandler = std::make_shared<alx::ErrorHandler>(code, "Range", false, alx::DiagnosticsFormat::Json);
+		alx::Tokeniser tokeniser(code, errorHandler, std::make_shared<alx::Interner>());
+		const auto tokens = tokeniser.Tokenise();
+		errorHandler->Flush();
+		std::cout.rdbuf(stdoutBuffer);
+		std::vector<alx::NumberValue> numbers;
+		for (size_t i = 0; i < tokens.Size(); ++i)
+			if (tokens.At(i).Type() == alx::TokenType::T_INT_L || tokens.At(i).Type() == alx::TokenType::T_DOUBLE_L)
+				numbers.push_back(tokens.At(i).Number());
+		std::string expected = R"({"file":"Range","line":3,"column":10,"severity":"error",)"
+							   R"("message":"Integer literal '99999999999999999999' out of range"})"
+							   "\n"
+							   R"({"file":"Range","line":4,"column":10,"severity":"error",)"
+							   R"("message":"Integer literal '-9223372036854775809' out of range"})"
+							   "\n";
+		return output.str() != expected || numbers.size() != 5 || numbers[0] != alx::NumberValue(LONG_MAX)
+			|| numbers[1] != alx::NumberValue(LONG_MIN) || numbers[4] != alx::NumberValue(99999999999999999999.5);
+	}
+	if (arg == "scanner")
+	{
+		// Each width must agree with a byte at a time walk from every position, so runs end on, just before and just
+		// past 16 and 32 byte boundaries, and some sources are shorter than a vector
+		std::vector<std::string> sources{ "", "a", " \n", "ab +", "//" };
+		for (const size_t length : { 15, 16, 17, 31, 32, 33, 63, 64, 65 }) {
+			std::string whitespace;
+			std::string identifier;
+			for (size_t i = 0; i < length; ++i) {
+				whitespace += " \t\n"[i % 3];
+				identifier += "a_Z9"[i % 4];
+			}
+			sources.push_back(whitespace);
+			sources.push_back(whitespace + "x");
+			sources.push_back(identifier);
+			sources.push_back(identifier + "+");
+			sources.push_back("// " + identifier);
+		}
+		const auto runEnd = [](std::string_view source, size_t pos, auto inRun) {
+			while (pos < source.length() && inRun(source[pos])) ++pos;
+			return pos;
+		};
+		const auto isWhitespace = [](char c) { return c == ' ' || c == '\t' || c == '\n'; };
+		const auto isIdentifier = [](char c) {
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		};
+		const auto notNewline = [](char c) { return c != '\n'; };
+
+		// A comment running to the end of the file, and tokens after runs of several newlines that cross vectors
+		const std::string longCode = "int a;" + std::string(20, '\n') + "\t int " + std::string(33, 'b')
+									 + " = 1;\n\n \n" + std::string(40, ' ') + "// no newline after this comment";
+		const auto tokeniseMatches = [](std::string_view code, size_t tokenCount) {
+			auto errorHandler = std::make_shared<alx::ErrorHandler>(code, "Scanner", false);
+			alx::Tokeniser tokeniser(code, errorHandler, std::make_shared<alx::Interner>());
+			const auto tokens = tokeniser.Tokenise();
+			if (errorHandler->ErrorCount() != 0 || tokens.Size() != tokenCount)
+				return false;
+			std::vector<uint32_t> lineStarts{ 0 };
+			for (size_t i = 0; i < code.length(); ++i)
+				if (code[i] == '\n')
+					lineStarts.push_back(static_cast<uint32_t>(i + 1));
+			if (tokens.Lines().Starts() != lineStarts)
+				return false;
+			for (size_t i = 0; i < tokens.Size(); ++i) {
+				const auto position = tokens.At(i).Position();
+				const auto line = static_cast<size_t>(std::count(code.begin(), code.begin() + position, '\n')) + 1;
+				const auto column = position + 1 - lineStarts[line - 1] + (line > 1 ? 1 : 0);
+				if (tokens.At(i).Line() != line || tokens.At(i).Column() != column)
+					return false;
+			}
+			return true;
+		};
+
+		for (const auto width : { alx::ScanWidth::Avx2, alx::ScanWidth::Sse2, alx::ScanWidth::Scalar }) {
+			alx::limit_scan_width(width);
+			for (const std::string_view source : sources) {
+				for (size_t pos = 0; pos <= source.length(); ++pos) {
+					std::vector<uint32_t> lineStarts;
+					std::vector<uint32_t> expectedStarts;
+					for (size_t i = pos; i < source.length(); ++i)
+						if (source[i] == '\n')
+							expectedStarts.push_back(static_cast<uint32_t>(i + 1));
+					if (alx::skip_whitespace(source, pos) != runEnd(source, pos, isWhitespace)
+						|| alx::skip_identifier(source, pos) != runEnd(source, pos, isIdentifier)
+						|| alx::find_line_end(source, pos) != runEnd(source, pos, notNewline)
+						|| alx::find_newlines(source, pos, source.length(), lineStarts) != expectedStarts.size()
+						|| lineStarts != expectedStarts)
+						return 1;
+				}
+			}
+			if (!tokeniseMatches(longCode, 8) || !tokeniseMatches("a // b", 1))
+				return 1;
+		}
+		return 0;
+	}
+	if (arg == "source_buffer")
+	{
+		std::string code;
+		for (size_t i = 0; i < 1000; ++i) code += "int a" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+
+		// A regular file is mapped, and an empty one reads as empty without being mapped
+		const auto directory =
+			std::filesystem::temp_directory_path() / ("alx-source-buffer-" + std::to_string(getpid()));
+		std::filesystem::create_directories(directory);
+		std::ofstream(directory / "code.alx") << code;
+		std::ofstream(directory / "empty.alx");
+		const auto file = alx::SourceBuffer::Open((directory / "code.alx").string());
+		const auto empty = alx::SourceBuffer::Open((directory / "empty.alx").string());
+		const auto missing = alx::SourceBuffer::Open((directory / "missing.alx").string());
+		std::filesystem::remove_all(directory);
+		if (!file || !file->Mapped() || file->View() != code || !empty || !empty->Empty() || empty->Mapped() || missing)
+			return 1;
+
+		// A pipe can't be mapped, so it is read. The writer holds off until a signal has interrupted that read, which
+		// must carry on rather than fail. The writer inherits the signal blocked, so only this thread can take it.
+		int pipeEnds[2];
+		if (::pipe(pipeEnds) != 0)
+			return 1;
+		sigset_t alarm;
+		sigemptyset(&alarm);
+		sigaddset(&alarm, SIGALRM);
+		pthread_sigmask(SIG_BLOCK, &alarm, nullptr);
+		std::thread writer([&code, &pipeEnds] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			for (size_t written = 0; written < code.size();)
+				written += static_cast<size_t>(::write(pipeEnds[1], code.data() + written, code.size() - written));
+			::close(pipeEnds[1]);
+		});
+		pthread_sigmask(SIG_UNBLOCK, &alarm, nullptr);
+		struct sigaction action
+		{};
+		action.sa_handler = [](int) {};
+		sigaction(SIGALRM, &action, nullptr); // Without SA_RESTART, so the read sees EINTR
+		itimerval timer{ .it_interval = {}, .it_value = { .tv_sec = 0, .tv_usec = 20'000 } };
+		setitimer(ITIMER_REAL, &timer, nullptr);
+		const auto piped = alx::SourceBuffer::Open("/dev/fd/" + std::to_string(pipeEnds[0]));
+		writer.join();
+		::close(pipeEnds[0]);
+		if (!piped || piped->Mapped() || piped->View() != code)
+			return 1;
+
+		// "-" reads stdin
+		const int savedStdin = ::dup(STDIN_FILENO);
+		if (::pipe(pipeEnds) != 0)
+			return 1;
+		(void)::write(pipeEnds[1], "int main() {}", 13);
+		::close(pipeEnds[1]);
+		::dup2(pipeEnds[0], STDIN_FILENO);
+		::close(pipeEnds[0]);
+		const auto standardInput = alx::SourceBuffer::Open("-");
+		::dup2(savedStdin, STDIN_FILENO);
+		::close(savedStdin);
+		return !standardInput || standardInput->Mapped() || standardInput->View() != "int main() {}";
+	}
+	if (arg == "diagnostics_json")
+	{
+		auto code = "int main() {\n"
+					"	int a = 1;\n"
+					"	int a = 2;\n"
+					"}";
+		// Not quiet, so the summary is written too. The IR generator's progress goes to stderr.
+		const alx::DebugFlags verbose{};
+		const std::string fileName = "Diagnostics";
+		std::ostringstream output;
+		auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+		alx::Compiler compiler{ code, fileName, { .diagnostics_format = alx::DiagnosticsFormat::Json }, verbose };
+		compiler.Compile();
+		std::cout.rdbuf(stdoutBuffer);
+		std::string expected = R"({"file":"Diagnostics","line":3,"column":7,"severity":"error",)"
+							   R"("message":"Redefinition of variable 'a'"})"
+							   "\n"
+							   R"({"errors":1,"warnings":0,"notes":0})"
+							   "\n";
+		return output.str() != expected;
+	}
+	if (arg == "scopes")
+	{
+		// Block variables can't shadow their function's and are gone once the block closes
+		auto code = "int main() {\n"
+					"	int a = 1;\n"
+					"	if (a < 2) {\n"
+					"		int a = 3;\n"
+					"		int b = a;\n"
+					"	}\n"
+					"	int b = 3;\n"
+					"	while (b < 2) {\n"
+					"		int c = b;\n"
+					"	}\n"
+					"	return c;\n"
+					"}";
+		std::ostringstream output;
+		auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+		alx::Compiler compiler{ code, "Scopes", { .diagnostics_format = alx::DiagnosticsFormat::Json }, df };
+		compiler.Compile();
+		std::cout.rdbuf(stdoutBuffer);
+		std::string expected = R"({"file":"Scopes","line":4,"column":8,"severity":"error",)"
+							   R"("message":"Redefinition of variable 'a'"})"
+							   "\n"
+							   R"({"file":"Scopes","line":11,"column":10,"severity":"error",)"
+							   R"("message":"Use of undeclared identifier 'c'"})"
+							   "\n";
+		return !output.str().starts_with(expected);
+	}
+	if (arg == "syntax_errors")
+	{
+		// Each broken statement is reported and skipped, and the rest of the function is still checked
+		auto code = "int main() {\n"
+					"	int a = 1;\n"
+					"	if (a < ) {\n"
+					"		a = 2;\n"
+					"	}\n"
+					"	int b 3;\n"
+					"	return a\n"
+					"}";
+		std::ostringstream output;
+		auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+		alx::Compiler compiler{ code, "SyntaxErrors", { .diagnostics_format = alx::DiagnosticsFormat::Json }, df };
+		compiler.Compile();
+		std::cout.rdbuf(stdoutBuffer);
+		std::string expected = R"({"file":"SyntaxErrors","line":3,"column":11,"severity":"error",)"
+							   R"("message":"Unexpected token ')'"})"
+							   "\n"
+							   R"({"file":"SyntaxErrors","line":6,"column":9,"severity":"error",)"
+							   R"("message":"Expected '=', ';' or '(' after 'b'"})"
+							   "\n"
+							   R"({"file":"SyntaxErrors","line":7,"column":10,"severity":"error",)"
+							   R"("message":"Expected token ';' after 'identifier'"})"
+							   "\n";
+		return output.str() != expected || compiler.ErrorCount() != 3;
+	}
+	if (arg == "error_limit")
+	{
+		// Past the limit nothing more is recorded, whichever stage finds the errors, and the limit is noted once
+		const auto diagnostics = [&df](const std::string& code) {
+			const std::string fileName = "ErrorLimit";
+			std::ostringstream output;
+			auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+			alx::Compiler compiler{
+				code, fileName, { .diagnostics_format = alx::DiagnosticsFormat::Json, .error_limit = 3 }, df
+			};
+			compiler.Compile();
+			std::cout.rdbuf(stdoutBuffer);
+			std::vector<std::string> lines;
+			std::istringstream stream(output.str());
+			for (std::string line; std::getline(stream, line);) lines.push_back(line);
+			return std::make_pair(compiler.ErrorCount(), lines);
+		};
+		const auto limited = [](const std::pair<size_t, std::vector<std::string>>& result) {
+			const auto& [errors, lines] = result;
+			return errors == 3 && lines.size() == 4 && lines[2].find("\"error\"") != std::string::npos
+				&& lines[3].find("Too many errors") != std::string::npos;
+		};
+
+		std::string literals = "int main() {\n";
+		for (size_t i = 0; i < 50; ++i) literals += "\tlong a" + std::to_string(i) + " = 99999999999999999999;\n";
+		literals += "\treturn 0;\n}\n";
+		const auto unassignable = "int main() {\n\tint a = 1;\n\tint b = " + std::string(50, '-') + "a;\n}\n";
+		return !limited(diagnostics(literals)) || !limited(diagnostics(unassignable));
+	}
+	if (arg == "expression_precedence")
+	{
+		auto code = "int main() {\n"
+					"	int a = 1;\n"
+					"	int b = 2;\n"
+					"	a + b * a - b / 2;\n"
+					"	a = b = a;\n"
+					"	-a ^ b ^ 2;\n"
+					"	a++ * --b;\n"
+					"	!(a + b) < a == b != 1;\n"
+					"	a += b %= (a - b) % 2;\n"
+					"}";
+		size_t errors;
+		auto program = parse(code, errors);
+		if (!program || errors)
+			return 1;
+		const auto& function = static_cast<const alx::FunctionDeclaration&>(*program->GetChildren()[0]);
+		std::string parsed;
+		for (const auto* statement : function.Body().Children().subspan(2))
+			parsed += bracketed(static_cast<const alx::Expression*>(statement)) + "\n";
+		return parsed != "((a+(b*a))-(b/2))\n"
+						 "(a=(b=a))\n"
+						 "(-(a^(b^2)))\n"
+						 "((a++)*(--b))\n"
+						 "((((!(a+b))<a)==b)!=1)\n"
+						 "(a+=(b%=((a-b)%2)))\n";
+	}
+	if (arg == "deep_expressions")
+	{
+		// Far deeper than the parser could go if it recursed
+		constexpr size_t Depth = 100'000;
+		std::string code = "int main() {\n\tint a = 1;\n\t";
+		code += std::string(Depth, '(') + "a" + std::string(Depth, ')') + ";\n\t";
+		for (size_t i = 0; i < Depth; ++i)
+			code += "a = ";
+		code += "a;\n\t" + std::string(Depth, '!') + "a;\n}";
+		size_t errors;
+		auto program = parse(code, errors);
+		return !program || errors;
+	}
+	if (arg == "deep_lowering")
+	{
+		// Lowered and generated on a stack a recursive pass would overflow long before the end of either
+		constexpr size_t Terms = 100'000;
+		constexpr size_t Links = 2'000;
+		std::string code = "int main() {\n\tint a = 1;\n\tint b = a";
+		for (size_t i = 1; i < Terms; ++i)
+			code += " + a";
+		code += ";\n\tif (a == 0) b = 0;\n";
+		for (size_t i = 1; i < Links; ++i)
+			code += "\telse if (a == " + std::to_string(i) + ") b = " + std::to_string(i) + ";\n";
+		code += "\treturn b;\n}";
+		std::string assembly;
+		runWithStack(256 * 1024, [&] {
+			alx::Compiler compiler{ code, "DeepLowering", {}, df };
+			compiler.Compile();
+			assembly = compiler.GetAsm();
+		});
+		if (assembly.find("cmp eax, " + std::to_string(Links - 1) + "\n") == std::string::npos)
+			return 1;
+
+		// Blocks are still walked by recursing, so they can only nest as deep as the parser allows. Past that there's
+		// an error rather than a stack overflow.
+		const auto nested = [](size_t depth) {
+			std::string code = "int main() {\n\tint a = 1;\n";
+			for (size_t i = 0; i < depth; ++i)
+				code += "if (a) {\n";
+			code += "a = 2;\n";
+			for (size_t i = 0; i < depth; ++i)
+				code += "}\n";
+			return code + "\treturn a;\n}\n";
+		};
+		const auto deepest = nested(256);
+		alx::Compiler deepestCompiler{ deepest, "DeepNesting", {}, df };
+		deepestCompiler.Compile();
+		if (deepestCompiler.ErrorCount() || deepestCompiler.GetAsm().empty())
+			return 1;
+		const auto tooDeep = nested(257);
+		std::ostringstream output;
+		auto* const stdoutBuffer = std::cout.rdbuf(output.rdbuf());
+		alx::Compiler tooDeepCompiler{
+			tooDeep, "DeepNesting", { .diagnostics_format = alx::DiagnosticsFormat::Json }, df
+		};
+		tooDeepCompiler.Compile();
+		std::cout.rdbuf(stdoutBuffer);
+		return tooDeepCompiler.ErrorCount() != 1
+			|| output.str().find("Blocks can't be nested more than 256 deep") == std::string::npos;
+	}
+	if (arg == "parallel_parse")
+	{
+		// Splitting the file between threads mustn't change the AST or the order of the diagnostics
+		std::string valid = "struct Point {\n\tint x;\n\tint y;\n}\n";
+		std::string invalid = valid;
+		for (size_t i = 0; i < 200; ++i) {
+			const auto n = std::to_string(i);
+			const auto function = "int f" + n + "() {\n\tPoint p;\n\tint a = p.x + " + n + ";\n";
+			valid += function + "\treturn a;\n}\n";
+			invalid += function + (i % 40 == 7 ? "\tint b = ;\n\treturn a\n}\n" : "\treturn a;\n}\n");
+		}
+		// Only visible to the functions after it
+		valid += "struct Late {\n\tint z;\n}\nint g() {\n\tLate l;\n\tint z = l.z;\n\treturn z;\n}\n";
+
+		const auto sequential = parseOutput(valid, 1);
+		const auto sequentialErrors = parseOutput(invalid, 1);
+		if (sequential.find("object: l") == std::string::npos || sequentialErrors.find("error") == std::string::npos)
+			return 1;
+		return parseOutput(valid, 4) != sequential || parseOutput(invalid, 4) != sequentialErrors;
+	}
+	if (arg == "constant_folding")
+	{
+		using alx::ConstantValue;
+		using alx::TokenType;
+		// Integers wrap at their type's width, and division by zero is left for the program to do
+		const ConstantValue intMax{ TokenType::T_INT, 2147483647L };
+		const ConstantValue one{ TokenType::T_INT_L, 1L };
+		if (ConstantValue::Fold(TokenType::T_PLUS, intMax, one)->AsInt() != -2147483648L
+			|| ConstantValue(TokenType::T_INT_L, 200L).Cast(TokenType::T_CHAR).AsInt() != -56
+			|| ConstantValue::Fold(TokenType::T_FWD_SLASH, { TokenType::T_LONG, LONG_MIN }, { TokenType::T_LONG, -1L })
+					   ->AsInt() != LONG_MIN
+			|| ConstantValue::Fold(TokenType::T_MOD, intMax, { TokenType::T_INT_L, 0L }))
+			return 1;
+		// An int operand is converted to float, and the result rounded to single precision
+		const ConstantValue three{ TokenType::T_INT_L, 3L };
+		const auto third = ConstantValue::Fold(TokenType::T_FWD_SLASH, { TokenType::T_FLOAT_L, 1.0 }, three);
+		if (third->Type() != TokenType::T_FLOAT || third->AsDouble() != static_cast<double>(1.0f / 3))
+			return 1;
+		// Float results that overflow or aren't numbers are left for the program, like dividing an integer by zero
+		const ConstantValue zero{ TokenType::T_DOUBLE_L, 0.0 };
+		if (ConstantValue::Fold(TokenType::T_STAR, { TokenType::T_DOUBLE_L, 1e308 }, { TokenType::T_DOUBLE_L, 10.0 })
+			|| ConstantValue::Fold(TokenType::T_FWD_SLASH, zero, zero)
+			|| ConstantValue::Fold(TokenType::T_STAR, { TokenType::T_FLOAT_L, 3e38 }, { TokenType::T_FLOAT_L, 10.0 }))
+			return 1;
+
+		// A condition folded to a literal has its digits written out in full, never in exponent form
+		auto conditions = "int main() {\n"
+						  "	if (100000000000.0 * 100000000000.0) {\n\t}\n"
+						  "	if (0.0000000001 * 0.0000000001) {\n\t}\n"
+						  "	if (0.0 / 0.0) {\n\t}\n"
+						  "}";
+		size_t conditionErrors;
+		auto conditionProgram = parse(conditions, conditionErrors);
+		if (!conditionProgram || conditionErrors)
+			return 1;
+		const auto ifStatements =
+			static_cast<const alx::FunctionDeclaration&>(*conditionProgram->GetChildren()[0]).Body().Children();
+		const auto conditionText = [&](size_t i) -> std::string_view {
+			const auto* condition = static_cast<const alx::IfStatement&>(*ifStatements[i]).Condition();
+			if (condition->Kind() != alx::NodeKind::NumberLiteral)
+				return "not folded";
+			return static_cast<const alx::NumberLiteral*>(condition)->Value();
+		};
+		if (conditionText(0) != "10000000000000000000000.0" || !conditionText(1).starts_with("0.00000000000000000001")
+			|| conditionText(1).find('e') != std::string_view::npos || conditionText(2) != "not folded")
+			return 1;
+
+		// Constant subtrees of any shape are folded as they're parsed
+		auto code = "int main() {\n"
+					"	int a = 1;\n"
+					"	2 * (3 + 4) - -1;\n"
+					"	!(2 ^ 3 < 8);\n"
+					"	1 / 0;\n"
+					"	(1 + 2) * a;\n"
+					"	3000000000 + 1;\n"
+					"	5000000000 * 2;\n"
+					"}";
+		size_t errors;
+		auto program = parse(code, errors);
+		if (!program || errors)
+			return 1;
+		const auto& function = static_cast<const alx::FunctionDeclaration&>(*program->GetChildren()[0]);
+		const auto statements = function.Body().Children();
+		const auto valueOf = [&](size_t i) {
+			return alx::constantValueOf(static_cast<const alx::Expression&>(*statements[i]));
+		};
+		const auto& product = static_cast<const alx::BinaryExpression&>(*statements[4]);
+		if (!valueOf(1) || valueOf(1)->AsInt() != 15 || !valueOf(2) || valueOf(2)->AsInt() != 1 || valueOf(3)
+			|| valueOf(4) || !alx::constantValueOf(*product.Lhs()))
+			return 1;
+		// An integer literal too big for an int is a long, as in C, so arithmetic on it doesn't wrap at 32 bits
+		return !valueOf(5) || valueOf(5)->Type() != TokenType::T_LONG || valueOf(5)->AsInt() != 3000000001L
+			|| !valueOf(6) || valueOf(6)->AsInt() != 10000000000L;
+	}
+	if (arg == "ast_cache")
+	{
+		const std::string_view code = "struct Point {\n\tint x;\n\tint y;\n}\n"
+									  "int f(int n, double scale = 1.5) {\n"
+									  "\tPoint p;\n"
+									  "\tconst int a = p.x + 2 * 3;\n"
+									  "\tint b = -a;\n"
+									  "\twhile (b < n) {\n\t\tb++;\n\t}\n"
+									  "\tif (b == 1,000) {\n\t\treturn 1;\n\t}\n"
+									  "\telse if (!b) {\n\t\treturn 2;\n\t}\n"
+									  "\telse {\n\t\tb = b ^ 2 ^ 3;\n\t}\n"
+									  "\treturn b;\n"
+									  "}\n";
+		auto errorHandler = std::make_shared<alx::ErrorHandler>(code, "Cache", false);
+		auto interner = std::make_shared<alx::Interner>();
+		alx::Tokeniser tokeniser(code, errorHandler, interner);
+		const auto program = alx::Parser(tokeniser.Tokenise(), errorHandler, interner).Parse();
+		if (!program)
+			return 1;
+		const auto bytes = alx::serialiseProgram(*program, *interner, 42);
+
+		// Symbols are interned afresh when the file is read, so it doesn't matter what the interner already holds
+		alx::Interner loadInterner;
+		loadInterner.Intern("unrelated");
+		const auto loaded = alx::deserialiseProgram(bytes, loadInterner, 42);
+		if (!loaded || printed(*loaded) != printed(*program) || loaded->Spans().size() != program->Spans().size()
+			|| !std::equal(loaded->Spans().begin(), loaded->Spans().end(), program->Spans().begin()))
+			return 1;
+		if (alx::deserialiseProgram(bytes, loadInterner, 43))
+			return 1;
+		try {
+			(void)alx::deserialiseProgram(std::string_view(bytes).substr(0, bytes.size() - 4), loadInterner, 42);
+			return 1;
+		}
+		catch (std::runtime_error&) {
+		}
+
+		const auto directory = std::filesystem::temp_directory_path() / ("alx-ast-cache-" + std::to_string(getpid()));
+		alx::AstCache(directory).Store(code, *program, *interner);
+		alx::AstCache cache(directory);
+		alx::Interner cacheInterner;
+		const auto cached = cache.Load(code, cacheInterner);
+		const auto edited = std::string(code) + "\n";
+		const auto missed = alx::AstCache(directory).Load(edited, cacheInterner);
+
+		// A Compiler that loads its AST from the cache never makes a parser, but still has the AST to hand out
+		const alx::Flags cacheFlags{ .ast_cache_dir = directory.string() };
+		const std::string missName = "Miss";
+		const std::string hitName = "Hit";
+		alx::Compiler(std::string("int main() {}"), missName, cacheFlags, df).Compile();
+		alx::Compiler hit{ std::string("int main() {}"), hitName, cacheFlags, df };
+		hit.Compile();
+		const auto hitStatements = hit.GetAst().GetChildren().size();
+		std::filesystem::remove_all(directory);
+		return !cached || printed(*cached) != printed(*program) || missed || hitStatements != 1;
+	}
+	if (arg == "incremental_reparse")
+	{
+		const std::string_view code = "struct Point {\n\tint x;\n}\n"
+									  "int f() {\n\tPoint p;\n\tint a = p.x;\n\treturn a;\n}\n"
+									  "int g() {\n\tint b = 2;\n\treturn b;\n}\n"
+									  "// h is next\n"
+									  "int h() {\n\treturn 3;\n}\n"
+									  "// More to come\n";
+		using Names = std::set<std::string>;
+		// Edits in the middle of a function, and a new function at the end
+		if (reparseEdited(code, { { "2", "2 * 3" }, { "// More to come", "int k() {\n\treturn 4;\n}" } })
+			!= Names{ "g", "k" })
+			return 1;
+		// Two edits on different lines of one function, and a comment that moves the ones after it down a line
+		if (reparseEdited(code, { { "Point p", "Point q" }, { "p.x", "q.x" }, { "next", "next\n//" } }) != Names{ "f" })
+			return 1;
+		// Renaming a function changes both the old and the new one
+		if (reparseEdited(code, { { "int h", "int h2" } }) != Names{ "h", "h2" })
+			return 1;
+		// Anything could depend on a struct
+		if (reparseEdited(code, { { "int x;", "int x;\n\tint y;" } }) != Names{ "f", "g", "h" })
+			return 1;
+		return 0;
+	}
 }
@@ -6,12 +6,261 @@
 // Created by aelliixx on 2023-10-31.
 //
 
+#include <algorithm>
+#include <set>
+#include <sstream>
 #include <string>
 #include "../../src/Compiler.h"
+#include "../../src/IR/Analysis/Analyses.h"
+#include "../../src/IR/PassManager.h"
+#include "../../src/IR/Transforms/Mem2Reg.h"
+#include "../../src/IR/Transforms/PhiElimination.h"
 
-#if OUTPUT_IR_TO_STRING
 using namespace alx;
 
+// The IR generated from `code`, along with the program and interner it was made from
+struct GeneratedIr {
+	std::shared_ptr<alx::Interner> Interner;
+	std::unique_ptr<alx::Program> Program;
+	std::unique_ptr<ir::IR> Ir;
+
+	[[nodiscard]] ir::Function& FirstFunction() const
+	{
+		return *std::get<std::unique_ptr<ir::Function>>(Ir->GetIR().front());
+	}
+};
+
+// Parses `code` and generates its IR, without running any passes over it. Ir is null if `code` didn't parse.
+GeneratedIr generateIr(std::string_view code)
+{
+	GeneratedIr generated;
+	generated.Interner = std::make_shared<alx::Interner>();
+	auto errorHandler = std::make_shared<ErrorHandler>(code, "IR", false);
+	Tokeniser tokeniser(code, errorHandler, generated.Interner);
+	generated.Program = Parser(tokeniser.Tokenise(), errorHandler, generated.Interner).Parse();
+	if (!generated.Program)
+		return generated;
+	generated.Ir = std::make_unique<ir::IR>(generated.Program->GetChildren(), generated.Interner);
+	generated.Ir->Generate();
+	return generated;
+}
+
+int irStorage()
+{
+	// Operands are indices into the function rather than pointers to what they refer to
+	static_assert(sizeof(ir::Values) == sizeof(uint32_t));
+	const std::string_view code = "int main() {\n\tint a = 1;\n\tlong b = 1;\n\ta += 1;\n\ta = a * 1;\n"
+								  "\tif (a < 1) {\n\t\treturn 1;\n\t}\n\treturn a;\n}\n";
+	const auto generated = generateIr(code);
+	if (!generated.Ir)
+		return EXIT_FAILURE;
+	const auto& function = generated.FirstFunction();
+
+	// Every instruction is placed in exactly one block
+	std::set<ir::InstructionId> placed;
+	size_t count = 0;
+	for (const auto& block : function.Blocks) {
+		placed.insert(block.Body.begin(), block.Body.end());
+		count += block.Body.size();
+	}
+	if (count != function.Instructions.size() || placed.size() != count)
+		return EXIT_FAILURE;
+	// The int 1 is kept once however often it's used, and is a different constant to the long 1
+	if (function.Constants.size() != 2 || function.TypePool.size() != 2)
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
+
+int irLookup()
+{
+	// Each variable is declared in a later block than the one before it
+	std::string code = "int main() {\n\tint v0 = 0;\n";
+	for (size_t i = 0; i < 200; ++i)
+		code += getFormatted("\tif (v{} < 1) {\n\t\tv{} += 1;\n\t}\n\tint v{} = v{};\n", i, i, i + 1, i);
+	code += "\treturn v200;\n}\n";
+	const auto generated = generateIr(code);
+	if (!generated.Ir)
+		return EXIT_FAILURE;
+	auto& function = generated.FirstFunction();
+
+	for (size_t i = 0; i <= 200; ++i) {
+		const auto name = getFormatted("v{}", i);
+		// Looked up rather than interned: the interner keeps a view of the name, which doesn't outlive this loop
+		const auto symbol = generated.Interner->Lookup(name);
+		const auto it = function.DeclaredVariables.find(symbol);
+		if (symbol == NoSymbol || it == function.DeclaredVariables.end()
+			|| function.VariableOf(it->second.Allocation).Name != name)
+			return EXIT_FAILURE;
+	}
+	for (const auto& block : function.Blocks)
+		if (&function.GetBlockByLabel(block.Label.Name) != &block)
+			return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
+
+int irAnalysis()
+{
+	const std::string code = "int main() {\n\tint a = 0;\n\twhile (a < 10) {\n"
+							 "\t\tif (a == 5) {\n\t\t\ta += 2;\n\t\t}\n\t\telse {\n\t\t\ta += 1;\n\t\t}\n"
+							 "\t}\n\treturn a;\n}\n";
+	const auto generated = generateIr(code);
+	if (!generated.Ir)
+		return EXIT_FAILURE;
+	auto& function = generated.FirstFunction();
+	ir::FunctionAnalyses analyses(function);
+
+	// entry, while.cond, while.body, if.then, if.else, if.end, while.end
+	const auto index = [&function](std::string_view label) {
+		return static_cast<ir::BlockId>(function.BlockIndices.at(std::string(label)));
+	};
+	const auto entry = index("entry"), cond = index("while.cond"), body = index("while.body"),
+			   then = index("if.then"), otherwise = index("if.else"), join = index("if.end"),
+			   end = index("while.end");
+	const auto& graph = analyses.ControlFlow();
+	using Blocks = std::vector<ir::BlockId>;
+	if (graph.Successors(cond) != Blocks{ body, end } || graph.Predecessors(cond) != Blocks{ entry, join }
+		|| !graph.Successors(end).empty() || graph.ReversePostOrder().size() != 7
+		|| graph.ReversePostOrder().front() != entry || graph.OrderOf(cond) > graph.OrderOf(join))
+		return EXIT_FAILURE;
+
+	const auto& dominators = analyses.Dominators();
+	if (dominators.ImmediateDominator(entry) || dominators.ImmediateDominator(join) != body
+		|| dominators.ImmediateDominator(end) != cond || !dominators.Dominates(cond, join)
+		|| dominators.Dominates(then, join) || dominators.Frontier(then) != Blocks{ join }
+		|| dominators.Frontier(otherwise) != Blocks{ join } || dominators.Frontier(body) != Blocks{ cond }
+		|| dominators.Frontier(cond) != Blocks{ cond } || !dominators.Frontier(entry).empty())
+		return EXIT_FAILURE;
+
+	// The loop's comparison is only used by the branch after it
+	const auto comparison = ir::Values::OfInstruction(function.Blocks[cond].Body[1]);
+	const auto& uses = analyses.Uses();
+	const auto users = uses.Users(comparison);
+	if (users.size() != 1 || users[0] != function.Blocks[cond].Body[2] || uses.BlockOf(users[0]) != cond)
+		return EXIT_FAILURE;
+
+	// Adding an instruction redoes the use lists but leaves the graph as it was; adding a block redoes the graph
+	const auto allocation = function.DeclaredVariables.at(generated.Interner->Lookup("a")).Allocation;
+	const auto stores = analyses.Uses().Users(allocation).size();
+	function.AppendInstruction(function.NewLoad(allocation));
+	if (analyses.Uses().Users(allocation).size() != stores + 1 || &analyses.ControlFlow() != &graph
+		|| analyses.ControlFlow().Size() != 7)
+		return EXIT_FAILURE;
+	function.AppendBlock(ir::LogicalBlock({ "unreachable" }));
+	if (analyses.ControlFlow().Size() != 8 || analyses.ControlFlow().IsReachable(7))
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
+
+int mem2reg()
+{
+	// `b` is only ever read, so it reads as zero
+	const std::string code = "int main() {\n\tint a = 0;\n\tint b;\n\twhile (a < 10) {\n"
+							 "\t\tif (a == 5) {\n\t\t\ta += 2;\n\t\t}\n\t\telse {\n\t\t\ta += b;\n\t\t}\n"
+							 "\t}\n\treturn a;\n}\n";
+	const auto generated = generateIr(code);
+	if (!generated.Ir)
+		return EXIT_FAILURE;
+	auto& function = generated.FirstFunction();
+	ir::FunctionAnalyses analyses(function);
+	const auto revision = function.ControlFlowRevision;
+	if (ir::promoteAllocas(function, analyses) != 2 || function.ControlFlowRevision != revision)
+		return EXIT_FAILURE;
+
+	using namespace ir;
+	const auto allocationOf = [&function](InstructionId id) -> const IdentifierInstruction* {
+		const auto* variable = std::get_if<Variable>(&function.Instructions[id]);
+		return variable ? &variable->Allocation : nullptr;
+	};
+	for (const auto& block : function.Blocks) {
+		for (const auto id : block.Body) {
+			const auto* allocation = allocationOf(id);
+			if (std::holds_alternative<StoreInst>(function.Instructions[id])
+				|| (allocation && !std::holds_alternative<PhiInst>(*allocation)
+					&& !std::holds_alternative<ICmpInst>(*allocation)
+					&& !std::holds_alternative<AddInst>(*allocation)))
+				return EXIT_FAILURE;
+		}
+	}
+	const auto& cond = function.GetBlockByLabel("while.cond");
+	const auto& join = function.GetBlockByLabel("if.end");
+	const auto* loop = std::get_if<PhiInst>(allocationOf(cond.Body.front()));
+	const auto* merge = std::get_if<PhiInst>(allocationOf(join.Body.front()));
+	const auto zero = function.ConstantOf(loop ? loop->Incoming[0].Value : Values::OfConstant(0));
+	if (!loop || !merge || loop->Incoming.size() != 2 || loop->Incoming[0].Block.Name != "entry"
+		|| std::get<long>(zero.Value) != 0 || loop->Incoming[1].Value != Values::OfInstruction(join.Body.front())
+		|| merge->Incoming.size() != 2 || merge->Incoming[0].Block.Name != "if.then"
+		|| merge->Incoming[1].Block.Name != "if.else")
+		return EXIT_FAILURE;
+	// `a += b` adds zero to the value from the top of the loop
+	const auto& otherwise = function.GetBlockByLabel("if.else");
+	const auto* add = std::get_if<AddInst>(allocationOf(merge->Incoming[1].Value.Index()));
+	if (!add || add->Lhs != Values::OfInstruction(cond.Body.front()) || !add->Rhs.IsConstant()
+		|| std::get<ReturnInst>(function.Instructions[function.GetBlockByLabel("while.end").Body.back()]).Value
+			   != Values::OfInstruction(cond.Body.front())
+		|| otherwise.Body.size() != 2)
+		return EXIT_FAILURE;
+
+	// Each phi becomes a load from a slot of its own, stored to before the branches into its block
+	if (eliminatePhis(function) != 2)
+		return EXIT_FAILURE;
+	const auto* reload = std::get_if<LoadInst>(allocationOf(cond.Body.front()));
+	if (!reload || !std::holds_alternative<AllocaInst>(*allocationOf(reload->Ptr.Index()))
+		|| function.Blocks.front().Body.size() != 4 || otherwise.Body.size() != 3
+		|| !std::holds_alternative<StoreInst>(function.Instructions[otherwise.Body[1]]))
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
+
+int passManager()
+{
+	const std::string code = "int f() {\n\tint a = 1;\n\treturn a;\n}\n"
+							 "int main() {\n\tint b = 2;\n\treturn b;\n}\n";
+	const auto generated = generateIr(code);
+	if (!generated.Ir)
+		return EXIT_FAILURE;
+
+	using namespace ir;
+	// Function passes after one another share each function's analyses, and a module pass starts them afresh
+	std::vector<std::string> ran;
+	std::vector<const ControlFlowGraph*> graphs;
+	bool shared = true;
+	PassManager passes;
+	passes.AddFunctionPass("graph", "graphs", [&](Function& function, FunctionAnalyses& analyses) {
+		ran.push_back("graph " + function.Name);
+		graphs.push_back(&analyses.ControlFlow());
+		return EXIT_FAILURE;
+	});
+	passes.AddFunctionPass("mem2reg", "allocas promoted", promoteAllocas);
+	passes.AddFunctionPass("same graph", "graphs", [&](Function& function, FunctionAnalyses& analyses) {
+		ran.push_back("same graph " + function.Name);
+		shared &= std::find(graphs.begin(), graphs.end(), &analyses.ControlFlow()) != graphs.end();
+		return EXIT_SUCCESS;
+	});
+	passes.AddModulePass("count", "functions", [&](std::vector<IRNodes>& module) {
+		ran.emplace_back("count");
+		return module.size();
+	});
+	passes.DumpAfter("nothing");
+	passes.DumpBefore("mem2reg");
+	if (passes.UnknownDumps() != std::vector<std::string>{ "nothing" })
+		return EXIT_FAILURE;
+	std::ostringstream dumped;
+	auto* const stdoutBuffer = std::cout.rdbuf(dumped.rdbuf());
+	passes.Run(*generated.Ir);
+	std::cout.rdbuf(stdoutBuffer);
+
+	const std::vector<std::string> expected{ "graph f()", "graph main()", "same graph f()", "same graph main()",
+											 "count" };
+	const auto& statistics = passes.Statistics();
+	if (ran != expected || !shared || statistics.size() != 4 || statistics[1].Name != "mem2reg"
+		|| statistics[1].Changes != 2 || statistics[3].Changes != 2 || statistics[1].InstructionsBefore != 8
+		|| statistics[1].InstructionsAfter != 2 || statistics[2].InstructionsBefore != 2
+		|| statistics[1].BytesBefore == 0 || dumped.str().find("before mem2reg") == std::string::npos)
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
+
+#if OUTPUT_IR_TO_STRING
 const DebugFlags df{ .quiet_mode = true };
 
 int emptyFunction()
@@ -221,10 +470,24 @@ entry:
 	return EXIT_SUCCESS;
 }
 
-int main(int argc, char** argv)
+#endif
+
+int main(int, char** argv)
 {
 	std::string arg = argv[1];
 
+	// Tests of the IR itself rather than of its printed form
+	if (arg == "IrStorage")
+		return irStorage();
+	if (arg == "IrLookup")
+		return irLookup();
+	if (arg == "IrAnalysis")
+		return irAnalysis();
+	if (arg == "Mem2Reg")
+		return mem2reg();
+	if (arg == "PassManager")
+		return passManager();
+#if OUTPUT_IR_TO_STRING
 	if (arg == "EmptyFunction") return emptyFunction();
 	else if (arg == "IntegerTypes")
 		return integerTypes();
@@ -240,12 +503,8 @@ int main(int argc, char** argv)
 		return integerSignedDivision();
 	else
 		std::cout << "Unknown test: " << arg;
-	return EXIT_FAILURE;
-}
 #else
-int main()
-{
 	std::cout << "OUTPUT_IR_TO_STRING is set to false";
+#endif
 	return EXIT_FAILURE;
 }
-#endif